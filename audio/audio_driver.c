@@ -25,6 +25,12 @@
 #include <file/file_path.h>
 #include <lists/dir_list.h>
 #include <string/stdstring.h>
+#include <features/features_cpu.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <queues/fifo_queue.h>
+#endif
 
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
@@ -179,6 +185,66 @@ static const audio_driver_t *current_audio               = NULL;
 static void *audio_driver_context_audio_data             = NULL;
 
 static bool audio_suspended                              = false;
+static bool audio_driver_nonblock                        = false;
+
+/* End-to-end latency instrumentation.
+ *
+ * Every chunk handed to the backend is tagged with the time
+ * the core produced it and its byte offset in the output
+ * stream. On each write, the amount of data the backend has
+ * already consumed is derived from write_avail/buffer_size,
+ * and every mark behind that position yields one latency
+ * sample. */
+#define AUDIO_LATENCY_MARKS_COUNT   64
+#define AUDIO_LATENCY_SAMPLES_COUNT 1024
+
+typedef struct audio_latency_mark
+{
+   retro_time_t time;
+   uint64_t pos;
+} audio_latency_mark_t;
+
+typedef struct audio_latency_marks
+{
+   audio_latency_mark_t list[AUDIO_LATENCY_MARKS_COUNT];
+   unsigned head;
+   unsigned tail;
+} audio_latency_marks_t;
+
+static audio_latency_marks_t audio_latency_marks         = {{{0}}};
+static retro_time_t audio_latency_samples_buf[AUDIO_LATENCY_SAMPLES_COUNT];
+static uint64_t audio_latency_samples_count              = 0;
+static uint64_t audio_latency_written                    = 0;
+static unsigned audio_latency_underruns                  = 0;
+static unsigned audio_latency_bytes_per_sec              = 0;
+static bool audio_latency_enable                         = false;
+
+#ifdef HAVE_THREADS
+/* Threaded audio pipeline.
+ *
+ * The core thread only queues raw s16 frames into
+ * audio_pipeline_ring; audio_pipeline_thread does the
+ * conversion, DSP, resampling, mixing and (blocking)
+ * backend write. audio_pipeline_lock only guards the ring
+ * and is never held across expensive work, so the core
+ * thread never waits on the backend. audio_pipeline_process_lock
+ * serializes the audio thread against DSP, backend state
+ * changes and teardown from the main thread. */
+static sthread_t *audio_pipeline_thread                  = NULL;
+static slock_t *audio_pipeline_lock                      = NULL;
+static slock_t *audio_pipeline_process_lock              = NULL;
+static scond_t *audio_pipeline_cond                      = NULL;
+static fifo_buffer_t *audio_pipeline_ring                = NULL;
+static int16_t *audio_pipeline_chunk_buf                 = NULL;
+static int16_t *audio_pipeline_conv_buf                  = NULL;
+static double audio_pipeline_ratio                       = 0.0;
+static bool audio_pipeline_alive                         = false;
+static bool audio_pipeline_stopped                       = false;
+/* Core timestamps of queued data, keyed by ring stream offset. */
+static audio_latency_marks_t audio_pipeline_marks        = {{{0}}};
+static uint64_t audio_pipeline_written                   = 0;
+static uint64_t audio_pipeline_read                      = 0;
+#endif
 
 static void audio_mixer_play_stop_sequential_cb(
       audio_mixer_sound_t *sound, unsigned reason);
@@ -280,9 +346,56 @@ bool compute_audio_buffer_statistics(audio_statistics_t *stats)
    return true;
 }
 
+static int audio_latency_compare(const void *a, const void *b)
+{
+   retro_time_t x = *(const retro_time_t*)a;
+   retro_time_t y = *(const retro_time_t*)b;
+   return (x > y) - (x < y);
+}
+
+/**
+ * compute_audio_latency_statistics:
+ *
+ * Computes end-to-end latency percentiles and the underrun
+ * count gathered while audio_latency_stats_enable is set.
+ *
+ * Returns: true if at least one latency sample is available.
+ **/
+bool compute_audio_latency_statistics(audio_statistics_t *stats)
+{
+   retro_time_t sorted[AUDIO_LATENCY_SAMPLES_COUNT];
+   unsigned samples = MIN(
+         (unsigned)audio_latency_samples_count,
+         AUDIO_LATENCY_SAMPLES_COUNT);
+
+   if (!stats || !audio_latency_enable || samples == 0)
+      return false;
+
+   /* May race with the audio thread; an occasional torn
+    * sample only skews a single percentile update. */
+   memcpy(sorted, audio_latency_samples_buf, samples * sizeof(*sorted));
+   qsort(sorted, samples, sizeof(*sorted), audio_latency_compare);
+
+   stats->latency_p50     = sorted[samples * 50 / 100] / 1000.0f;
+   stats->latency_p99     = sorted[samples * 99 / 100] / 1000.0f;
+   stats->latency_samples = (unsigned)audio_latency_samples_count;
+   stats->underruns       = audio_latency_underruns;
+
+   return true;
+}
+
 static void report_audio_buffer_statistics(void)
 {
    audio_statistics_t audio_stats = {0.0f};
+
+   if (compute_audio_latency_statistics(&audio_stats))
+      RARCH_LOG("[Audio]: End-to-end latency: %.2f ms (p50), %.2f ms (p99)"
+            " over %u samples, %u underruns.\n",
+            audio_stats.latency_p50,
+            audio_stats.latency_p99,
+            audio_stats.latency_samples,
+            audio_stats.underruns);
+
    if (!compute_audio_buffer_statistics(&audio_stats))
       return;
 
@@ -340,10 +453,399 @@ const char *config_get_audio_driver_options(void)
    return char_list_new_special(STRING_LIST_AUDIO_DRIVERS, NULL);
 }
 
+static void audio_latency_marks_push(audio_latency_marks_t *marks,
+      retro_time_t time, uint64_t pos)
+{
+   /* Overwrite the oldest mark rather than stalling. */
+   if (marks->head - marks->tail >= AUDIO_LATENCY_MARKS_COUNT)
+      marks->tail++;
+
+   marks->list[marks->head & (AUDIO_LATENCY_MARKS_COUNT - 1)].time = time;
+   marks->list[marks->head & (AUDIO_LATENCY_MARKS_COUNT - 1)].pos  = pos;
+   marks->head++;
+}
+
+static void audio_latency_marks_clear(audio_latency_marks_t *marks)
+{
+   marks->head = 0;
+   marks->tail = 0;
+}
+
+static void audio_driver_latency_reset(void)
+{
+   audio_latency_marks_clear(&audio_latency_marks);
+   audio_latency_written       = 0;
+   audio_latency_samples_count = 0;
+   audio_latency_underruns     = 0;
+}
+
+/**
+ * audio_driver_latency_begin_write:
+ * @time                 : time at which the core produced the
+ *                         data about to be written.
+ *
+ * Resolves the marks the backend has consumed since the last
+ * write into latency samples, counts underruns and tags the
+ * upcoming write with @time.
+ **/
+static void audio_driver_latency_begin_write(retro_time_t time)
+{
+   retro_time_t now;
+   uint64_t consumed;
+   size_t buffer_size = current_audio->buffer_size(
+         audio_driver_context_audio_data);
+   size_t avail       = current_audio->write_avail(
+         audio_driver_context_audio_data);
+   size_t queued      = avail < buffer_size ? buffer_size - avail : 0;
+
+   /* The backend ran dry since the previous write. */
+   if (audio_latency_written && queued == 0)
+      audio_latency_underruns++;
+
+   now      = cpu_features_get_time_usec();
+   consumed = audio_latency_written > queued
+      ? audio_latency_written - queued : 0;
+
+   while (audio_latency_marks.head != audio_latency_marks.tail)
+   {
+      retro_time_t played;
+      audio_latency_mark_t *mark = &audio_latency_marks.list[
+         audio_latency_marks.tail & (AUDIO_LATENCY_MARKS_COUNT - 1)];
+
+      if (mark->pos >= consumed)
+         break;
+
+      /* Interpolate when the first byte of the chunk
+       * left the buffer instead of using the write time. */
+      played = now - (retro_time_t)((consumed - mark->pos)
+            * 1000000 / audio_latency_bytes_per_sec);
+
+      if (played > mark->time)
+         audio_latency_samples_buf[audio_latency_samples_count++
+            & (AUDIO_LATENCY_SAMPLES_COUNT - 1)] = played - mark->time;
+
+      audio_latency_marks.tail++;
+   }
+
+   audio_latency_marks_push(&audio_latency_marks,
+         time, audio_latency_written);
+}
+
+/**
+ * audio_driver_process:
+ * @data                 : pointer to audio buffer.
+ * @samples              : amount of samples to process.
+ * @ratio                : resampling ratio to use.
+ * @conv_buf             : scratch buffer for s16 output conversion.
+ * @time                 : time the core produced @data, 0 if unknown.
+ *
+ * Performs DSP processing (if enabled), resampling and mixing
+ * and writes the result to the audio driver.
+ **/
+static void audio_driver_process(const int16_t *data, size_t samples,
+      double ratio, int16_t *conv_buf, retro_time_t time)
+{
+   struct resampler_data src_data;
+   const void *output_data           = NULL;
+   unsigned output_frames            = 0;
+   ssize_t written                   = 0;
+   float audio_volume_gain           = !audio_driver_mute_enable ?
+      audio_driver_volume_gain : 0.0f;
+
+   src_data.data_out                 = NULL;
+   src_data.output_frames            = 0;
+
+   convert_s16_to_float(audio_driver_input_data, data, samples,
+         audio_volume_gain);
+
+   src_data.data_in                  = audio_driver_input_data;
+   src_data.input_frames             = samples >> 1;
+
+
+   if (audio_driver_dsp)
+   {
+      struct retro_dsp_data dsp_data;
+
+      dsp_data.input                 = NULL;
+      dsp_data.input_frames          = 0;
+      dsp_data.output                = NULL;
+      dsp_data.output_frames         = 0;
+
+      dsp_data.input                 = audio_driver_input_data;
+      dsp_data.input_frames          = (unsigned)(samples >> 1);
+
+      retro_dsp_filter_process(audio_driver_dsp, &dsp_data);
+
+      if (dsp_data.output)
+      {
+         src_data.data_in            = dsp_data.output;
+         src_data.input_frames       = dsp_data.output_frames;
+      }
+   }
+
+   src_data.data_out = audio_driver_output_samples_buf;
+   src_data.ratio    = ratio;
+
+   audio_driver_resampler->process(audio_driver_resampler_data, &src_data);
+
+   if (audio_mixer_active)
+   {
+      bool override     = audio_driver_mixer_mute_enable ? true :
+         (audio_driver_mixer_volume_gain != 1.0f) ? true : false;
+      float mixer_gain  = !audio_driver_mixer_mute_enable ?
+         audio_driver_mixer_volume_gain : 0.0f;
+      audio_mixer_mix(audio_driver_output_samples_buf,
+            src_data.output_frames, mixer_gain, override);
+   }
+
+   output_data        = audio_driver_output_samples_buf;
+   output_frames      = (unsigned)src_data.output_frames;
+
+   if (audio_driver_use_float)
+      output_frames  *= sizeof(float);
+   else
+   {
+      convert_float_to_s16(conv_buf,
+            (const float*)output_data, output_frames * 2);
+
+      output_data     = conv_buf;
+      output_frames  *= sizeof(int16_t);
+   }
+
+   if (audio_latency_enable && time)
+      audio_driver_latency_begin_write(time);
+
+   written = current_audio->write(audio_driver_context_audio_data,
+            output_data, output_frames * 2);
+
+   if (written < 0)
+      audio_driver_active = false;
+   else
+      audio_latency_written += written;
+}
+
+#ifdef HAVE_THREADS
+static void audio_driver_pipeline_process_lock(void)
+{
+   if (audio_pipeline_process_lock)
+      slock_lock(audio_pipeline_process_lock);
+}
+
+static void audio_driver_pipeline_process_unlock(void)
+{
+   if (audio_pipeline_process_lock)
+      slock_unlock(audio_pipeline_process_lock);
+}
+
+static void audio_driver_pipeline_loop(void *data)
+{
+   /* Pop at most one nonblocking chunk per iteration so that
+    * the intermediate buffers sized in audio_driver_init_internal
+    * are never exceeded. */
+   size_t max_bytes = AUDIO_CHUNK_SIZE_NONBLOCKING * sizeof(int16_t);
+
+   (void)data;
+
+   for (;;)
+   {
+      size_t avail;
+      double ratio;
+      retro_time_t time = 0;
+
+      slock_lock(audio_pipeline_lock);
+      while (audio_pipeline_alive
+            && fifo_read_avail(audio_pipeline_ring) < 2 * sizeof(int16_t))
+         scond_wait(audio_pipeline_cond, audio_pipeline_lock);
+
+      if (!audio_pipeline_alive)
+      {
+         slock_unlock(audio_pipeline_lock);
+         break;
+      }
+
+      avail  = fifo_read_avail(audio_pipeline_ring);
+      avail  = MIN(avail, max_bytes);
+      /* Only consume whole stereo frames. */
+      avail &= ~(2 * sizeof(int16_t) - 1);
+      ratio  = audio_pipeline_ratio;
+      fifo_read(audio_pipeline_ring, audio_pipeline_chunk_buf, avail);
+
+      /* Find the push this chunk starts in. */
+      while (audio_pipeline_marks.head - audio_pipeline_marks.tail > 1
+            && audio_pipeline_marks.list[(audio_pipeline_marks.tail + 1)
+            & (AUDIO_LATENCY_MARKS_COUNT - 1)].pos <= audio_pipeline_read)
+         audio_pipeline_marks.tail++;
+      if (audio_pipeline_marks.head != audio_pipeline_marks.tail)
+      {
+         audio_latency_mark_t *mark = &audio_pipeline_marks.list[
+            audio_pipeline_marks.tail & (AUDIO_LATENCY_MARKS_COUNT - 1)];
+         if (mark->pos <= audio_pipeline_read)
+            time = mark->time;
+      }
+      audio_pipeline_read += avail;
+      scond_signal(audio_pipeline_cond);
+      slock_unlock(audio_pipeline_lock);
+
+      slock_lock(audio_pipeline_process_lock);
+      /* Samples still queued when the backend got paused are dropped. */
+      if (audio_driver_active && !audio_pipeline_stopped)
+         audio_driver_process(audio_pipeline_chunk_buf,
+               avail / sizeof(int16_t), ratio, audio_pipeline_conv_buf, time);
+      slock_unlock(audio_pipeline_process_lock);
+   }
+}
+
+/**
+ * audio_driver_pipeline_push:
+ * @data                 : pointer to audio buffer.
+ * @samples              : amount of samples to queue.
+ * @ratio                : resampling ratio the audio thread should use.
+ * @time                 : time the core produced @data, 0 if unknown.
+ *
+ * Queues raw samples for the audio thread. Blocks while the
+ * ring is full unless the driver is in nonblocking mode,
+ * in which case the remaining samples are dropped.
+ **/
+static void audio_driver_pipeline_push(const int16_t *data,
+      size_t samples, double ratio, retro_time_t time)
+{
+   const uint8_t *buf = (const uint8_t*)data;
+   size_t size        = samples * sizeof(int16_t);
+
+   slock_lock(audio_pipeline_lock);
+   audio_pipeline_ratio = ratio;
+
+   if (time)
+      audio_latency_marks_push(&audio_pipeline_marks,
+            time, audio_pipeline_written);
+
+   while (size && audio_pipeline_alive)
+   {
+      size_t avail = fifo_write_avail(audio_pipeline_ring);
+
+      avail &= ~(2 * sizeof(int16_t) - 1);
+
+      if (avail == 0)
+      {
+         if (audio_driver_nonblock)
+            break;
+         scond_wait(audio_pipeline_cond, audio_pipeline_lock);
+         continue;
+      }
+
+      avail = MIN(avail, size);
+      fifo_write(audio_pipeline_ring, buf, avail);
+      buf                    += avail;
+      size                   -= avail;
+      audio_pipeline_written += avail;
+      scond_signal(audio_pipeline_cond);
+   }
+
+   slock_unlock(audio_pipeline_lock);
+}
+
+static void audio_driver_pipeline_deinit(void)
+{
+   if (audio_pipeline_thread)
+   {
+      slock_lock(audio_pipeline_lock);
+      audio_pipeline_alive = false;
+      scond_broadcast(audio_pipeline_cond);
+      slock_unlock(audio_pipeline_lock);
+
+      sthread_join(audio_pipeline_thread);
+   }
+   audio_pipeline_thread = NULL;
+   audio_pipeline_alive  = false;
+
+   if (audio_pipeline_cond)
+      scond_free(audio_pipeline_cond);
+   if (audio_pipeline_lock)
+      slock_free(audio_pipeline_lock);
+   if (audio_pipeline_process_lock)
+      slock_free(audio_pipeline_process_lock);
+   if (audio_pipeline_ring)
+      fifo_free(audio_pipeline_ring);
+   if (audio_pipeline_chunk_buf)
+      free(audio_pipeline_chunk_buf);
+   if (audio_pipeline_conv_buf)
+      free(audio_pipeline_conv_buf);
+
+   audio_pipeline_cond         = NULL;
+   audio_pipeline_lock         = NULL;
+   audio_pipeline_process_lock = NULL;
+   audio_pipeline_ring         = NULL;
+   audio_pipeline_chunk_buf    = NULL;
+   audio_pipeline_conv_buf     = NULL;
+}
+
+static bool audio_driver_pipeline_init(unsigned latency,
+      size_t outsamples_max)
+{
+   /* Size the ring to hold 'latency' milliseconds of input,
+    * but never less than two nonblocking chunks (rewind flushes
+    * and fast-forward push chunks of that size). */
+   size_t ring_size = (size_t)(audio_driver_input * latency / 1000.0f)
+      * 2 * sizeof(int16_t);
+
+   ring_size = MAX(ring_size,
+         AUDIO_CHUNK_SIZE_NONBLOCKING * 2 * sizeof(int16_t));
+
+   audio_pipeline_lock         = slock_new();
+   audio_pipeline_process_lock = slock_new();
+   audio_pipeline_cond         = scond_new();
+   audio_pipeline_ring         = fifo_new(ring_size);
+   audio_pipeline_chunk_buf    = (int16_t*)malloc(
+         AUDIO_CHUNK_SIZE_NONBLOCKING * sizeof(int16_t));
+   audio_pipeline_conv_buf     = (int16_t*)malloc(
+         outsamples_max * sizeof(int16_t));
+
+   if (     !audio_pipeline_lock
+         || !audio_pipeline_process_lock
+         || !audio_pipeline_cond
+         || !audio_pipeline_ring
+         || !audio_pipeline_chunk_buf
+         || !audio_pipeline_conv_buf)
+      goto error;
+
+   audio_pipeline_ratio   = audio_source_ratio_current;
+   audio_pipeline_alive   = true;
+   audio_pipeline_stopped = false;
+   audio_pipeline_written = 0;
+   audio_pipeline_read    = 0;
+   audio_latency_marks_clear(&audio_pipeline_marks);
+   audio_pipeline_thread = sthread_create(audio_driver_pipeline_loop, NULL);
+
+   if (!audio_pipeline_thread)
+      goto error;
+
+   /* Rate control now tracks the fill level of the ring
+    * instead of the backend buffer. */
+   audio_driver_buffer_size = ring_size;
+
+   RARCH_LOG("[Audio]: Started threaded audio pipeline (%u byte queue).\n",
+         (unsigned)ring_size);
+
+   return true;
+
+error:
+   RARCH_ERR("[Audio]: Failed to start threaded audio pipeline.\n");
+   audio_driver_pipeline_deinit();
+   return false;
+}
+#else
+#define audio_driver_pipeline_process_lock()   ((void)0)
+#define audio_driver_pipeline_process_unlock() ((void)0)
+#endif
+
 static bool audio_driver_deinit_internal(void)
 {
    settings_t *settings = config_get_ptr();
 
+#ifdef HAVE_THREADS
+   audio_driver_pipeline_deinit();
+#endif
+
    if (current_audio && current_audio->free)
    {
       if (audio_driver_context_audio_data)
@@ -395,6 +897,7 @@ static void audio_driver_mixer_init(unsigned out_rate)
 static bool audio_driver_init_internal(bool audio_cb_inited)
 {
    unsigned new_rate     = 0;
+   unsigned out_rate     = 0;
    float   *aud_inp_data = NULL;
    float *samples_buf    = NULL;
    int16_t *conv_buf     = NULL;
@@ -469,6 +972,9 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
                &new_rate);
    }
 
+   /* The driver may have opened the device at another rate. */
+   out_rate = new_rate ? new_rate : settings->uints.audio_out_rate;
+
    if (new_rate != 0)
    {
       configuration_set_int(settings, settings->uints.audio_out_rate, new_rate);
@@ -485,6 +991,8 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
          && current_audio->use_float(audio_driver_context_audio_data))
       audio_driver_use_float = true;
 
+   audio_driver_nonblock = false;
+
    if (!settings->bools.audio_sync && audio_driver_active)
    {
       command_event(CMD_EVENT_AUDIO_SET_NONBLOCKING_STATE, NULL);
@@ -560,6 +1068,40 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
 
    audio_driver_mixer_init(settings->uints.audio_out_rate);
 
+   audio_driver_latency_reset();
+   audio_latency_enable = false;
+
+   if (
+         !audio_cb_inited
+         && audio_driver_active
+         && settings->bools.audio_latency_stats_enable
+      )
+   {
+      /* Latency tracking requires write_avail
+       * and buffer_size to be implemented. */
+      if (current_audio->buffer_size && current_audio->write_avail)
+      {
+         audio_latency_bytes_per_sec = out_rate * 2
+            * (audio_driver_use_float ? sizeof(float) : sizeof(int16_t));
+         audio_latency_enable        = true;
+      }
+      else
+         RARCH_WARN("Audio latency statistics were desired, but driver does not support needed features.\n");
+   }
+
+#ifdef HAVE_THREADS
+   if (
+         !audio_cb_inited
+         && audio_driver_active
+         && settings->bools.audio_pipeline_threaded
+      )
+   {
+      if (audio_driver_pipeline_init(settings->uints.audio_latency,
+               outsamples_max))
+         audio_driver_control = settings->bools.audio_rate_control;
+   }
+#endif
+
    /* Threaded driver is initially stopped. */
    if (
          audio_driver_active
@@ -576,13 +1118,20 @@ error:
 void audio_driver_set_nonblocking_state(bool enable)
 {
    settings_t *settings = config_get_ptr();
+
+   audio_driver_nonblock = settings->bools.audio_sync ? enable : true;
+
    if (
          audio_driver_active
          && audio_driver_context_audio_data
       )
+   {
+      audio_driver_pipeline_process_lock();
       current_audio->set_nonblock_state(
             audio_driver_context_audio_data,
-            settings->bools.audio_sync ? enable : true);
+            audio_driver_nonblock);
+      audio_driver_pipeline_process_unlock();
+   }
 
    audio_driver_chunk_size = enable ?
       audio_driver_chunk_nonblock_size :
@@ -596,21 +1145,19 @@ void audio_driver_set_nonblocking_state(bool enable)
  *
  * Writes audio samples to audio driver. Will first
  * perform DSP processing (if enabled) and resampling.
+ *
+ * With the threaded pipeline active, only the rate control
+ * runs here and the samples are queued for the audio thread.
  **/
 static void audio_driver_flush(const int16_t *data, size_t samples)
 {
-   struct resampler_data src_data;
    bool is_perfcnt_enable            = false;
    bool is_paused                    = false;
    bool is_idle                      = false;
    bool is_slowmotion                = false;
-   const void *output_data           = NULL;
-   unsigned output_frames            = 0;
-   float audio_volume_gain           = !audio_driver_mute_enable ?
-      audio_driver_volume_gain : 0.0f;
-
-   src_data.data_out                 = NULL;
-   src_data.output_frames            = 0;
+   double ratio                      = 0.0;
+   retro_time_t time                 = audio_latency_enable
+      ? cpu_features_get_time_usec() : 0;
 
    if (recording_data)
       recording_push_audio(data, samples);
@@ -624,48 +1171,33 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
 		   !audio_driver_output_samples_buf)
       return;
 
-   convert_s16_to_float(audio_driver_input_data, data, samples,
-         audio_volume_gain);
-
-   src_data.data_in                  = audio_driver_input_data;
-   src_data.input_frames             = samples >> 1;
-
-
-   if (audio_driver_dsp)
-   {
-      struct retro_dsp_data dsp_data;
-
-      dsp_data.input                 = NULL;
-      dsp_data.input_frames          = 0;
-      dsp_data.output                = NULL;
-      dsp_data.output_frames         = 0;
-
-      dsp_data.input                 = audio_driver_input_data;
-      dsp_data.input_frames          = (unsigned)(samples >> 1);
-
-      retro_dsp_filter_process(audio_driver_dsp, &dsp_data);
-
-      if (dsp_data.output)
-      {
-         src_data.data_in            = dsp_data.output;
-         src_data.input_frames       = dsp_data.output_frames;
-      }
-   }
-
-   src_data.data_out = audio_driver_output_samples_buf;
-
    if (audio_driver_control)
    {
       /* Readjust the audio input rate. */
       int      half_size   = (int)(audio_driver_buffer_size / 2);
-      int      avail       =
-         (int)current_audio->write_avail(audio_driver_context_audio_data);
-      int      delta_mid   = avail - half_size;
-      double   direction   = (double)delta_mid / half_size;
-      double   adjust      = 1.0 + audio_driver_rate_control_delta * direction;
+      int      avail       = 0;
+      int      delta_mid   = 0;
+      double   direction   = 0.0;
+      double   adjust      = 0.0;
       unsigned write_idx   = audio_driver_free_samples_count++ &
          (AUDIO_BUFFER_FREE_SAMPLES_COUNT - 1);
 
+#ifdef HAVE_THREADS
+      if (audio_pipeline_thread)
+      {
+         slock_lock(audio_pipeline_lock);
+         avail             = (int)fifo_write_avail(audio_pipeline_ring);
+         slock_unlock(audio_pipeline_lock);
+      }
+      else
+#endif
+         avail             =
+            (int)current_audio->write_avail(audio_driver_context_audio_data);
+
+      delta_mid            = avail - half_size;
+      direction            = (double)delta_mid / half_size;
+      adjust               = 1.0 + audio_driver_rate_control_delta * direction;
+
       audio_driver_free_samples_buf
          [write_idx]               = avail;
       audio_source_ratio_current   =
@@ -683,43 +1215,24 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
 #endif
    }
 
-   src_data.ratio           = audio_source_ratio_current;
+   ratio                    = audio_source_ratio_current;
 
    if (is_slowmotion)
    {
       settings_t *settings  = config_get_ptr();
-      src_data.ratio       *= settings->floats.slowmotion_ratio;
+      ratio                *= settings->floats.slowmotion_ratio;
    }
 
-   audio_driver_resampler->process(audio_driver_resampler_data, &src_data);
-
-   if (audio_mixer_active)
-   {
-      bool override     = audio_driver_mixer_mute_enable ? true :
-         (audio_driver_mixer_volume_gain != 1.0f) ? true : false;
-      float mixer_gain  = !audio_driver_mixer_mute_enable ?
-         audio_driver_mixer_volume_gain : 0.0f;
-      audio_mixer_mix(audio_driver_output_samples_buf,
-            src_data.output_frames, mixer_gain, override);
-   }
-
-   output_data        = audio_driver_output_samples_buf;
-   output_frames      = (unsigned)src_data.output_frames;
-
-   if (audio_driver_use_float)
-      output_frames  *= sizeof(float);
-   else
+#ifdef HAVE_THREADS
+   if (audio_pipeline_thread)
    {
-      convert_float_to_s16(audio_driver_output_samples_conv_buf,
-            (const float*)output_data, output_frames * 2);
-
-      output_data     = audio_driver_output_samples_conv_buf;
-      output_frames  *= sizeof(int16_t);
+      audio_driver_pipeline_push(data, samples, ratio, time);
+      return;
    }
+#endif
 
-   if (current_audio->write(audio_driver_context_audio_data,
-            output_data, output_frames * 2) < 0)
-      audio_driver_active = false;
+   audio_driver_process(data, samples, ratio,
+         audio_driver_output_samples_conv_buf, time);
 }
 
 /**
@@ -826,9 +1339,11 @@ size_t audio_driver_sample_batch_rewind(const int16_t *data, size_t frames)
 
 void audio_driver_dsp_filter_free(void)
 {
+   audio_driver_pipeline_process_lock();
    if (audio_driver_dsp)
       retro_dsp_filter_free(audio_driver_dsp);
    audio_driver_dsp = NULL;
+   audio_driver_pipeline_process_unlock();
 }
 
 void audio_driver_dsp_filter_init(const char *device)
@@ -847,8 +1362,10 @@ void audio_driver_dsp_filter_init(const char *device)
    if (!plugs)
       goto error;
 #endif
+   audio_driver_pipeline_process_lock();
    audio_driver_dsp = retro_dsp_filter_new(
          device, plugs, audio_driver_input);
+   audio_driver_pipeline_process_unlock();
    if (!audio_driver_dsp)
       goto error;
 
@@ -1475,10 +1992,22 @@ static INLINE bool audio_driver_alive(void)
 
 bool audio_driver_start(bool is_shutdown)
 {
+   bool ret = false;
+
    if (!current_audio || !current_audio->start
          || !audio_driver_context_audio_data)
       goto error;
-   if (!current_audio->start(audio_driver_context_audio_data, is_shutdown))
+
+   audio_driver_pipeline_process_lock();
+   ret = current_audio->start(audio_driver_context_audio_data, is_shutdown);
+   /* Time spent stopped must not count as latency. */
+   audio_latency_marks_clear(&audio_latency_marks);
+#ifdef HAVE_THREADS
+   audio_pipeline_stopped = false;
+#endif
+   audio_driver_pipeline_process_unlock();
+
+   if (!ret)
       goto error;
 
    return true;
@@ -1493,12 +2022,20 @@ error:
 
 bool audio_driver_stop(void)
 {
+   bool ret = false;
+
    if (!current_audio || !current_audio->stop
          || !audio_driver_context_audio_data)
       return false;
    if (!audio_driver_alive())
       return false;
-   return current_audio->stop(audio_driver_context_audio_data);
+   audio_driver_pipeline_process_lock();
+   ret = current_audio->stop(audio_driver_context_audio_data);
+#ifdef HAVE_THREADS
+   audio_pipeline_stopped = true;
+#endif
+   audio_driver_pipeline_process_unlock();
+   return ret;
 }
 
 void audio_driver_unset_callback(void)
@@ -76,6 +76,11 @@ typedef struct audio_statistics
    float close_to_underrun;
    float close_to_blocking;
    unsigned samples;
+   /* End-to-end latency (core -> backend playback), in ms. */
+   float latency_p50;
+   float latency_p99;
+   unsigned latency_samples;
+   unsigned underruns;
 } audio_statistics_t;
 
 typedef struct audio_driver
@@ -315,6 +320,8 @@ const char *audio_driver_mixer_get_stream_name(unsigned i);
 
 bool compute_audio_buffer_statistics(audio_statistics_t *stats);
 
+bool compute_audio_latency_statistics(audio_statistics_t *stats);
+
 extern audio_driver_t audio_rsound;
 extern audio_driver_t audio_oss;
 extern audio_driver_t audio_alsa;
@@ -110,12 +110,6 @@
 #define CHEEVOS_JSON_KEY_SUCCESS      0x110461deU
 #define CHEEVOS_JSON_KEY_ERROR        0x0d2011cfU
 
-typedef struct
-{
-   cheevos_cond_t *conds;
-   unsigned        count;
-} cheevos_condset_t;
-
 typedef struct
 {
    cheevos_condset_t *condsets;
@@ -234,8 +228,6 @@ typedef struct
    cheevos_console_t console_id;
    bool core_supports;
    bool addrs_patched;
-   int  add_buffer;
-   int  add_hits;
 
    cheevoset_t core;
    cheevoset_t unofficial;
@@ -267,8 +259,6 @@ static cheevos_locals_t cheevos_locals =
    /* console_id          */ CHEEVOS_CONSOLE_NONE,
    /* core_supports       */ true,
    /* addrs_patched       */ false,
-   /* add_buffer          */ 0,
-   /* add_hits            */ 0,
 
    /* core                */ {NULL, 0},
    /* unofficial          */ {NULL, 0},
@@ -626,14 +616,13 @@ static int cheevos_parse_condition(
    if (condition->count)
    {
       unsigned set                 = 0;
+      unsigned total               = 0;
       const cheevos_condset_t* end = NULL;
-      cheevos_condset_t *conds     = NULL;
+      cheevos_cond_t *conds        = NULL;
       cheevos_condset_t *condset   = NULL;
       cheevos_condset_t *condsets  = (cheevos_condset_t*)
          calloc(condition->count, sizeof(cheevos_condset_t));
 
-      (void)conds;
-
       if (!condsets)
          return -1;
 
@@ -644,30 +633,38 @@ static int cheevos_parse_condition(
       {
          condset->count =
             cheevos_cond_count_in_set(memaddr, set);
-         condset->conds = NULL;
+         total         += condset->count;
 
          CHEEVOS_LOG("[CHEEVOS]: set %p (index=%u)\n", condset, set);
          CHEEVOS_LOG("[CHEEVOS]:   conds: %u\n", condset->count);
+      }
 
-         if (condset->count)
-         {
-            cheevos_cond_t *conds = (cheevos_cond_t*)
-               calloc(condset->count, sizeof(cheevos_cond_t));
+      /* All the groups share one block of conditions so testing walks
+       * them in memory order; condsets[0].conds owns the block. */
+      if (total)
+      {
+         conds = (cheevos_cond_t*)calloc(total, sizeof(cheevos_cond_t));
 
-            if (!conds)
-            {
-               while (--condset >= condition->condsets)
-               {
-                  if ((void*)condset->conds)
-                     free((void*)condset->conds);
-               }
+         if (!conds)
+         {
+            free(condsets);
+            condition->condsets = NULL;
+            return -1;
+         }
+      }
 
-               return -1;
-            }
+      for (condset = condition->condsets, set = 0; condset < end;
+            condset++, set++)
+      {
+         condset->conds = conds;
 
-            condset->conds = conds;
+         if (condset->count)
+         {
             cheevos_cond_parse_in_set(condset->conds, memaddr, set);
+            conds += condset->count;
          }
+
+         cheevos_condset_compile(condset);
       }
    }
 
@@ -676,27 +673,16 @@ static int cheevos_parse_condition(
 
 static void cheevos_free_condition(cheevos_condition_t* condition)
 {
-   unsigned i;
-
    if (!condition)
       return;
 
    if (condition->condsets)
    {
-      for (i = 0; i < condition->count; i++)
-      {
-         if (condition->condsets[i].conds)
-         {
-            free(condition->condsets[i].conds);
-            condition->condsets[i].conds = NULL;
-         }
-      }
+      if (condition->count && condition->condsets[0].conds)
+         free(condition->condsets[0].conds);
 
-      if (condition->condsets)
-      {
-         free(condition->condsets);
-         condition->condsets = NULL;
-      }
+      free(condition->condsets);
+      condition->condsets = NULL;
    }
 }
 
@@ -1256,228 +1242,6 @@ error:
 Test all the achievements (call once per frame).
 *****************************************************************************/
 
-static int cheevos_test_condition(cheevos_cond_t *cond)
-{
-   unsigned sval = 0;
-   unsigned tval = 0;
-
-   if (!cond)
-      return 0;
-
-   sval          = cheevos_var_get_value(&cond->source) +
-                   cheevos_locals.add_buffer;
-   tval          = cheevos_var_get_value(&cond->target);
-
-   switch (cond->op)
-   {
-      case CHEEVOS_COND_OP_EQUALS:
-         return (sval == tval);
-      case CHEEVOS_COND_OP_LESS_THAN:
-         return (sval < tval);
-      case CHEEVOS_COND_OP_LESS_THAN_OR_EQUAL:
-         return (sval <= tval);
-      case CHEEVOS_COND_OP_GREATER_THAN:
-         return (sval > tval);
-      case CHEEVOS_COND_OP_GREATER_THAN_OR_EQUAL:
-         return (sval >= tval);
-      case CHEEVOS_COND_OP_NOT_EQUAL_TO:
-         return (sval != tval);
-      default:
-         break;
-   }
-
-   return 1;
-}
-
-static int cheevos_test_pause_cond_set(const cheevos_condset_t *condset,
-      int *dirty_conds, int *reset_conds, int process_pause)
-{
-   int cond_valid            = 0;
-   int set_valid             = 1; /* must start true so AND logic works */
-   cheevos_cond_t *cond      = NULL;
-   const cheevos_cond_t *end = condset->conds + condset->count;
-
-   cheevos_locals.add_buffer = 0;
-   cheevos_locals.add_hits   = 0;
-
-   for (cond = condset->conds; cond < end; cond++)
-   {
-      if (cond->pause != process_pause)
-         continue;
-
-      if (cond->type == CHEEVOS_COND_TYPE_ADD_SOURCE)
-      {
-         cheevos_locals.add_buffer += cheevos_var_get_value(&cond->source);
-         continue;
-      }
-
-      if (cond->type == CHEEVOS_COND_TYPE_SUB_SOURCE)
-      {
-         cheevos_locals.add_buffer -= cheevos_var_get_value(&cond->source);
-         continue;
-      }
-
-      if (cond->type == CHEEVOS_COND_TYPE_ADD_HITS)
-      {
-         if (cheevos_test_condition(cond))
-         {
-            cond->curr_hits++;
-            *dirty_conds = 1;
-         }
-
-         cheevos_locals.add_hits += cond->curr_hits;
-         continue;
-      }
-
-      /* always evaluate the condition to ensure delta values get tracked correctly */
-      cond_valid = cheevos_test_condition(cond);
-
-      /* if the condition has a target hit count that has already been met,
-       * it's automatically true, even if not currently true. */
-      if (  (cond->req_hits != 0) &&
-            (cond->curr_hits + cheevos_locals.add_hits) >= cond->req_hits)
-      {
-            cond_valid = 1;
-      }
-      else if (cond_valid)
-      {
-         cond->curr_hits++;
-         *dirty_conds = 1;
-
-         /* Process this logic, if this condition is true: */
-         if (cond->req_hits == 0)
-            ; /* Not a hit-based requirement: ignore any additional logic! */
-         else if ((cond->curr_hits + cheevos_locals.add_hits) < cond->req_hits)
-            cond_valid = 0; /* HitCount target has not yet been met, condition is not yet valid. */
-      }
-
-      cheevos_locals.add_buffer = 0;
-      cheevos_locals.add_hits   = 0;
-
-      if (cond->type == CHEEVOS_COND_TYPE_PAUSE_IF)
-      {
-         /* as soon as we find a PauseIf that evaluates to true,
-          * stop processing the rest of the group. */
-         if (cond_valid)
-            return 1;
-
-         /* if we make it to the end of the function, make sure we are
-          * indicating nothing matched. if we do find a later PauseIf match,
-          * it'll automatically return true via the previous condition. */
-         set_valid = 0;
-
-         if (cond->req_hits == 0)
-         {
-            /* PauseIf didn't evaluate true, and doesn't have a HitCount,
-             * reset the HitCount to indicate the condition didn't match. */
-            if (cond->curr_hits != 0)
-            {
-               cond->curr_hits = 0;
-               *dirty_conds = 1;
-            }
-         }
-         else
-         {
-            /* PauseIf has a HitCount that hasn't been met, ignore it for now. */
-         }
-      }
-      else if (cond->type == CHEEVOS_COND_TYPE_RESET_IF)
-      {
-         if (cond_valid)
-         {
-            *reset_conds = 1; /* Resets all hits found so far */
-            set_valid    = 0; /* Cannot be valid if we've hit a reset condition. */
-         }
-      }
-      else /* Sequential or non-sequential? */
-         set_valid &= cond_valid;
-   }
-
-   return set_valid;
-}
-
-static int cheevos_test_cond_set(const cheevos_condset_t *condset,
-      int *dirty_conds, int *reset_conds)
-{
-   int in_pause              = 0;
-   int has_pause             = 0;
-   cheevos_cond_t *cond      = NULL;
-
-   if (!condset)
-      return 1; /* important: empty group must evaluate true */
-
-   /* the ints below are used for Pause conditions and their dependent AddSource/AddHits. */
-
-   /* this loop needs to go backwards to check AddSource/AddHits */
-   cond = condset->conds + condset->count - 1;
-   for (; cond >= condset->conds; cond--)
-   {
-      if (cond->type == CHEEVOS_COND_TYPE_PAUSE_IF)
-      {
-         has_pause = 1;
-         in_pause = 1;
-         cond->pause = 1;
-      }
-      else if (cond->type == CHEEVOS_COND_TYPE_ADD_SOURCE ||
-               cond->type == CHEEVOS_COND_TYPE_SUB_SOURCE ||
-               cond->type == CHEEVOS_COND_TYPE_ADD_HITS)
-      {
-         cond->pause = in_pause;
-      }
-      else
-      {
-         in_pause = 0;
-         cond->pause = 0;
-      }
-   }
-
-   if (has_pause)
-   {  /* one or more Pause conditions exists, if any of them are true,
-       * stop processing this group. */
-      if (cheevos_test_pause_cond_set(condset, dirty_conds, reset_conds, 1))
-         return 0;
-   }
-
-   /* process the non-Pause conditions to see if the group is true */
-   return cheevos_test_pause_cond_set(condset, dirty_conds, reset_conds, 0);
-}
-
-static int cheevos_reset_cond_set(cheevos_condset_t *condset, int deltas)
-{
-   int dirty                 = 0;
-   const cheevos_cond_t *end = NULL;
-
-   if (!condset)
-      return 0;
-
-   end                       = condset->conds + condset->count;
-
-   if (deltas)
-   {
-      cheevos_cond_t *cond      = NULL;
-      for (cond = condset->conds; cond < end; cond++)
-      {
-         dirty                 |= cond->curr_hits != 0;
-
-         cond->curr_hits        = 0;
-
-         cond->source.previous  = cond->source.value;
-         cond->target.previous  = cond->target.value;
-      }
-   }
-   else
-   {
-      cheevos_cond_t *cond      = NULL;
-      for (cond = condset->conds; cond < end; cond++)
-      {
-         dirty           |= cond->curr_hits != 0;
-         cond->curr_hits  = 0;
-      }
-   }
-
-   return dirty;
-}
-
 static int cheevos_test_cheevo(cheevo_t *cheevo)
 {
    int dirty_conds              = 0;
@@ -1500,13 +1264,13 @@ static int cheevos_test_cheevo(cheevo_t *cheevo)
 
    if (condset < end)
    {
-      ret_val = cheevos_test_cond_set(condset, &dirty_conds, &reset_conds);
+      ret_val = cheevos_condset_test(condset, &dirty_conds, &reset_conds);
       condset++;
    }
 
    while (condset < end)
    {
-      ret_val_sub_cond |= cheevos_test_cond_set(
+      ret_val_sub_cond |= cheevos_condset_test(
             condset, &dirty_conds, &reset_conds);
       condset++;
    }
@@ -1519,7 +1283,7 @@ static int cheevos_test_cheevo(cheevo_t *cheevo)
       int dirty = 0;
 
       for (condset = cheevo->condition.condsets; condset < end; condset++)
-         dirty |= cheevos_reset_cond_set(condset, 0);
+         dirty |= cheevos_condset_reset(condset, 0);
 
       if (dirty)
          cheevo->dirty |= CHEEVOS_DIRTY_CONDITIONS;
@@ -1637,7 +1401,7 @@ static void cheevos_test_cheevo_set(const cheevoset_t *set)
                + cheevo->condition.count;
 
             for (; condset < end; condset++)
-               cheevos_reset_cond_set(condset, 0);
+               cheevos_condset_reset(condset, 0);
          }
          else if (valid)
          {
@@ -1704,14 +1468,14 @@ static int cheevos_test_lboard_condition(const cheevos_condition_t* condition)
 
    if (condset < end)
    {
-      ret_val = cheevos_test_cond_set(
+      ret_val = cheevos_condset_test(
             condset, &dirty_conds, &reset_conds);
       condset++;
    }
 
    while (condset < end)
    {
-      ret_val_sub_cond |= cheevos_test_cond_set(
+      ret_val_sub_cond |= cheevos_condset_test(
             condset, &dirty_conds, &reset_conds);
       condset++;
    }
@@ -1719,7 +1483,7 @@ static int cheevos_test_lboard_condition(const cheevos_condition_t* condition)
    if (reset_conds)
    {
       for (condset = condition->condsets; condset < end; condset++)
-         cheevos_reset_cond_set(condset, 0);
+         cheevos_condset_reset(condset, 0);
    }
 
    return (ret_val && ret_val_sub_cond);
@@ -1921,8 +1685,11 @@ Free the loaded achievements.
 
 static void cheevos_free_condset(const cheevos_condset_t *set)
 {
+   /* set->conds owns the conditions of every group in the cheevo */
    if (set && set->conds)
       free((void*)set->conds);
+   if (set)
+      free((void*)set);
 }
 
 static void cheevos_free_cheevo(const cheevo_t *cheevo)
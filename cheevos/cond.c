@@ -187,3 +187,223 @@ void cheevos_cond_parse_in_set(cheevos_cond_t* cond, const char* memaddr, unsign
       memaddr++;
    }
 }
+
+/*****************************************************************************
+Compiling
+*****************************************************************************/
+
+void cheevos_condset_compile(cheevos_condset_t* condset)
+{
+   int in_pause         = 0;
+   cheevos_cond_t *cond = NULL;
+
+   condset->has_pause   = 0;
+
+   if (!condset->count)
+      return;
+
+   /* PauseIf conditions pull their preceding AddSource/SubSource/AddHits
+    * along with them, so this loop needs to go backwards. The flags don't
+    * change once parsed, so they are worked out here instead of on every
+    * frame. */
+   cond = condset->conds + condset->count - 1;
+
+   for (; cond >= condset->conds; cond--)
+   {
+      if (cond->type == CHEEVOS_COND_TYPE_PAUSE_IF)
+      {
+         condset->has_pause = 1;
+         in_pause           = 1;
+         cond->pause        = 1;
+      }
+      else if (cond->type == CHEEVOS_COND_TYPE_ADD_SOURCE ||
+               cond->type == CHEEVOS_COND_TYPE_SUB_SOURCE ||
+               cond->type == CHEEVOS_COND_TYPE_ADD_HITS)
+         cond->pause        = in_pause;
+      else
+      {
+         in_pause           = 0;
+         cond->pause        = 0;
+      }
+   }
+}
+
+/*****************************************************************************
+Testing
+*****************************************************************************/
+
+static int cheevos_cond_test(cheevos_cond_t* cond, unsigned add_buffer)
+{
+   unsigned sval = cheevos_var_get_value(&cond->source) + add_buffer;
+   unsigned tval = cheevos_var_get_value(&cond->target);
+
+   switch (cond->op)
+   {
+      case CHEEVOS_COND_OP_EQUALS:
+         return (sval == tval);
+      case CHEEVOS_COND_OP_LESS_THAN:
+         return (sval < tval);
+      case CHEEVOS_COND_OP_LESS_THAN_OR_EQUAL:
+         return (sval <= tval);
+      case CHEEVOS_COND_OP_GREATER_THAN:
+         return (sval > tval);
+      case CHEEVOS_COND_OP_GREATER_THAN_OR_EQUAL:
+         return (sval >= tval);
+      case CHEEVOS_COND_OP_NOT_EQUAL_TO:
+         return (sval != tval);
+      default:
+         break;
+   }
+
+   return 1;
+}
+
+static int cheevos_condset_test_pause(cheevos_condset_t* condset,
+      int* dirty_conds, int* reset_conds, int process_pause)
+{
+   int cond_valid            = 0;
+   int set_valid             = 1; /* must start true so AND logic works */
+   unsigned add_buffer       = 0;
+   unsigned add_hits         = 0;
+   cheevos_cond_t *cond      = condset->conds;
+   const cheevos_cond_t *end = cond + condset->count;
+
+   for (; cond < end; cond++)
+   {
+      if (cond->pause != process_pause)
+         continue;
+
+      if (cond->type == CHEEVOS_COND_TYPE_ADD_SOURCE)
+      {
+         add_buffer += cheevos_var_get_value(&cond->source);
+         continue;
+      }
+
+      if (cond->type == CHEEVOS_COND_TYPE_SUB_SOURCE)
+      {
+         add_buffer -= cheevos_var_get_value(&cond->source);
+         continue;
+      }
+
+      if (cond->type == CHEEVOS_COND_TYPE_ADD_HITS)
+      {
+         if (cheevos_cond_test(cond, add_buffer))
+         {
+            cond->curr_hits++;
+            *dirty_conds = 1;
+         }
+
+         add_hits += cond->curr_hits;
+         continue;
+      }
+
+      /* always evaluate the condition to ensure delta values get tracked correctly */
+      cond_valid = cheevos_cond_test(cond, add_buffer);
+
+      /* if the condition has a target hit count that has already been met,
+       * it's automatically true, even if not currently true. */
+      if (  (cond->req_hits != 0) &&
+            (cond->curr_hits + add_hits) >= cond->req_hits)
+      {
+            cond_valid = 1;
+      }
+      else if (cond_valid)
+      {
+         cond->curr_hits++;
+         *dirty_conds = 1;
+
+         /* Process this logic, if this condition is true: */
+         if (cond->req_hits == 0)
+            ; /* Not a hit-based requirement: ignore any additional logic! */
+         else if ((cond->curr_hits + add_hits) < cond->req_hits)
+            cond_valid = 0; /* HitCount target has not yet been met, condition is not yet valid. */
+      }
+
+      add_buffer = 0;
+      add_hits   = 0;
+
+      if (cond->type == CHEEVOS_COND_TYPE_PAUSE_IF)
+      {
+         /* as soon as we find a PauseIf that evaluates to true,
+          * stop processing the rest of the group. */
+         if (cond_valid)
+            return 1;
+
+         /* if we make it to the end of the function, make sure we are
+          * indicating nothing matched. if we do find a later PauseIf match,
+          * it'll automatically return true via the previous condition. */
+         set_valid = 0;
+
+         if (cond->req_hits == 0)
+         {
+            /* PauseIf didn't evaluate true, and doesn't have a HitCount,
+             * reset the HitCount to indicate the condition didn't match. */
+            if (cond->curr_hits != 0)
+            {
+               cond->curr_hits = 0;
+               *dirty_conds = 1;
+            }
+         }
+         else
+         {
+            /* PauseIf has a HitCount that hasn't been met, ignore it for now. */
+         }
+      }
+      else if (cond->type == CHEEVOS_COND_TYPE_RESET_IF)
+      {
+         if (cond_valid)
+         {
+            *reset_conds = 1; /* Resets all hits found so far */
+            set_valid    = 0; /* Cannot be valid if we've hit a reset condition. */
+         }
+      }
+      else /* Sequential or non-sequential? */
+         set_valid &= cond_valid;
+   }
+
+   return set_valid;
+}
+
+int cheevos_condset_test(cheevos_condset_t* condset,
+      int* dirty_conds, int* reset_conds)
+{
+   if (!condset)
+      return 1; /* important: empty group must evaluate true */
+
+   if (condset->has_pause)
+   {  /* one or more Pause conditions exists, if any of them are true,
+       * stop processing this group. */
+      if (cheevos_condset_test_pause(condset, dirty_conds, reset_conds, 1))
+         return 0;
+   }
+
+   /* process the non-Pause conditions to see if the group is true */
+   return cheevos_condset_test_pause(condset, dirty_conds, reset_conds, 0);
+}
+
+int cheevos_condset_reset(cheevos_condset_t* condset, int deltas)
+{
+   int dirty                 = 0;
+   cheevos_cond_t *cond      = NULL;
+   const cheevos_cond_t *end = NULL;
+
+   if (!condset)
+      return 0;
+
+   cond                      = condset->conds;
+   end                       = cond + condset->count;
+
+   for (; cond < end; cond++)
+   {
+      dirty                 |= cond->curr_hits != 0;
+      cond->curr_hits        = 0;
+
+      if (deltas)
+      {
+         cond->source.previous = cond->source.value;
+         cond->target.previous = cond->target.value;
+      }
+   }
+
+   return dirty;
+}
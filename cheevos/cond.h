@@ -54,10 +54,21 @@ typedef struct
    cheevos_var_t       target;
 } cheevos_cond_t;
 
+typedef struct
+{
+   cheevos_cond_t *conds;
+   unsigned        count;
+   int             has_pause;
+} cheevos_condset_t;
+
 void     cheevos_cond_parse(cheevos_cond_t* cond, const char** memaddr);
 unsigned cheevos_cond_count_in_set(const char* memaddr, unsigned which);
 void     cheevos_cond_parse_in_set(cheevos_cond_t* cond, const char* memaddr, unsigned which);
 
+void     cheevos_condset_compile(cheevos_condset_t* condset);
+int      cheevos_condset_test(cheevos_condset_t* condset, int* dirty_conds, int* reset_conds);
+int      cheevos_condset_reset(cheevos_condset_t* condset, int deltas);
+
 RETRO_END_DECLS
 
 #endif /* __RARCH_CHEEVOS_COND_H */
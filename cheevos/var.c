@@ -149,9 +149,43 @@ void cheevos_var_parse(cheevos_var_t* var, const char** memaddr)
       }
    }
 
+   var->shift  = 0;
+   var->mask   = 0xffffffffU;
+   var->memory = NULL;
+
    if (var->type != CHEEVOS_VAR_TYPE_VALUE_COMP)
    {
       var->size = cheevos_var_parse_prefix(&str);
+
+      switch (var->size)
+      {
+         case CHEEVOS_VAR_SIZE_BIT_0:
+         case CHEEVOS_VAR_SIZE_BIT_1:
+         case CHEEVOS_VAR_SIZE_BIT_2:
+         case CHEEVOS_VAR_SIZE_BIT_3:
+         case CHEEVOS_VAR_SIZE_BIT_4:
+         case CHEEVOS_VAR_SIZE_BIT_5:
+         case CHEEVOS_VAR_SIZE_BIT_6:
+         case CHEEVOS_VAR_SIZE_BIT_7:
+            var->shift = var->size - CHEEVOS_VAR_SIZE_BIT_0;
+            var->mask  = 0x01;
+            break;
+         case CHEEVOS_VAR_SIZE_NIBBLE_LOWER:
+            var->mask  = 0x0f;
+            break;
+         case CHEEVOS_VAR_SIZE_NIBBLE_UPPER:
+            var->shift = 4;
+            var->mask  = 0x0f;
+            break;
+         case CHEEVOS_VAR_SIZE_EIGHT_BITS:
+            var->mask  = 0xff;
+            break;
+         case CHEEVOS_VAR_SIZE_SIXTEEN_BITS:
+            var->mask  = 0xffff;
+            break;
+         case CHEEVOS_VAR_SIZE_THIRTYTWO_BITS:
+            break;
+      }
    }
 
    var->value = (unsigned)strtol(str, &end, base);
@@ -281,6 +315,10 @@ void cheevos_var_patch_addr(cheevos_var_t* var, cheevos_console_t console)
             var->value -= meminfo.size;
       }
    }
+
+   /* Resolve the address now so testing doesn't have to go through the
+    * memory maps every frame. */
+   var->memory = cheevos_var_get_memory(var);
 }
 
 /*****************************************************************************
@@ -344,55 +382,22 @@ unsigned cheevos_var_get_value(cheevos_var_t* var)
 
       case CHEEVOS_VAR_TYPE_ADDRESS:
       case CHEEVOS_VAR_TYPE_DELTA_MEM:
-         memory = cheevos_var_get_memory(var);
+         memory = var->memory ? var->memory : cheevos_var_get_memory(var);
 
          if (memory)
          {
             value = memory[0];
 
-            switch (var->size)
+            if (var->size == CHEEVOS_VAR_SIZE_SIXTEEN_BITS)
+               value |= memory[1] << 8;
+            else if (var->size == CHEEVOS_VAR_SIZE_THIRTYTWO_BITS)
             {
-               case CHEEVOS_VAR_SIZE_BIT_0:
-                  value &= 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_BIT_1:
-                  value = (value >> 1) & 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_BIT_2:
-                  value = (value >> 2) & 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_BIT_3:
-                  value = (value >> 3) & 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_BIT_4:
-                  value = (value >> 4) & 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_BIT_5:
-                  value = (value >> 5) & 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_BIT_6:
-                  value = (value >> 6) & 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_BIT_7:
-                  value = (value >> 7) & 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_NIBBLE_LOWER:
-                  value &= 0x0f;
-                  break;
-               case CHEEVOS_VAR_SIZE_NIBBLE_UPPER:
-                  value = (value >> 4) & 0x0f;
-                  break;
-               case CHEEVOS_VAR_SIZE_EIGHT_BITS:
-                  break;
-               case CHEEVOS_VAR_SIZE_SIXTEEN_BITS:
-                  value |= memory[1] << 8;
-                  break;
-               case CHEEVOS_VAR_SIZE_THIRTYTWO_BITS:
-                  value |= memory[1] << 8;
-                  value |= memory[2] << 16;
-                  value |= memory[3] << 24;
-                  break;
+               value |= memory[1] << 8;
+               value |= memory[2] << 16;
+               value |= (unsigned)memory[3] << 24;
             }
+
+            value = (value >> var->shift) & var->mask;
          }
 
          if (var->type == CHEEVOS_VAR_TYPE_DELTA_MEM)
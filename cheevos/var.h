@@ -65,6 +65,15 @@ typedef struct
    bool               is_bcd;
    unsigned           value;
    unsigned           previous;
+
+   /* Size-specialized reader, filled in by cheevos_var_parse: the value
+    * is read as (bytes >> shift) & mask. */
+   unsigned           shift;
+   unsigned           mask;
+
+   /* Direct pointer into the core's memory, resolved once by
+    * cheevos_var_patch_addr. NULL means look it up on every read. */
+   const uint8_t     *memory;
 } cheevos_var_t;
 
 void cheevos_var_parse(cheevos_var_t* var, const char** memaddr);
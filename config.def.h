@@ -163,6 +163,12 @@ static const unsigned hard_sync_frames = 0;
  */
 static const unsigned frame_delay = 0;
 
+/* Picks the frame delay automatically from the measured core
+ * run time, keeping frame_delay_auto_margin milliseconds of
+ * headroom before the next VSync. */
+static const bool frame_delay_auto = false;
+static const unsigned frame_delay_auto_margin = 2;
+
 /* Inserts a black frame inbetween frames.
  * Useful for 120 Hz monitors who want to play 60 Hz material with eliminated
  * ghosting. video_refresh_rate should still be configured as if it
@@ -424,9 +430,17 @@ static const bool post_filter_record = false;
 /* Screenshots post-shaded GPU output if available. */
 static const bool gpu_screenshot = true;
 
+/* zlib compression level (0-9) of PNG screenshots and
+ * savestate thumbnails. Higher is smaller but slower. */
+static const unsigned screenshot_compression_level = 5;
+
 /* Watch shader files for changes and auto-apply as necessary. */
 static const bool video_shader_watch_files = false;
 
+/* Build shader presets in the background and swap them in
+ * once ready, instead of stalling video while they compile. */
+static const bool video_shader_async_load = false;
+
 /* Screenshots named automatically. */
 static const bool auto_screenshot_filename = true;
 
@@ -486,6 +500,13 @@ static const int out_latency = 64;
 /* Will sync audio. (recommended) */
 static const bool audio_sync = true;
 
+/* Run audio conversion, DSP, resampling and output
+ * on a dedicated thread instead of the core thread. */
+static const bool audio_pipeline_threaded = false;
+
+/* Measure end-to-end audio latency and underruns. */
+static const bool audio_latency_stats_enable = false;
+
 /* Audio rate control. */
 #if !defined(RARCH_CONSOLE)
 static const bool rate_control = true;
@@ -616,6 +637,10 @@ static const float fastforward_ratio = 0.0;
 /* Enable runloop for variable refresh rate screens. Force x1 speed while handling fast forward too. */
 static const bool vrr_runloop_enable = false;
 
+/* Pace frames against microsecond deadlines with a high
+ * resolution timer instead of millisecond sleeps. */
+static const bool frame_pacing_precise = false;
+
 /* Run core logic one or more frames ahead then load the state back to reduce perceived input lag. */
 static const unsigned run_ahead_frames = 1;
 
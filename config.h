@@ -0,0 +1,144 @@
+#ifndef QB_CONFIG_H__
+#define QB_CONFIG_H__
+
+#define PACKAGE_NAME "retroarch"
+#define HAVE_7ZIP 1
+/* #undef HAVE_AL */
+/* #undef HAVE_ALSA */
+/* #undef HAVE_AVCODEC */
+/* #undef HAVE_AVDEVICE */
+/* #undef HAVE_AVFORMAT */
+/* #undef HAVE_AVRESAMPLE */
+/* #undef HAVE_AVUTIL */
+/* #undef HAVE_AV_CHANNEL_LAYOUT */
+#define HAVE_BUILTINFLAC 1
+#if __cplusplus || __STDC_VERSION__ >= 199901L
+#define HAVE_BUILTINMINIUPNPC 1
+#endif
+/* #undef HAVE_BUILTINZLIB */
+#define HAVE_C99 1
+/* #undef HAVE_CACA */
+#define HAVE_CC 1
+/* #undef HAVE_CG */
+#define HAVE_CHD 1
+#define HAVE_CHEEVOS 1
+#define HAVE_COMMAND 1
+#define HAVE_CXX 1
+/* #undef HAVE_D3D10 */
+/* #undef HAVE_D3D11 */
+/* #undef HAVE_D3D12 */
+/* #undef HAVE_D3D8 */
+/* #undef HAVE_D3D9 */
+#define HAVE_D3DX 1
+/* #undef HAVE_DBUS */
+#if __cplusplus || __STDC_VERSION__ >= 199901L
+#define HAVE_DISCORD 1
+#endif
+/* #undef HAVE_DISPMANX */
+/* #undef HAVE_DRM */
+#define HAVE_DYLIB 1
+#define HAVE_DYNAMIC 1
+#define HAVE_EGL 1
+/* #undef HAVE_EXYNOS */
+/* #undef HAVE_FFMPEG */
+/* #undef HAVE_FLAC */
+/* #undef HAVE_FLOATHARD */
+/* #undef HAVE_FLOATSOFTFP */
+#define HAVE_FREETYPE 1
+/* #undef HAVE_GBM */
+#define HAVE_GETADDRINFO 1
+#define HAVE_GETOPT_LONG 1
+#define HAVE_HID 1
+/* #undef HAVE_HLSL */
+#define HAVE_IBXM 1
+#define HAVE_IMAGEVIEWER 1
+/* #undef HAVE_JACK */
+/* #undef HAVE_KMS */
+#define HAVE_LANGEXTRA 1
+#define HAVE_LIBRETRODB 1
+/* #undef HAVE_LIBUSB */
+#define HAVE_LIBXML2 1
+/* #undef HAVE_MALI_FBDEV */
+/* #undef HAVE_MINIUPNPC */
+#define HAVE_MMAP 1
+/* #undef HAVE_MPV */
+/* #undef HAVE_NEON */
+#if __cplusplus || __STDC_VERSION__ >= 199901L
+#define HAVE_NETWORKGAMEPAD 1
+#endif
+#define HAVE_NETWORKING 1
+#define HAVE_NETWORK_CMD 1
+#define HAVE_NOUNUSED 1
+#define HAVE_NOUNUSED_VARIABLE 1
+/* #undef HAVE_NUKLEAR */
+/* #undef HAVE_OMAP */
+/* #undef HAVE_OPENDINGUX_FBDEV */
+#define HAVE_OPENGL 1
+/* #undef HAVE_OPENGLES */
+/* #undef HAVE_OPENGLES3 */
+/* #undef HAVE_OSMESA */
+#define HAVE_OSS 1
+/* #undef HAVE_OSS_BSD */
+/* #undef HAVE_OSS_LIB */
+#define HAVE_OVERLAY 1
+#define HAVE_PARPORT 1
+/* #undef HAVE_PLAIN_DRM */
+/* #undef HAVE_PRESERVE_DYLIB */
+/* #undef HAVE_PULSE */
+/* #undef HAVE_PYTHON */
+#define HAVE_RBMP 1
+#define HAVE_RGUI 1
+#define HAVE_RJPEG 1
+/* #undef HAVE_ROAR */
+#define HAVE_RPILED 1
+#define HAVE_RPNG 1
+/* #undef HAVE_RSOUND */
+#define HAVE_RTGA 1
+#define HAVE_RUNAHEAD 1
+/* #undef HAVE_SDL */
+/* #undef HAVE_SDL2 */
+#if __cplusplus || __STDC_VERSION__ >= 199901L
+#define HAVE_SHADERPIPELINE 1
+#endif
+/* #undef HAVE_SIXEL */
+/* #undef HAVE_SOCKET_LEGACY */
+/* #undef HAVE_SSA */
+/* #undef HAVE_SSE */
+#if __cplusplus || __STDC_VERSION__ >= 199901L
+#define HAVE_SSL 1
+#endif
+#define HAVE_STB_FONT 1
+#define HAVE_STB_IMAGE 1
+#define HAVE_STB_VORBIS 1
+#define HAVE_STDIN_CMD 1
+#define HAVE_STRCASESTR 1
+/* #undef HAVE_STRIPES */
+/* #undef HAVE_SUNXI */
+/* #undef HAVE_SWRESAMPLE */
+/* #undef HAVE_SWSCALE */
+/* #undef HAVE_SYSTEMD */
+#define HAVE_THREADS 1
+#define HAVE_THREAD_STORAGE 1
+#define HAVE_TINYALSA 1
+/* #undef HAVE_UDEV */
+#define HAVE_UPDATE_ASSETS 1
+/* #undef HAVE_V4L2 */
+/* #undef HAVE_VC_TEST */
+/* #undef HAVE_VG */
+/* #undef HAVE_VIDEOCORE */
+/* #undef HAVE_VIVANTE_FBDEV */
+/* #undef HAVE_VULKAN */
+#define HAVE_VULKAN_DISPLAY 1
+/* #undef HAVE_WAYLAND */
+/* #undef HAVE_WAYLAND_CURSOR */
+/* #undef HAVE_X11 */
+#define HAVE_XCB 1
+#define HAVE_XEXT 1
+/* #undef HAVE_XF86VM */
+/* #undef HAVE_XINERAMA */
+/* #undef HAVE_XKBCOMMON */
+/* #undef HAVE_XSHM */
+/* #undef HAVE_XVIDEO */
+/* #undef HAVE_ZARCH */
+#define HAVE_ZLIB 1
+#endif
@@ -0,0 +1,182 @@
+CC = /usr/bin/gcc
+CFLAGS = -fcommon
+CXX = /usr/bin/g++
+CXXFLAGS = 
+WINDRES = 
+MOC = 
+ASFLAGS = 
+LDFLAGS = 
+INCLUDE_DIRS = -I./deps/7zip
+LIBRARY_DIRS = -L/usr/lib64
+PACKAGE_NAME = retroarch
+BUILD = 
+PREFIX = /usr/local
+HAVE_7ZIP = 1
+HAVE_AL = 0
+HAVE_ALSA = 0
+HAVE_AVCODEC = 0
+HAVE_AVDEVICE = 0
+HAVE_AVFORMAT = 0
+HAVE_AVRESAMPLE = 0
+HAVE_AVUTIL = 0
+HAVE_AV_CHANNEL_LAYOUT = 0
+HAVE_BUILTINFLAC = 1
+ifneq ($(C89_BUILD),1)
+HAVE_BUILTINMINIUPNPC = 1
+endif
+HAVE_BUILTINZLIB = 0
+HAVE_C99 = 1
+HAVE_CACA = 0
+HAVE_CC = 1
+HAVE_CG = 0
+HAVE_CHD = 1
+HAVE_CHEEVOS = 1
+HAVE_COMMAND = 1
+HAVE_CXX = 1
+HAVE_D3D10 = 0
+HAVE_D3D11 = 0
+HAVE_D3D12 = 0
+HAVE_D3D8 = 0
+HAVE_D3D9 = 0
+HAVE_D3DX = 1
+HAVE_DBUS = 0
+ifneq ($(C89_BUILD),1)
+HAVE_DISCORD = 1
+endif
+HAVE_DISPMANX = 0
+HAVE_DRM = 0
+HAVE_DYLIB = 1
+DYLIB_LIBS = -ldl
+HAVE_DYNAMIC = 1
+DYNAMIC_LIBS = -ldl
+HAVE_EGL = 1
+EGL_LIBS = -lEGL
+HAVE_EXYNOS = 0
+HAVE_FFMPEG = 0
+HAVE_FLAC = 0
+HAVE_FLOATHARD = 0
+HAVE_FLOATSOFTFP = 0
+HAVE_FREETYPE = 1
+FREETYPE_CFLAGS = -I/usr/include/freetype2 -I/usr/include/libpng16
+FREETYPE_LIBS = -lfreetype
+HAVE_GBM = 0
+HAVE_GETADDRINFO = 1
+GETADDRINFO_LIBS = -lc
+HAVE_GETOPT_LONG = 1
+GETOPT_LONG_LIBS = -lc
+HAVE_HID = 1
+HAVE_HLSL = 0
+HAVE_IBXM = 1
+HAVE_IMAGEVIEWER = 1
+HAVE_JACK = 0
+HAVE_KMS = 0
+HAVE_LANGEXTRA = 1
+HAVE_LIBRETRODB = 1
+HAVE_LIBUSB = 0
+HAVE_LIBXML2 = 1
+LIBXML2_CFLAGS = -I/usr/include/libxml2
+LIBXML2_LIBS = -lxml2
+HAVE_MALI_FBDEV = 0
+HAVE_MINIUPNPC = 0
+HAVE_MMAP = 1
+MMAP_LIBS = -lc
+HAVE_MPV = 0
+HAVE_NEON = 0
+ifneq ($(C89_BUILD),1)
+HAVE_NETWORKGAMEPAD = 1
+endif
+HAVE_NETWORKING = 1
+NETWORKING_LIBS = -lc
+HAVE_NETWORK_CMD = 1
+HAVE_NOUNUSED = 1
+HAVE_NOUNUSED_VARIABLE = 1
+HAVE_NUKLEAR = 0
+HAVE_OMAP = 0
+HAVE_OPENDINGUX_FBDEV = 0
+HAVE_OPENGL = 1
+OPENGL_LIBS = -lGL
+HAVE_OPENGLES = 0
+HAVE_OPENGLES3 = 0
+HAVE_OSMESA = 0
+HAVE_OSS = 1
+HAVE_OSS_BSD = 0
+HAVE_OSS_LIB = 0
+HAVE_OVERLAY = 1
+HAVE_PARPORT = 1
+HAVE_PLAIN_DRM = 0
+HAVE_PRESERVE_DYLIB = 0
+HAVE_PULSE = 0
+HAVE_PYTHON = 0
+HAVE_RBMP = 1
+HAVE_RGUI = 1
+HAVE_RJPEG = 1
+HAVE_ROAR = 0
+HAVE_RPILED = 1
+HAVE_RPNG = 1
+HAVE_RSOUND = 0
+HAVE_RTGA = 1
+HAVE_RUNAHEAD = 1
+HAVE_SDL = 0
+HAVE_SDL2 = 0
+ifneq ($(C89_BUILD),1)
+HAVE_SHADERPIPELINE = 1
+endif
+HAVE_SIXEL = 0
+HAVE_SOCKET_LEGACY = 0
+HAVE_SSA = 0
+HAVE_SSE = 0
+ifneq ($(C89_BUILD),1)
+HAVE_SSL = 1
+endif
+HAVE_STB_FONT = 1
+HAVE_STB_IMAGE = 1
+HAVE_STB_VORBIS = 1
+HAVE_STDIN_CMD = 1
+STDIN_CMD_LIBS = -lc
+HAVE_STRCASESTR = 1
+STRCASESTR_LIBS = -lc
+HAVE_STRIPES = 0
+HAVE_SUNXI = 0
+HAVE_SWRESAMPLE = 0
+HAVE_SWSCALE = 0
+HAVE_SYSTEMD = 0
+HAVE_THREADS = 1
+THREADS_LIBS = -lpthread
+HAVE_THREAD_STORAGE = 1
+THREAD_STORAGE_LIBS = -lpthread
+HAVE_TINYALSA = 1
+HAVE_UDEV = 0
+HAVE_UPDATE_ASSETS = 1
+HAVE_V4L2 = 0
+HAVE_VC_TEST = 0
+HAVE_VG = 0
+HAVE_VIDEOCORE = 0
+HAVE_VIVANTE_FBDEV = 0
+HAVE_VULKAN = 0
+HAVE_VULKAN_DISPLAY = 1
+HAVE_WAYLAND = 0
+HAVE_WAYLAND_CURSOR = 0
+HAVE_X11 = 0
+X11_LIBS = -lX11
+HAVE_XCB = 1
+XCB_LIBS = -lxcb
+HAVE_XEXT = 1
+XEXT_LIBS = -lXext
+HAVE_XF86VM = 0
+HAVE_XINERAMA = 0
+HAVE_XKBCOMMON = 0
+HAVE_XSHM = 0
+HAVE_XVIDEO = 0
+HAVE_ZARCH = 0
+HAVE_ZLIB = 1
+ZLIB_LIBS = -lz
+NOUNUSED = yes
+NOUNUSED_VARIABLE = yes
+DATA_DIR = /usr/local/share
+DYLIB_LIB = -ldl
+ASSETS_DIR = /usr/local/share/retroarch
+BIN_DIR = /usr/local/bin
+DOC_DIR = /usr/local/share/doc/retroarch
+MAN_DIR = /usr/local/share/man
+OS = Linux
+GLOBAL_CONFIG_DIR = /etc
@@ -1281,14 +1281,21 @@ static struct config_bool_setting *populate_settings_bool(settings_t *settings,
    SETTING_BOOL("suspend_screensaver_enable",    &settings->bools.ui_suspend_screensaver_enable, true, true, false);
    SETTING_BOOL("rewind_enable",                 &settings->bools.rewind_enable, true, rewind_enable, false);
    SETTING_BOOL("vrr_runloop_enable",            &settings->bools.vrr_runloop_enable, true, vrr_runloop_enable, false);
+   SETTING_BOOL("frame_pacing_precise",          &settings->bools.frame_pacing_precise, true, frame_pacing_precise, false);
    SETTING_BOOL("apply_cheats_after_toggle",     &settings->bools.apply_cheats_after_toggle, true, apply_cheats_after_toggle, false);
    SETTING_BOOL("apply_cheats_after_load",       &settings->bools.apply_cheats_after_load, true, apply_cheats_after_load, false);
    SETTING_BOOL("run_ahead_enabled",             &settings->bools.run_ahead_enabled, true, false, false);
    SETTING_BOOL("run_ahead_secondary_instance",  &settings->bools.run_ahead_secondary_instance, true, false, false);
    SETTING_BOOL("run_ahead_hide_warnings",       &settings->bools.run_ahead_hide_warnings, true, false, false);
    SETTING_BOOL("audio_sync",                    &settings->bools.audio_sync, true, audio_sync, false);
+#ifdef HAVE_THREADS
+   SETTING_BOOL("audio_pipeline_threaded",       &settings->bools.audio_pipeline_threaded, true, audio_pipeline_threaded, false);
+#endif
+   SETTING_BOOL("audio_latency_stats_enable",    &settings->bools.audio_latency_stats_enable, true, audio_latency_stats_enable, false);
    SETTING_BOOL("video_shader_enable",           &settings->bools.video_shader_enable, true, shader_enable, false);
    SETTING_BOOL("video_shader_watch_files",      &settings->bools.video_shader_watch_files, true, video_shader_watch_files, false);
+   SETTING_BOOL("video_shader_async_load",       &settings->bools.video_shader_async_load, true, video_shader_async_load, false);
+   SETTING_BOOL("video_frame_delay_auto",        &settings->bools.video_frame_delay_auto, true, frame_delay_auto, false);
 
    /* Let implementation decide if automatic, or 1:1 PAR. */
    SETTING_BOOL("video_aspect_ratio_auto",       &settings->bools.video_aspect_ratio_auto, true, aspect_ratio_auto, false);
@@ -1574,9 +1581,11 @@ static struct config_uint_setting *populate_settings_uint(settings_t *settings,
    SETTING_UINT("content_history_size",         &settings->uints.content_history_size,   true, default_content_history_size, false);
    SETTING_UINT("video_hard_sync_frames",       &settings->uints.video_hard_sync_frames, true, hard_sync_frames, false);
    SETTING_UINT("video_frame_delay",            &settings->uints.video_frame_delay,      true, frame_delay, false);
+   SETTING_UINT("video_frame_delay_auto_margin", &settings->uints.video_frame_delay_auto_margin, true, frame_delay_auto_margin, false);
    SETTING_UINT("video_max_swapchain_images",   &settings->uints.video_max_swapchain_images, true, max_swapchain_images, false);
    SETTING_UINT("video_swap_interval",          &settings->uints.video_swap_interval, true, swap_interval, false);
    SETTING_UINT("video_rotation",               &settings->uints.video_rotation, true, ORIENTATION_NORMAL, false);
+   SETTING_UINT("screenshot_compression_level", &settings->uints.screenshot_compression_level, true, screenshot_compression_level, false);
    SETTING_UINT("aspect_ratio_index",           &settings->uints.video_aspect_ratio_idx, true, aspect_ratio_idx, false);
 #ifdef HAVE_NETWORKING
    SETTING_UINT("netplay_ip_port",              &settings->uints.netplay_port,         true, RARCH_DEFAULT_PORT, false);
@@ -2757,6 +2766,12 @@ static bool config_load_file(const char *path, bool set_defaults,
    if (settings->uints.video_frame_delay > 15)
       settings->uints.video_frame_delay = 15;
 
+   if (settings->uints.video_frame_delay_auto_margin > 15)
+      settings->uints.video_frame_delay_auto_margin = 15;
+
+   if (settings->uints.screenshot_compression_level > 9)
+      settings->uints.screenshot_compression_level = 9;
+
    settings->uints.video_swap_interval = MAX(settings->uints.video_swap_interval, 1);
    settings->uints.video_swap_interval = MIN(settings->uints.video_swap_interval, 4);
 
@@ -84,6 +84,8 @@ typedef struct settings
       bool video_scale_integer;
       bool video_shader_enable;
       bool video_shader_watch_files;
+      bool video_shader_async_load;
+      bool video_frame_delay_auto;
       bool video_threaded;
       bool video_font_enable;
       bool video_disable_composition;
@@ -104,6 +106,8 @@ typedef struct settings
       bool audio_enable_menu;
       bool audio_sync;
       bool audio_rate_control;
+      bool audio_pipeline_threaded;
+      bool audio_latency_stats_enable;
       bool audio_wasapi_exclusive_mode;
       bool audio_wasapi_float_format;
 
@@ -241,6 +245,7 @@ typedef struct settings
       bool playlist_entry_rename;
       bool rewind_enable;
       bool vrr_runloop_enable;
+      bool frame_pacing_precise;
       bool apply_cheats_after_toggle;
       bool apply_cheats_after_load;
       bool run_ahead_enabled;
@@ -368,9 +373,11 @@ typedef struct settings
       unsigned video_swap_interval;
       unsigned video_hard_sync_frames;
       unsigned video_frame_delay;
+      unsigned video_frame_delay_auto_margin;
       unsigned video_viwidth;
       unsigned video_aspect_ratio_idx;
       unsigned video_rotation;
+      unsigned screenshot_compression_level;
       unsigned video_msg_bgcolor_red;
       unsigned video_msg_bgcolor_green;
       unsigned video_msg_bgcolor_blue;
@@ -1115,6 +1115,7 @@ typedef struct MTLALIGN(16)
    
    config_file_t *conf = config_file_new(path.UTF8String);
    struct video_shader *shader = (struct video_shader *)calloc(1, sizeof(*shader));
+   slang_compiled_passes_t *compiled = NULL;
    
    @try
    {
@@ -1123,6 +1124,9 @@ typedef struct MTLALIGN(16)
       
       video_shader_resolve_relative(shader, path.UTF8String);
       
+      /* Compiles every pass up front, in parallel. */
+      compiled = slang_compile_passes(shader, RARCH_SHADER_METAL, 20000);
+      
       texture_t *source = &_engine.frame.texture[0];
       for (unsigned i = 0; i < shader->passes; source = &_engine.pass[i++].rt)
       {
@@ -1162,7 +1166,7 @@ typedef struct MTLALIGN(16)
          };
          /* clang-format on */
          
-         if (!slang_process(shader, i, RARCH_SHADER_METAL, 20000, &semantics_map, &_engine.pass[i].semantics))
+         if (!slang_process(shader, i, RARCH_SHADER_METAL, 20000, &semantics_map, &_engine.pass[i].semantics, compiled))
             return NO;
 
 #ifdef DEBUG
@@ -1323,6 +1327,8 @@ typedef struct MTLALIGN(16)
    }
    @finally
    {
+      slang_compiled_passes_free(compiled);
+      
       if (shader)
       {
          [self _freeVideoShader:shader];
@@ -385,6 +385,55 @@ void vulkan_copy_staging_to_dynamic(vk_t *vk, VkCommandBuffer cmd,
    dynamic->layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 }
 
+void vulkan_copy_staging_to_dynamic_rect(vk_t *vk, VkCommandBuffer cmd,
+      struct vk_texture *dynamic,
+      struct vk_texture *staging,
+      unsigned x, unsigned y, unsigned width, unsigned height)
+{
+   VkBufferImageCopy region;
+   unsigned bpp = vulkan_format_to_bpp(dynamic->format);
+
+   retro_assert(dynamic->type == VULKAN_TEXTURE_DYNAMIC);
+   retro_assert(staging->type == VULKAN_TEXTURE_STAGING);
+
+   vulkan_sync_texture_to_gpu(vk, staging);
+
+   /* Unlike a full copy, the previous contents have to be preserved,
+    * so transition from the current layout rather than UNDEFINED. */
+   vulkan_image_layout_transition(vk, cmd, dynamic->image,
+         dynamic->layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+         VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+         VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+   memset(&region, 0, sizeof(region));
+   region.bufferOffset                = y * staging->stride + x * bpp;
+   region.bufferRowLength             = staging->stride / bpp;
+   region.imageOffset.x               = x;
+   region.imageOffset.y               = y;
+   region.imageExtent.width           = width;
+   region.imageExtent.height          = height;
+   region.imageExtent.depth           = 1;
+   region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+   region.imageSubresource.layerCount = 1;
+
+   vkCmdCopyBufferToImage(cmd,
+         staging->buffer,
+         dynamic->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+         1, &region);
+
+   vulkan_image_layout_transition(vk, cmd,
+         dynamic->image,
+         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+         VK_ACCESS_TRANSFER_WRITE_BIT,
+         VK_ACCESS_SHADER_READ_BIT,
+         VK_PIPELINE_STAGE_TRANSFER_BIT,
+         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+   dynamic->layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
+
 #ifdef VULKAN_DEBUG_TEXTURE_ALLOC
 static VkImage vk_images[4 * 1024];
 static unsigned vk_count;
@@ -2484,6 +2533,19 @@ bool vulkan_surface_create(gfx_ctx_vulkan_data_t *vk,
    return true;
 }
 
+/* vkDeviceWaitIdle needs every queue externally synchronized,
+ * and the filter chain may be submitting from another thread. */
+static void vulkan_device_wait_idle(gfx_ctx_vulkan_data_t *vk)
+{
+#ifdef HAVE_THREADS
+   slock_lock(vk->context.queue_lock);
+#endif
+   vkDeviceWaitIdle(vk->context.device);
+#ifdef HAVE_THREADS
+   slock_unlock(vk->context.queue_lock);
+#endif
+}
+
 static void vulkan_destroy_swapchain(gfx_ctx_vulkan_data_t *vk)
 {
    unsigned i;
@@ -2491,7 +2553,7 @@ static void vulkan_destroy_swapchain(gfx_ctx_vulkan_data_t *vk)
    vulkan_emulated_mailbox_deinit(&vk->mailbox);
    if (vk->swapchain != VK_NULL_HANDLE)
    {
-      vkDeviceWaitIdle(vk->context.device);
+      vulkan_device_wait_idle(vk);
       vkDestroySwapchainKHR(vk->context.device, vk->swapchain, NULL);
       memset(vk->context.swapchain_images, 0, sizeof(vk->context.swapchain_images));
       vk->swapchain = VK_NULL_HANDLE;
@@ -2541,6 +2603,9 @@ void vulkan_present(gfx_ctx_vulkan_data_t *vk, unsigned index)
    slock_lock(vk->context.queue_lock);
 #endif
    err = vkQueuePresentKHR(vk->context.queue, &present);
+#ifdef HAVE_THREADS
+   slock_unlock(vk->context.queue_lock);
+#endif
 
 #ifdef WSI_HARDENING_TEST
    trigger_spurious_error_vkresult(&err);
@@ -2551,10 +2616,6 @@ void vulkan_present(gfx_ctx_vulkan_data_t *vk, unsigned index)
       RARCH_LOG("[Vulkan]: QueuePresent failed, destroying swapchain.\n");
       vulkan_destroy_swapchain(vk);
    }
-
-#ifdef HAVE_THREADS
-   slock_unlock(vk->context.queue_lock);
-#endif
 }
 
 void vulkan_context_destroy(gfx_ctx_vulkan_data_t *vk,
@@ -2564,7 +2625,7 @@ void vulkan_context_destroy(gfx_ctx_vulkan_data_t *vk,
       return;
 
    if (vk->context.device)
-      vkDeviceWaitIdle(vk->context.device);
+      vulkan_device_wait_idle(vk);
 
    vulkan_destroy_swapchain(vk);
 
@@ -2791,7 +2852,7 @@ bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
    VkCompositeAlphaFlagBitsKHR composite   = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
    VkResult res;
 
-   vkDeviceWaitIdle(vk->context.device);
+   vulkan_device_wait_idle(vk);
    vulkan_acquire_clear_fences(vk);
 
    if (swap_interval == 0 && vk->emulate_mailbox)
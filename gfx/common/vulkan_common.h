@@ -428,6 +428,8 @@ typedef struct vk
    } tracker;
 
    void *filter_chain;
+   /* Filter chain being built in the background, if any. */
+   void *shader_job;
 } vk_t;
 
 uint32_t vulkan_find_memory_type(
@@ -471,6 +473,13 @@ void vulkan_copy_staging_to_dynamic(vk_t *vk, VkCommandBuffer cmd,
       struct vk_texture *dynamic,
       struct vk_texture *staging);
 
+/* Like vulkan_copy_staging_to_dynamic, but only copies the given
+ * region and keeps the rest of the dynamic texture intact. */
+void vulkan_copy_staging_to_dynamic_rect(vk_t *vk, VkCommandBuffer cmd,
+      struct vk_texture *dynamic,
+      struct vk_texture *staging,
+      unsigned x, unsigned y, unsigned width, unsigned height);
+
 /* VBO will be written to here. */
 void vulkan_draw_quad(vk_t *vk, const struct vk_draw_quad *quad);
 
@@ -303,6 +303,7 @@ static bool d3d10_gfx_set_shader(void* data,
 {
 #if defined(HAVE_SLANG) && defined(HAVE_SPIRV_CROSS)
    unsigned         i;
+   slang_compiled_passes_t* compiled = NULL;
    config_file_t* conf     = NULL;
    d3d10_texture_t* source = NULL;
    d3d10_video_t*   d3d10  = (d3d10_video_t*)data;
@@ -334,6 +335,10 @@ static bool d3d10_gfx_set_shader(void* data,
 
    video_shader_resolve_relative(d3d10->shader_preset, path);
 
+   /* Compiles every pass up front, in parallel. */
+   compiled = slang_compile_passes(
+         d3d10->shader_preset, RARCH_SHADER_HLSL, 40);
+
    source = &d3d10->frame.texture[0];
    for (i = 0; i < d3d10->shader_preset->passes; source = &d3d10->pass[i++].rt)
    {
@@ -376,7 +381,7 @@ static bool d3d10_gfx_set_shader(void* data,
 
       if (!slang_process(
                d3d10->shader_preset, i, RARCH_SHADER_HLSL, 40, &semantics_map,
-               &d3d10->pass[i].semantics))
+               &d3d10->pass[i].semantics, compiled))
          goto error;
 
       {
@@ -453,6 +458,9 @@ static bool d3d10_gfx_set_shader(void* data,
       }
    }
 
+   slang_compiled_passes_free(compiled);
+   compiled = NULL;
+
    for (i = 0; i < d3d10->shader_preset->luts; i++)
    {
       struct texture_image image = { 0 };
@@ -488,6 +496,7 @@ static bool d3d10_gfx_set_shader(void* data,
    return true;
 
 error:
+   slang_compiled_passes_free(compiled);
    d3d10_free_shader_preset(d3d10);
 #endif
 
@@ -318,6 +318,7 @@ static bool d3d11_gfx_set_shader(void* data, enum rarch_shader_type type, const
 {
 #if defined(HAVE_SLANG) && defined(HAVE_SPIRV_CROSS)
    unsigned         i;
+   slang_compiled_passes_t* compiled = NULL;
    config_file_t* conf     = NULL;
    d3d11_texture_t* source = NULL;
    d3d11_video_t*   d3d11  = (d3d11_video_t*)data;
@@ -349,6 +350,10 @@ static bool d3d11_gfx_set_shader(void* data, enum rarch_shader_type type, const
 
    video_shader_resolve_relative(d3d11->shader_preset, path);
 
+   /* Compiles every pass up front, in parallel. */
+   compiled = slang_compile_passes(
+         d3d11->shader_preset, RARCH_SHADER_HLSL, 40);
+
    source = &d3d11->frame.texture[0];
    for (i = 0; i < d3d11->shader_preset->passes; source = &d3d11->pass[i++].rt)
    {
@@ -391,7 +396,7 @@ static bool d3d11_gfx_set_shader(void* data, enum rarch_shader_type type, const
 
       if (!slang_process(
                d3d11->shader_preset, i, RARCH_SHADER_HLSL, 40, &semantics_map,
-               &d3d11->pass[i].semantics))
+               &d3d11->pass[i].semantics, compiled))
          goto error;
 
       {
@@ -467,6 +472,9 @@ static bool d3d11_gfx_set_shader(void* data, enum rarch_shader_type type, const
       }
    }
 
+   slang_compiled_passes_free(compiled);
+   compiled = NULL;
+
    for (i = 0; i < d3d11->shader_preset->luts; i++)
    {
       struct texture_image image = { 0 };
@@ -500,6 +508,7 @@ static bool d3d11_gfx_set_shader(void* data, enum rarch_shader_type type, const
    return true;
 
 error:
+   slang_compiled_passes_free(compiled);
    d3d11_free_shader_preset(d3d11);
 #endif
    return false;
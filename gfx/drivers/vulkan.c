@@ -20,6 +20,9 @@
 #include <string.h>
 
 #include <compat/strl.h>
+#include <string/stdstring.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
 #include <formats/image.h>
@@ -43,6 +46,7 @@
 
 #include "../../driver.h"
 #include "../../configuration.h"
+#include "../../paths.h"
 #include "../../record/record_driver.h"
 
 #include "../../retroarch.h"
@@ -738,28 +742,35 @@ static void vulkan_deinit_framebuffers(vk_t *vk)
    vkDestroyRenderPass(vk->context->device, vk->render_pass, NULL);
 }
 
+static void vulkan_init_filter_chain_info(vk_t *vk,
+      struct vulkan_filter_chain_create_info *info)
+{
+   memset(info, 0, sizeof(*info));
+
+   info->device                = vk->context->device;
+   info->gpu                   = vk->context->gpu;
+   info->memory_properties     = &vk->context->memory_properties;
+   info->pipeline_cache        = vk->pipelines.cache;
+   info->queue                 = vk->context->queue;
+   info->queue_lock            = vk->context->queue_lock;
+   info->command_pool          = vk->swapchain[vk->context->current_swapchain_index].cmd_pool;
+   info->max_input_size.width  = vk->tex_w;
+   info->max_input_size.height = vk->tex_h;
+   info->swapchain.viewport    = vk->vk_vp;
+   info->swapchain.format      = vk->context->swapchain_format;
+   info->swapchain.render_pass = vk->render_pass;
+   info->swapchain.num_indices = vk->context->num_swapchain_images;
+   info->original_format       = vk->tex_fmt;
+}
+
 static bool vulkan_init_default_filter_chain(vk_t *vk)
 {
    struct vulkan_filter_chain_create_info info;
 
-   memset(&info, 0, sizeof(info));
-
    if (!vk->context)
       return false;
 
-   info.device                = vk->context->device;
-   info.gpu                   = vk->context->gpu;
-   info.memory_properties     = &vk->context->memory_properties;
-   info.pipeline_cache        = vk->pipelines.cache;
-   info.queue                 = vk->context->queue;
-   info.command_pool          = vk->swapchain[vk->context->current_swapchain_index].cmd_pool;
-   info.max_input_size.width  = vk->tex_w;
-   info.max_input_size.height = vk->tex_h;
-   info.swapchain.viewport    = vk->vk_vp;
-   info.swapchain.format      = vk->context->swapchain_format;
-   info.swapchain.render_pass = vk->render_pass;
-   info.swapchain.num_indices = vk->context->num_swapchain_images;
-   info.original_format       = vk->tex_fmt;
+   vulkan_init_filter_chain_info(vk, &info);
 
    vk->filter_chain           = vulkan_filter_chain_create_default(
          &info,
@@ -779,21 +790,7 @@ static bool vulkan_init_filter_chain_preset(vk_t *vk, const char *shader_path)
 {
    struct vulkan_filter_chain_create_info info;
 
-   memset(&info, 0, sizeof(info));
-
-   info.device                = vk->context->device;
-   info.gpu                   = vk->context->gpu;
-   info.memory_properties     = &vk->context->memory_properties;
-   info.pipeline_cache        = vk->pipelines.cache;
-   info.queue                 = vk->context->queue;
-   info.command_pool          = vk->swapchain[vk->context->current_swapchain_index].cmd_pool;
-   info.max_input_size.width  = vk->tex_w;
-   info.max_input_size.height = vk->tex_h;
-   info.swapchain.viewport    = vk->vk_vp;
-   info.swapchain.format      = vk->context->swapchain_format;
-   info.swapchain.render_pass = vk->render_pass;
-   info.swapchain.num_indices = vk->context->num_swapchain_images;
-   info.original_format       = vk->tex_fmt;
+   vulkan_init_filter_chain_info(vk, &info);
 
    vk->filter_chain           = vulkan_filter_chain_create_from_preset(
          &info, shader_path,
@@ -809,6 +806,171 @@ static bool vulkan_init_filter_chain_preset(vk_t *vk, const char *shader_path)
    return true;
 }
 
+static void vulkan_update_filter_chain(vk_t *vk);
+#ifdef HAVE_THREADS
+/* Background preset loading.
+ *
+ * The new filter chain is built on a worker thread with its own
+ * command pool while the current chain keeps rendering; queue
+ * access on both sides goes through the context queue lock.
+ * vulkan_frame() swaps the new chain in at the start of the first
+ * frame after the worker is done. Until then no shader is reported
+ * as current, so parameter edits cannot go to the outgoing chain. */
+struct vulkan_shader_job
+{
+   struct vulkan_filter_chain_create_info info;
+   enum vulkan_filter_chain_filter filter;
+   char path[PATH_MAX_LENGTH];
+   char prev_path[PATH_MAX_LENGTH];
+   vulkan_filter_chain_t *chain;
+   sthread_t *thread;
+   slock_t *lock;
+   bool done;
+};
+
+static void vulkan_shader_job_thread(void *data)
+{
+   struct vulkan_shader_job *job = (struct vulkan_shader_job*)data;
+   vulkan_filter_chain_t *chain  = vulkan_filter_chain_create_from_preset(
+         &job->info, job->path, job->filter);
+
+   slock_lock(job->lock);
+   job->chain = chain;
+   job->done  = true;
+   slock_unlock(job->lock);
+}
+
+static void vulkan_shader_job_wait(struct vulkan_shader_job *job)
+{
+   if (!job || !job->thread)
+      return;
+
+   sthread_join(job->thread);
+   job->thread = NULL;
+}
+
+static void vulkan_shader_job_free(vk_t *vk, struct vulkan_shader_job *job)
+{
+   if (!job)
+      return;
+
+   vulkan_shader_job_wait(job);
+
+   if (job->chain)
+      vulkan_filter_chain_free(job->chain);
+   if (job->info.command_pool != VK_NULL_HANDLE)
+      vkDestroyCommandPool(vk->context->device,
+            job->info.command_pool, NULL);
+   if (job->lock)
+      slock_free(job->lock);
+   free(job);
+}
+
+static void vulkan_shader_job_cancel(vk_t *vk)
+{
+   struct vulkan_shader_job *job = (struct vulkan_shader_job*)vk->shader_job;
+
+   vk->shader_job = NULL;
+   vulkan_shader_job_free(vk, job);
+}
+
+static bool vulkan_shader_job_begin(vk_t *vk, const char *path)
+{
+   VkCommandPoolCreateInfo pool_info = {
+      VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+   settings_t *settings              = config_get_ptr();
+   struct vulkan_shader_job *job     = (struct vulkan_shader_job*)
+      calloc(1, sizeof(*job));
+
+   if (!job)
+      return false;
+
+   vulkan_init_filter_chain_info(vk, &job->info);
+   job->info.command_pool = VK_NULL_HANDLE;
+   job->filter            = vk->video.smooth ?
+      VULKAN_FILTER_CHAIN_LINEAR : VULKAN_FILTER_CHAIN_NEAREST;
+   strlcpy(job->path, path, sizeof(job->path));
+   /* The caller stores the new path once this returns,
+    * keep the old one in case the preset fails to build. */
+   strlcpy(job->prev_path, settings->paths.path_shader,
+         sizeof(job->prev_path));
+
+   /* The swapchain command pools belong to the video thread. */
+   pool_info.queueFamilyIndex = vk->context->graphics_queue_index;
+   pool_info.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+   if (vkCreateCommandPool(vk->context->device,
+            &pool_info, NULL, &job->info.command_pool) != VK_SUCCESS)
+      goto error;
+
+   job->lock = slock_new();
+   if (!job->lock)
+      goto error;
+
+   job->thread = sthread_create(vulkan_shader_job_thread, job);
+   if (!job->thread)
+      goto error;
+
+   vk->shader_job = job;
+   RARCH_LOG("[Vulkan]: Loading shader preset \"%s\" in the background.\n",
+         path);
+   return true;
+
+error:
+   vulkan_shader_job_free(vk, job);
+   return false;
+}
+
+static void vulkan_shader_job_poll(vk_t *vk)
+{
+   bool done                     = false;
+   struct vulkan_shader_job *job = (struct vulkan_shader_job*)vk->shader_job;
+
+   if (!job)
+      return;
+
+   slock_lock(job->lock);
+   done = job->done;
+   slock_unlock(job->lock);
+
+   if (!done)
+      return;
+
+   vk->shader_job = NULL;
+   vulkan_shader_job_wait(job);
+
+   if (vk->filter_chain)
+      vulkan_filter_chain_free((vulkan_filter_chain_t*)vk->filter_chain);
+   vk->filter_chain = job->chain;
+   job->chain       = NULL;
+
+   if (!vk->filter_chain)
+   {
+      settings_t *settings = config_get_ptr();
+
+      RARCH_ERR("[Vulkan]: Failed to create filter chain: \"%s\". Falling back to stock.\n", job->path);
+      vulkan_init_default_filter_chain(vk);
+
+      /* Undo what the caller did when the load was started,
+       * the same as a failed synchronous load. */
+      if (string_is_equal(settings->paths.path_shader, job->path))
+         strlcpy(settings->paths.path_shader, job->prev_path,
+               sizeof(settings->paths.path_shader));
+      configuration_set_bool(settings,
+            settings->bools.video_shader_enable, false);
+   }
+   else if (
+            job->info.swapchain.format      != vk->context->swapchain_format
+         || job->info.swapchain.render_pass != vk->render_pass
+         || job->info.swapchain.num_indices != vk->context->num_swapchain_images
+         || memcmp(&job->info.swapchain.viewport,
+            &vk->vk_vp, sizeof(vk->vk_vp)))
+      vulkan_update_filter_chain(vk);
+
+   vulkan_shader_job_free(vk, job);
+}
+#endif
+
 static bool vulkan_init_filter_chain(vk_t *vk)
 {
    const char     *shader_path = retroarch_get_shader_preset();
@@ -848,10 +1010,87 @@ static void vulkan_init_resources(vk_t *vk)
    vulkan_init_command_buffers(vk);
 }
 
+/* The pipeline cache is kept on disk across runs, one file
+ * per GPU and driver version. */
+static bool vulkan_pipeline_cache_path(vk_t *vk, char *s, size_t len)
+{
+   char name[64];
+   const VkPhysicalDeviceProperties *props = &vk->context->gpu_properties;
+
+   name[0] = '\0';
+
+   if (!path_get_cache_dir(s, "vulkan", len))
+      return false;
+
+   snprintf(name, sizeof(name), "pipeline_%04x_%04x_%08x.bin",
+         (unsigned)props->vendorID, (unsigned)props->deviceID,
+         (unsigned)props->driverVersion);
+   fill_pathname_join(s, s, name, len);
+   return true;
+}
+
+/* Not every driver validates the blob it is handed,
+ * so check the header against the device ourselves. */
+static bool vulkan_pipeline_cache_valid(vk_t *vk,
+      const uint8_t *data, int64_t size)
+{
+   uint32_t header[4];
+   const VkPhysicalDeviceProperties *props = &vk->context->gpu_properties;
+
+   if (size < (int64_t)(sizeof(header) + VK_UUID_SIZE))
+      return false;
+
+   memcpy(header, data, sizeof(header));
+
+   return header[0] >= sizeof(header) + VK_UUID_SIZE
+      && header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+      && header[2] == props->vendorID
+      && header[3] == props->deviceID
+      && !memcmp(data + sizeof(header),
+            props->pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+static void vulkan_save_pipeline_cache(vk_t *vk)
+{
+   char path[PATH_MAX_LENGTH];
+   size_t size = 0;
+   void *data  = NULL;
+
+   path[0] = '\0';
+
+   if (vk->pipelines.cache == VK_NULL_HANDLE
+         || !vulkan_pipeline_cache_path(vk, path, sizeof(path)))
+      return;
+
+   if (vkGetPipelineCacheData(vk->context->device,
+            vk->pipelines.cache, &size, NULL) != VK_SUCCESS || !size)
+      return;
+
+   data = malloc(size);
+   if (!data)
+      return;
+
+   if (vkGetPipelineCacheData(vk->context->device,
+            vk->pipelines.cache, &size, data) == VK_SUCCESS)
+   {
+      if (filestream_write_file(path, data, size))
+         RARCH_LOG("[Vulkan]: Saved %u byte pipeline cache.\n",
+               (unsigned)size);
+      else
+         RARCH_WARN("[Vulkan]: Failed to save pipeline cache to \"%s\".\n",
+               path);
+   }
+
+   free(data);
+}
+
 static void vulkan_init_static_resources(vk_t *vk)
 {
    unsigned i;
+   char cache_path[PATH_MAX_LENGTH];
    uint32_t blank[4 * 4];
+   void *cache_data                  = NULL;
+   int64_t cache_size                = 0;
    VkCommandPoolCreateInfo pool_info = {
       VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
@@ -863,8 +1102,36 @@ static void vulkan_init_static_resources(vk_t *vk)
    if (!vk->context)
       return;
 
-   vkCreatePipelineCache(vk->context->device,
-         &cache, NULL, &vk->pipelines.cache);
+   cache_path[0] = '\0';
+
+   if (     vulkan_pipeline_cache_path(vk, cache_path, sizeof(cache_path))
+         && path_is_valid(cache_path)
+         && filestream_read_file(cache_path, &cache_data, &cache_size))
+   {
+      if (vulkan_pipeline_cache_valid(vk,
+               (const uint8_t*)cache_data, cache_size))
+      {
+         cache.initialDataSize = (size_t)cache_size;
+         cache.pInitialData    = cache_data;
+         RARCH_LOG("[Vulkan]: Loaded %u byte pipeline cache.\n",
+               (unsigned)cache_size);
+      }
+      else
+         RARCH_WARN("[Vulkan]: Ignoring pipeline cache from another device or driver.\n");
+   }
+
+   if (vkCreatePipelineCache(vk->context->device,
+            &cache, NULL, &vk->pipelines.cache) != VK_SUCCESS
+         && cache.pInitialData)
+   {
+      /* Rejected by the driver, start over empty. */
+      cache.initialDataSize = 0;
+      cache.pInitialData    = NULL;
+      vkCreatePipelineCache(vk->context->device,
+            &cache, NULL, &vk->pipelines.cache);
+   }
+
+   free(cache_data);
 
    pool_info.queueFamilyIndex = vk->context->graphics_queue_index;
 
@@ -882,6 +1149,7 @@ static void vulkan_init_static_resources(vk_t *vk)
 static void vulkan_deinit_static_resources(vk_t *vk)
 {
    unsigned i;
+   vulkan_save_pipeline_cache(vk);
    vkDestroyPipelineCache(vk->context->device,
          vk->pipelines.cache, NULL);
    vulkan_destroy_texture(
@@ -933,6 +1201,8 @@ static void vulkan_free(void *data)
    if (vk->context && vk->context->device)
    {
 #ifdef HAVE_THREADS
+      vulkan_shader_job_cancel(vk);
+
       slock_lock(vk->context->queue_lock);
 #endif
       vkQueueWaitIdle(vk->context->queue);
@@ -1242,6 +1512,10 @@ static void vulkan_check_swapchain(vk_t *vk)
    if (vk->context->invalid_swapchain)
    {
 #ifdef HAVE_THREADS
+      /* A pending filter chain may still be building pipelines
+       * against the render pass about to be recreated. */
+      vulkan_shader_job_wait((struct vulkan_shader_job*)vk->shader_job);
+
       slock_lock(vk->context->queue_lock);
 #endif
       vkQueueWaitIdle(vk->context->queue);
@@ -1332,6 +1606,20 @@ static bool vulkan_set_shader(void *data,
       path = NULL;
    }
 
+#ifdef HAVE_THREADS
+   vulkan_shader_job_cancel(vk);
+
+   /* Keep the current chain on screen while the new one builds. */
+   if (path && vk->filter_chain)
+   {
+      settings_t *settings = config_get_ptr();
+
+      if (     settings->bools.video_shader_async_load
+            && vulkan_shader_job_begin(vk, path))
+         return true;
+   }
+#endif
+
    if (vk->filter_chain)
       vulkan_filter_chain_free((vulkan_filter_chain_t*)vk->filter_chain);
    vk->filter_chain = NULL;
@@ -1631,6 +1919,10 @@ static bool vulkan_frame(void *data, const void *frame,
    unsigned frame_index                          =
       vk->context->current_swapchain_index;
 
+#ifdef HAVE_THREADS
+   vulkan_shader_job_poll(vk);
+#endif
+
    /* Bookkeeping on start of frame. */
    chain     = &vk->swapchain[frame_index];
    vk->chain = chain;
@@ -2096,6 +2388,10 @@ static struct video_shader *vulkan_get_current_shader(void *data)
    vk_t *vk = (vk_t*)data;
    if (!vk || !vk->filter_chain)
       return NULL;
+#ifdef HAVE_THREADS
+   if (vk->shader_job)
+      return NULL;
+#endif
 
    return vulkan_filter_chain_get_preset((vulkan_filter_chain_t*)vk->filter_chain);
 }
@@ -108,56 +108,75 @@ static bool gl_raster_font_upload_atlas_components_4(gl_raster_t *font)
 }
 #endif
 
-static bool gl_raster_font_upload_atlas(gl_raster_t *font)
+static size_t gl_raster_font_get_format(gl_raster_t *font,
+      GLint *gl_internal, GLenum *gl_format)
 {
-   unsigned i, j;
-   GLint  gl_internal                   = GL_LUMINANCE_ALPHA;
-   GLenum gl_format                     = GL_LUMINANCE_ALPHA;
-   size_t ncomponents                   = 2;
-   uint8_t       *tmp                   = NULL;
 #if defined(GL_VERSION_3_0)
    struct retro_hw_render_callback *hwr = video_driver_get_hw_context();
 
-    if (font->gl->core_context_in_use ||
-        (hwr->context_type == RETRO_HW_CONTEXT_OPENGL &&
-         hwr->version_major >= 3))
+   if (font->gl->core_context_in_use ||
+         (hwr->context_type == RETRO_HW_CONTEXT_OPENGL &&
+          hwr->version_major >= 3))
    {
       GLint swizzle[] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
       glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
 
-      gl_internal = GL_R8;
-      gl_format   = GL_RED;
-      ncomponents = 1;
+      *gl_internal = GL_R8;
+      *gl_format   = GL_RED;
+      return 1;
    }
 #endif
 
-   tmp = (uint8_t*)calloc(font->tex_height, font->tex_width * ncomponents);
+   *gl_internal = GL_LUMINANCE_ALPHA;
+   *gl_format   = GL_LUMINANCE_ALPHA;
+   return 2;
+}
 
-   switch (ncomponents)
+static void gl_raster_font_copy_atlas(gl_raster_t *font, uint8_t *dst,
+      unsigned dst_pitch, size_t ncomponents,
+      unsigned x, unsigned y, unsigned width, unsigned height)
+{
+   unsigned i, j;
+
+   for (i = 0; i < height; ++i, dst += dst_pitch)
    {
-      case 1:
-         for (i = 0; i < font->atlas->height; ++i)
-         {
-            const uint8_t *src = &font->atlas->buffer[i * font->atlas->width];
-            uint8_t       *dst = &tmp[i * font->tex_width * ncomponents];
-
-            memcpy(dst, src, font->atlas->width);
-         }
-         break;
-      case 2:
-         for (i = 0; i < font->atlas->height; ++i)
-         {
-            const uint8_t *src = &font->atlas->buffer[i * font->atlas->width];
-            uint8_t       *dst = &tmp[i * font->tex_width * ncomponents];
+      const uint8_t *src = &font->atlas->buffer[
+         (y + i) * font->atlas->width + x];
 
-            for (j = 0; j < font->atlas->width; ++j)
+      switch (ncomponents)
+      {
+         case 1:
+            memcpy(dst, src, width);
+            break;
+         case 2:
             {
-               *dst++ = 0xff;
-               *dst++ = *src++;
+               uint8_t *out = dst;
+
+               for (j = 0; j < width; ++j)
+               {
+                  *out++ = 0xff;
+                  *out++ = *src++;
+               }
             }
-         }
-         break;
+            break;
+      }
    }
+}
+
+static bool gl_raster_font_upload_atlas(gl_raster_t *font)
+{
+   GLint  gl_internal;
+   GLenum gl_format;
+   size_t ncomponents = gl_raster_font_get_format(font,
+         &gl_internal, &gl_format);
+   uint8_t       *tmp = (uint8_t*)calloc(font->tex_height,
+         font->tex_width * ncomponents);
+
+   if (!tmp)
+      return false;
+
+   gl_raster_font_copy_atlas(font, tmp, font->tex_width * ncomponents,
+         ncomponents, 0, 0, font->atlas->width, font->atlas->height);
 
    glTexImage2D(GL_TEXTURE_2D, 0, gl_internal, font->tex_width, font->tex_height,
          0, gl_format, GL_UNSIGNED_BYTE, tmp);
@@ -167,6 +186,46 @@ static bool gl_raster_font_upload_atlas(gl_raster_t *font)
    return true;
 }
 
+/* Only re-uploads the part of the atlas the font renderer
+ * touched since the last upload, e.g. a newly cached glyph. */
+static void gl_raster_font_update_atlas(gl_raster_t *font)
+{
+   GLint  gl_internal;
+   GLenum gl_format;
+   size_t ncomponents;
+   unsigned x, y, width, height;
+   uint8_t *tmp = NULL;
+
+   font_atlas_get_dirty_rect(font->atlas, &x, &y, &width, &height);
+
+   if (x == 0 && y == 0
+         && width  == font->atlas->width
+         && height == font->atlas->height)
+   {
+      gl_raster_font_upload_atlas(font);
+      return;
+   }
+
+   ncomponents = gl_raster_font_get_format(font, &gl_internal, &gl_format);
+   tmp         = (uint8_t*)malloc(width * height * ncomponents);
+
+   if (!tmp)
+   {
+      gl_raster_font_upload_atlas(font);
+      return;
+   }
+
+   gl_raster_font_copy_atlas(font, tmp, width * ncomponents,
+         ncomponents, x, y, width, height);
+
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height,
+         gl_format, GL_UNSIGNED_BYTE, tmp);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+   free(tmp);
+}
+
 static void *gl_raster_font_init_font(void *data,
       const char *font_path, float font_size,
       bool is_threaded)
@@ -201,7 +260,7 @@ static void *gl_raster_font_init_font(void *data,
    if (!gl_raster_font_upload_atlas(font))
       goto error;
 
-   font->atlas->dirty = false;
+   font_atlas_clear_dirty(font->atlas);
 
    glBindTexture(GL_TEXTURE_2D, font->gl->texture[font->gl->tex_index]);
 
@@ -253,8 +312,8 @@ static void gl_raster_font_draw_vertices(gl_raster_t *font,
 
    if (font->atlas->dirty)
    {
-      gl_raster_font_upload_atlas(font);
-      font->atlas->dirty   = false;
+      gl_raster_font_update_atlas(font);
+      font_atlas_clear_dirty(font->atlas);
    }
 
    coords_data.handle_data = NULL;
@@ -266,6 +325,7 @@ static void gl_raster_font_draw_vertices(gl_raster_t *font,
          video_info->shader_data, &font->gl->mvp_no_rot);
 
    glDrawArrays(GL_TRIANGLES, 0, coords->vertices);
+   font_driver_count_draw_call();
 }
 
 static void gl_raster_font_render_line(
@@ -17,6 +17,7 @@
 
 #include <encodings/utf.h>
 #include <compat/strl.h>
+#include <retro_miscellaneous.h>
 
 #include "../common/vulkan_common.h"
 
@@ -31,10 +32,19 @@ typedef struct
    void *font_data;
    struct font_atlas *atlas;
    bool needs_update;
+   unsigned update_x, update_y;
+   unsigned update_width, update_height;
 
    struct vk_vertex *pv;
    struct vk_buffer_range range;
    unsigned vertices;
+
+   /* Quads of every message rendered while a block is bound,
+    * drawn with a single call in vulkan_raster_font_flush_block. */
+   video_font_raster_block_t *block;
+   struct vk_vertex *batch;
+   unsigned batch_vertices;
+   unsigned batch_capacity;
 } vulkan_raster_t;
 
 static void vulkan_raster_font_free_font(void *data, bool is_threaded);
@@ -81,7 +91,12 @@ static void *vulkan_raster_font_init_font(void *data,
          font->atlas->width, font->atlas->height, VK_FORMAT_R8_UNORM, NULL,
          NULL /*&swizzle*/, VULKAN_TEXTURE_DYNAMIC);
 
-   font->needs_update = true;
+   font->needs_update  = true;
+   font->update_x      = 0;
+   font->update_y      = 0;
+   font->update_width  = font->atlas->width;
+   font->update_height = font->atlas->height;
+   font_atlas_clear_dirty(font->atlas);
 
    return font;
 }
@@ -101,24 +116,46 @@ static void vulkan_raster_font_free_font(void *data, bool is_threaded)
    vulkan_destroy_texture(
          font->vk->context->device, &font->texture_optimal);
 
+   free(font->batch);
    free(font);
 }
 
-static INLINE void vulkan_raster_font_update_glyph(vulkan_raster_t *font, const struct font_glyph *glyph)
+static void vulkan_raster_font_update_atlas(vulkan_raster_t *font)
 {
-   if(font->atlas->dirty)
+   unsigned row, x, y, width, height;
+
+   if (!font->atlas->dirty)
+      return;
+
+   font_atlas_get_dirty_rect(font->atlas, &x, &y, &width, &height);
+
+   for (row = y; row < y + height; row++)
    {
-      unsigned row;
-      for (row = glyph->atlas_offset_y; row < (glyph->atlas_offset_y + glyph->height); row++)
-      {
-         uint8_t *src = font->atlas->buffer + row * font->atlas->width + glyph->atlas_offset_x;
-         uint8_t *dst = (uint8_t*)font->texture.mapped + row * font->texture.stride + glyph->atlas_offset_x;
-         memcpy(dst, src, glyph->width);
-      }
+      uint8_t *src = font->atlas->buffer + row * font->atlas->width + x;
+      uint8_t *dst = (uint8_t*)font->texture.mapped + row * font->texture.stride + x;
+      memcpy(dst, src, width);
+   }
 
-      font->atlas->dirty = false;
-      font->needs_update = true;
+   /* Accumulate until the next flush uploads the region. */
+   if (font->needs_update)
+   {
+      unsigned x1         = MAX(font->update_x + font->update_width,  x + width);
+      unsigned y1         = MAX(font->update_y + font->update_height, y + height);
+      font->update_x      = MIN(font->update_x, x);
+      font->update_y      = MIN(font->update_y, y);
+      font->update_width  = x1 - font->update_x;
+      font->update_height = y1 - font->update_y;
+   }
+   else
+   {
+      font->update_x      = x;
+      font->update_y      = y;
+      font->update_width  = width;
+      font->update_height = height;
    }
+
+   font_atlas_clear_dirty(font->atlas);
+   font->needs_update = true;
 }
 
 static int vulkan_get_message_width(void *data, const char *msg,
@@ -142,7 +179,7 @@ static int vulkan_get_message_width(void *data, const char *msg,
 
       if (glyph)
       {
-         vulkan_raster_font_update_glyph(font, glyph);
+         vulkan_raster_font_update_atlas(font);
          delta_x += glyph->advance_x;
       }
    }
@@ -194,7 +231,7 @@ static void vulkan_raster_font_render_line(
       if (!glyph)
          continue;
 
-      vulkan_raster_font_update_glyph(font, glyph);
+      vulkan_raster_font_update_atlas(font);
 
       off_x  = glyph->draw_offset_x;
       off_y  = glyph->draw_offset_y;
@@ -298,8 +335,10 @@ static void vulkan_raster_font_flush(vulkan_raster_t *font)
       begin_info.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
       vkBeginCommandBuffer(staging, &begin_info);
 
-      vulkan_copy_staging_to_dynamic(font->vk, staging,
-            &font->texture_optimal, &font->texture);
+      vulkan_copy_staging_to_dynamic_rect(font->vk, staging,
+            &font->texture_optimal, &font->texture,
+            font->update_x, font->update_y,
+            font->update_width, font->update_height);
 
       vkEndCommandBuffer(staging);
 
@@ -325,6 +364,29 @@ static void vulkan_raster_font_flush(vulkan_raster_t *font)
    }
 
    vulkan_draw_triangles(font->vk, &call);
+   font_driver_count_draw_call();
+}
+
+static bool vulkan_raster_font_reserve_batch(vulkan_raster_t *font,
+      unsigned vertices)
+{
+   struct vk_vertex *batch = NULL;
+   unsigned capacity       = font->batch_capacity ? font->batch_capacity : 1024;
+
+   if (font->batch_vertices + vertices <= font->batch_capacity)
+      return true;
+
+   while (capacity < font->batch_vertices + vertices)
+      capacity *= 2;
+
+   batch = (struct vk_vertex*)realloc(font->batch,
+         capacity * sizeof(*batch));
+   if (!batch)
+      return false;
+
+   font->batch          = batch;
+   font->batch_capacity = capacity;
+   return true;
 }
 
 static void vulkan_raster_font_render_msg(
@@ -393,12 +455,23 @@ static void vulkan_raster_font_render_msg(
    if (drop_x || drop_y)
       max_glyphs *= 2;
 
-   if (!vulkan_buffer_chain_alloc(font->vk->context, &font->vk->chain->vbo,
-         6 * sizeof(struct vk_vertex) * max_glyphs, &font->range))
-      return;
+   if (font->block)
+   {
+      if (!vulkan_raster_font_reserve_batch(font, 6 * max_glyphs))
+         return;
 
-   font->vertices   = 0;
-   font->pv         = (struct vk_vertex*)font->range.data;
+      font->vertices   = font->batch_vertices;
+      font->pv         = font->batch;
+   }
+   else
+   {
+      if (!vulkan_buffer_chain_alloc(font->vk->context, &font->vk->chain->vbo,
+            6 * sizeof(struct vk_vertex) * max_glyphs, &font->range))
+         return;
+
+      font->vertices   = 0;
+      font->pv         = (struct vk_vertex*)font->range.data;
+   }
 
    if (drop_x || drop_y)
    {
@@ -414,7 +487,11 @@ static void vulkan_raster_font_render_msg(
 
    vulkan_raster_font_render_message(font, msg, scale,
          color, x, y, text_align);
-   vulkan_raster_font_flush(font);
+
+   if (font->block)
+      font->batch_vertices = font->vertices;
+   else
+      vulkan_raster_font_flush(font);
 }
 
 static const struct font_glyph *vulkan_raster_font_get_glyph(
@@ -428,21 +505,55 @@ static const struct font_glyph *vulkan_raster_font_get_glyph(
    if (!font->font_driver->ident)
        return NULL;
 
-   glyph = font->font_driver->get_glyph((void*)font->font_driver, code);
+   glyph = font->font_driver->get_glyph(font->font_data, code);
 
    if(glyph)
-      vulkan_raster_font_update_glyph(font, glyph);
+      vulkan_raster_font_update_atlas(font);
 
    return glyph;
 }
 
+static void vulkan_raster_font_flush_block(unsigned width, unsigned height,
+      void *data, video_frame_info_t *video_info)
+{
+   vulkan_raster_t *font = (vulkan_raster_t*)data;
+
+   if (!font || !font->block || !font->batch_vertices)
+      return;
+
+   video_driver_set_viewport(width, height, font->block->fullscreen, false);
+
+   if (vulkan_buffer_chain_alloc(font->vk->context, &font->vk->chain->vbo,
+         font->batch_vertices * sizeof(struct vk_vertex), &font->range))
+   {
+      memcpy(font->range.data, font->batch,
+            font->batch_vertices * sizeof(struct vk_vertex));
+
+      font->vertices = font->batch_vertices;
+      vulkan_raster_font_flush(font);
+   }
+
+   font->batch_vertices = 0;
+}
+
+static void vulkan_raster_font_bind_block(void *data, void *userdata)
+{
+   vulkan_raster_t *font = (vulkan_raster_t*)data;
+
+   if (!font)
+      return;
+
+   font->block          = (video_font_raster_block_t*)userdata;
+   font->batch_vertices = 0;
+}
+
 font_renderer_t vulkan_raster_font = {
    vulkan_raster_font_init_font,
    vulkan_raster_font_free_font,
    vulkan_raster_font_render_msg,
    "Vulkan raster",
    vulkan_raster_font_get_glyph,
-   NULL,                            /* bind_block */
-   NULL,                            /* flush_block */
+   vulkan_raster_font_bind_block,
+   vulkan_raster_font_flush_block,
    vulkan_get_message_width
 };
@@ -15,10 +15,14 @@
  */
 
 #include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <file/file_path.h>
 #include <streams/file_stream.h>
 #include <retro_miscellaneous.h>
+#include <string/stdstring.h>
 
 #include "../font_driver.h"
 #include "../../verbosity.h"
@@ -34,30 +38,219 @@
 #undef static
 #endif
 
+/* Codepoints outside of 0-255 are rasterized on demand into
+ * a grid of cells below the pre-packed Latin-1 glyphs. */
+#define STB_FONT_CACHE_GLYPHS  256
+#define STB_FONT_CACHE_BUCKETS 64
+#define STB_FONT_ATLAS_MAX     2048
+
+typedef struct stb_font_file
+{
+   char *path;
+   uint8_t *data;
+   stbtt_fontinfo info;
+   unsigned refcount;
+   struct stb_font_file *next;
+} stb_font_file_t;
+
+typedef struct stb_font_slot
+{
+   struct font_glyph glyph;
+   uint32_t code;
+   unsigned last_used;
+   struct stb_font_slot *next;
+} stb_font_slot_t;
+
 typedef struct
 {
    int     line_height;
+   float   scale;
+   unsigned cell_width;
+   unsigned cell_height;
+   unsigned num_slots;
+   unsigned used_slots;
+   unsigned usage_counter;
+   stb_font_file_t *file;
    struct font_atlas atlas;
    struct font_glyph glyphs[256];
+   stb_font_slot_t slots[STB_FONT_CACHE_GLYPHS];
+   stb_font_slot_t *map[STB_FONT_CACHE_BUCKETS];
 } stb_font_renderer_t;
 
+/* Font files are shared between all sizes of the same font,
+ * since the glyph cache needs the file to stay resident.
+ * Fonts are only ever created and freed on the video thread. */
+static stb_font_file_t *stb_font_files = NULL;
+
+static stb_font_file_t *font_renderer_stb_file_acquire(const char *font_path)
+{
+   stb_font_file_t *file = NULL;
+
+   for (file = stb_font_files; file; file = file->next)
+   {
+      if (string_is_equal(file->path, font_path))
+      {
+         file->refcount++;
+         return file;
+      }
+   }
+
+   file = (stb_font_file_t*)calloc(1, sizeof(*file));
+   if (!file)
+      return NULL;
+
+   if (!filestream_read_file(font_path, (void**)&file->data, NULL))
+      goto error;
+
+   if (!stbtt_InitFont(&file->info, file->data,
+            stbtt_GetFontOffsetForIndex(file->data, 0)))
+      goto error;
+
+   file->path     = strdup(font_path);
+   file->refcount = 1;
+   file->next     = stb_font_files;
+   stb_font_files = file;
+
+   return file;
+
+error:
+   free(file->data);
+   free(file);
+   return NULL;
+}
+
+static void font_renderer_stb_file_release(stb_font_file_t *file)
+{
+   stb_font_file_t **ptr = &stb_font_files;
+
+   if (!file || --file->refcount)
+      return;
+
+   while (*ptr && *ptr != file)
+      ptr = &(*ptr)->next;
+   if (*ptr)
+      *ptr = file->next;
+
+   free(file->path);
+   free(file->data);
+   free(file);
+}
+
 static struct font_atlas *font_renderer_stb_get_atlas(void *data)
 {
    stb_font_renderer_t *self = (stb_font_renderer_t*)data;
    return &self->atlas;
 }
 
+static stb_font_slot_t *font_renderer_stb_get_slot(stb_font_renderer_t *self)
+{
+   unsigned i;
+   stb_font_slot_t **ptr = NULL;
+   stb_font_slot_t *slot = NULL;
+
+   if (self->used_slots < self->num_slots)
+      return &self->slots[self->used_slots++];
+
+   /* Evict the least recently used glyph. */
+   slot = &self->slots[0];
+   for (i = 1; i < self->num_slots; i++)
+      if ((self->usage_counter - self->slots[i].last_used) >
+            (self->usage_counter - slot->last_used))
+         slot = &self->slots[i];
+
+   ptr = &self->map[slot->code % STB_FONT_CACHE_BUCKETS];
+   while (*ptr && *ptr != slot)
+      ptr = &(*ptr)->next;
+   if (*ptr)
+      *ptr = slot->next;
+
+   return slot;
+}
+
+static const struct font_glyph *font_renderer_stb_cache_glyph(
+      stb_font_renderer_t *self, uint32_t code)
+{
+   unsigned row, width, height;
+   int x0, y0, x1, y1;
+   int advance_width     = 0;
+   int left_side_bearing = 0;
+   uint8_t *dst          = NULL;
+   stb_font_slot_t *slot = NULL;
+   stbtt_fontinfo *info  = &self->file->info;
+   int glyph_index       = stbtt_FindGlyphIndex(info, code);
+
+   if (!glyph_index || !self->num_slots)
+      return NULL;
+
+   slot = font_renderer_stb_get_slot(self);
+
+   stbtt_GetGlyphHMetrics(info, glyph_index,
+         &advance_width, &left_side_bearing);
+   stbtt_GetGlyphBitmapBox(info, glyph_index,
+         self->scale, self->scale, &x0, &y0, &x1, &y1);
+
+   width  = MIN((unsigned)MAX(x1 - x0, 0), self->cell_width);
+   height = MIN((unsigned)MAX(y1 - y0, 0), self->cell_height);
+
+   dst    = self->atlas.buffer + slot->glyph.atlas_offset_y
+      * self->atlas.width + slot->glyph.atlas_offset_x;
+
+   for (row = 0; row < self->cell_height; row++)
+      memset(dst + row * self->atlas.width, 0, self->cell_width);
+
+   if (width && height)
+      stbtt_MakeGlyphBitmap(info, dst, width, height,
+            self->atlas.width, self->scale, self->scale, glyph_index);
+
+   slot->glyph.width         = width;
+   slot->glyph.height        = height;
+   slot->glyph.advance_x     = advance_width * self->scale;
+   slot->glyph.advance_y     = 0;
+   slot->glyph.draw_offset_x = x0;
+   slot->glyph.draw_offset_y = y0;
+
+   slot->code                = code;
+   slot->last_used           = self->usage_counter++;
+   slot->next                = self->map[code % STB_FONT_CACHE_BUCKETS];
+   self->map[code % STB_FONT_CACHE_BUCKETS] = slot;
+
+   font_atlas_mark_dirty(&self->atlas,
+         slot->glyph.atlas_offset_x, slot->glyph.atlas_offset_y,
+         self->cell_width, self->cell_height);
+
+   return &slot->glyph;
+}
+
 static const struct font_glyph *font_renderer_stb_get_glyph(
       void *data, uint32_t code)
 {
+   stb_font_slot_t *slot     = NULL;
    stb_font_renderer_t *self = (stb_font_renderer_t*)data;
-   return code < 256 ? &self->glyphs[code] : NULL;
+
+   if (!self)
+      return NULL;
+
+   if (code < 256)
+      return &self->glyphs[code];
+
+   for (slot = self->map[code % STB_FONT_CACHE_BUCKETS];
+         slot; slot = slot->next)
+   {
+      if (slot->code == code)
+      {
+         slot->last_used = self->usage_counter++;
+         return &slot->glyph;
+      }
+   }
+
+   return font_renderer_stb_cache_glyph(self, code);
 }
 
 static void font_renderer_stb_free(void *data)
 {
    stb_font_renderer_t *self = (stb_font_renderer_t*)data;
 
+   font_renderer_stb_file_release(self->file);
    free(self->atlas.buffer);
    free(self);
 }
@@ -69,7 +262,7 @@ static bool font_renderer_stb_create_atlas(stb_font_renderer_t *self,
    stbtt_packedchar   chardata[256];
    stbtt_pack_context pc = {NULL};
 
-   if (width > 2048 || height > 2048)
+   if (width > STB_FONT_ATLAS_MAX || height > STB_FONT_ATLAS_MAX)
    {
       RARCH_WARN("[stb] Font atlas too big: %ux%u\n", width, height);
       goto error;
@@ -92,6 +285,7 @@ static bool font_renderer_stb_create_atlas(stb_font_renderer_t *self,
    stbtt_PackFontRange(&pc, font_data, 0, font_size, 0, 256, chardata);
    stbtt_PackEnd(&pc);
 
+   font_atlas_clear_dirty(&self->atlas);
    self->atlas.dirty = true;
 
    for (i = 0; i < 256; ++i)
@@ -114,10 +308,10 @@ static bool font_renderer_stb_create_atlas(stb_font_renderer_t *self,
          int new_height = height * 1.2;
 
          /* Limit growth to 2048x2048 unless we already reached that */
-         if (width < 2048 || height < 2048)
+         if (width < STB_FONT_ATLAS_MAX || height < STB_FONT_ATLAS_MAX)
          {
-            new_width  = MIN(new_width,  2048);
-            new_height = MIN(new_height, 2048);
+            new_width  = MIN(new_width,  STB_FONT_ATLAS_MAX);
+            new_height = MIN(new_height, STB_FONT_ATLAS_MAX);
          }
 
          return font_renderer_stb_create_atlas(self, font_data, font_size,
@@ -138,11 +332,70 @@ error:
    return false;
 }
 
+/* Trims the packed Latin-1 area and appends the glyph cache
+ * cells below it. The cache is simply left out if it doesn't fit. */
+static void font_renderer_stb_create_cache(stb_font_renderer_t *self)
+{
+   unsigned i, cols, rows, cell_max;
+   int x0, y0, x1, y1;
+   uint8_t *buffer        = NULL;
+   unsigned packed_height = 0;
+
+   for (i = 0; i < 256; i++)
+   {
+      const struct font_glyph *g = &self->glyphs[i];
+      if (g->height)
+         packed_height = MAX(packed_height,
+               (unsigned)(g->atlas_offset_y + g->height + 1));
+   }
+
+   stbtt_GetFontBoundingBox(&self->file->info, &x0, &y0, &x1, &y1);
+
+   /* The font bounding box covers the widest glyph of the whole
+    * font, so cap cells a bit above the line height instead and
+    * let the odd oversized glyph get clipped. */
+   cell_max          = self->line_height + self->line_height / 4 + 1;
+   self->cell_width  = MIN((unsigned)ceilf((x1 - x0) * self->scale) + 1, cell_max);
+   self->cell_height = MIN((unsigned)ceilf((y1 - y0) * self->scale) + 1, cell_max);
+   self->cell_width  = MIN(self->cell_width, self->atlas.width);
+
+   if (!self->cell_width || !self->cell_height)
+      return;
+
+   cols              = self->atlas.width / self->cell_width;
+   rows              = (STB_FONT_CACHE_GLYPHS + cols - 1) / cols;
+
+   while (rows && packed_height + rows * self->cell_height
+         > STB_FONT_ATLAS_MAX)
+      rows--;
+
+   if (!rows || packed_height >= self->atlas.height)
+      return;
+
+   buffer = (uint8_t*)realloc(self->atlas.buffer,
+         self->atlas.width * (packed_height + rows * self->cell_height));
+   if (!buffer)
+      return;
+
+   self->atlas.buffer = buffer;
+   self->atlas.height = packed_height + rows * self->cell_height;
+   memset(buffer + packed_height * self->atlas.width, 0,
+         rows * self->cell_height * self->atlas.width);
+
+   self->num_slots    = MIN(rows * cols, STB_FONT_CACHE_GLYPHS);
+
+   for (i = 0; i < self->num_slots; i++)
+   {
+      stb_font_slot_t *slot      = &self->slots[i];
+      slot->glyph.atlas_offset_x = (i % cols) * self->cell_width;
+      slot->glyph.atlas_offset_y = packed_height
+         + (i / cols) * self->cell_height;
+   }
+}
+
 static void *font_renderer_stb_init(const char *font_path, float font_size)
 {
    int ascent, descent, line_gap;
-   stbtt_fontinfo info;
-   uint8_t *font_data = NULL;
    stb_font_renderer_t *self = (stb_font_renderer_t*) calloc(1, sizeof(*self));
 
    /* See https://github.com/nothings/stb/blob/master/stb_truetype.h#L539 */
@@ -151,31 +404,29 @@ static void *font_renderer_stb_init(const char *font_path, float font_size)
    if (!self)
       goto error;
 
-   if (!filestream_read_file(font_path, (void**)&font_data, NULL))
+   self->file = font_renderer_stb_file_acquire(font_path);
+   if (!self->file)
       goto error;
 
-   if (!font_renderer_stb_create_atlas(self, font_data, font_size, 512, 512))
+   if (!font_renderer_stb_create_atlas(self, self->file->data,
+            font_size, 512, 512))
       goto error;
 
-   if (!stbtt_InitFont(&info, font_data, stbtt_GetFontOffsetForIndex(font_data, 0)))
-      goto error;
-
-   stbtt_GetFontVMetrics(&info, &ascent, &descent, &line_gap);
-   self->line_height  = ascent - descent;
+   stbtt_GetFontVMetrics(&self->file->info, &ascent, &descent, &line_gap);
 
    if (font_size < 0)
-      self->line_height *= stbtt_ScaleForMappingEmToPixels(&info, -font_size);
+      self->scale = stbtt_ScaleForMappingEmToPixels(
+            &self->file->info, -font_size);
    else
-      self->line_height *= stbtt_ScaleForPixelHeight(&info, font_size);
+      self->scale = stbtt_ScaleForPixelHeight(&self->file->info, font_size);
 
-   free(font_data);
+   self->line_height  = (ascent - descent) * self->scale;
+
+   font_renderer_stb_create_cache(self);
 
    return self;
 
 error:
-   if (font_data)
-      free(font_data);
-
    if (self)
       font_renderer_stb_free(self);
    return NULL;
@@ -24,6 +24,11 @@
 #include <streams/file_stream.h>
 #include <lists/string_list.h>
 #include <string/stdstring.h>
+#include <rhash.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -32,7 +37,9 @@
 #include "glslang_util.h"
 #if defined(HAVE_GLSLANG)
 #include <glslang.hpp>
+#include <glslang/Include/revision.h>
 #endif
+#include "../../paths.h"
 #include "../../verbosity.h"
 
 using namespace std;
@@ -369,12 +376,205 @@ bool glslang_parse_meta(const vector<string> &lines, glslang_meta *meta)
 }
 
 
+#ifdef HAVE_THREADS
+struct glslang_parallel_state
+{
+   const std::function<void(unsigned)> *job;
+   slock_t *lock;
+   unsigned next;
+   unsigned count;
+};
+
+static void glslang_parallel_worker(void *data)
+{
+   glslang_parallel_state *state = (glslang_parallel_state*)data;
+
+   for (;;)
+   {
+      unsigned i;
+
+      slock_lock(state->lock);
+      i = state->next++;
+      slock_unlock(state->lock);
+
+      if (i >= state->count)
+         break;
+
+      (*state->job)(i);
+   }
+}
+#endif
+
+void glslang_parallel_for(unsigned count,
+      const std::function<void(unsigned)> &job)
+{
+   unsigned i;
+#ifdef HAVE_THREADS
+   glslang_parallel_state state;
+   vector<sthread_t*> threads;
+   unsigned num_threads = MIN(count, cpu_features_get_core_amount());
+
+   state.job   = &job;
+   state.lock  = num_threads > 1 ? slock_new() : NULL;
+   state.next  = 0;
+   state.count = count;
+
+   /* The calling thread takes jobs as well. */
+   if (state.lock)
+   {
+      for (i = 1; i < num_threads; i++)
+      {
+         sthread_t *thread = sthread_create(glslang_parallel_worker, &state);
+         if (thread)
+            threads.push_back(thread);
+      }
+   }
+
+   glslang_parallel_worker(&state);
+
+   for (i = 0; i < threads.size(); i++)
+      sthread_join(threads[i]);
+
+   if (state.lock)
+      slock_free(state.lock);
+#else
+   for (i = 0; i < count; i++)
+      job(i);
+#endif
+}
+
 #if defined(HAVE_GLSLANG)
+/* SPIR-V cache.
+ *
+ * Compiled stages are stored under the cache directory, named
+ * after a hash of both preprocessed stage sources and the
+ * compiler revision, so edited shaders (or their includes)
+ * and compiler updates simply miss. Reflection is not cached,
+ * it depends on the semantic aliases of the preset the pass
+ * is loaded into and is cheap compared to glslang itself. */
+#define GLSLANG_CACHE_MAGIC   0x56505352 /* "RSPV" */
+#define GLSLANG_CACHE_VERSION 1
+
+struct glslang_cache_header
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t vertex_size;
+   uint32_t fragment_size;
+};
+
+static bool glslang_cache_path(char *s, size_t len,
+      const string &vertex, const string &fragment)
+{
+   char hash[65];
+   char dir[PATH_MAX_LENGTH];
+   string key = vertex;
+
+   dir[0] = hash[0] = '\0';
+
+   if (!path_get_cache_dir(s, "slang", len))
+      return false;
+
+   key += '\0';
+   key += fragment;
+   key += '\0';
+   key += std::to_string(GLSLANG_PATCH_LEVEL);
+   key += '\0';
+   key += std::to_string(GLSLANG_CACHE_VERSION);
+
+   sha256_hash(hash, (const uint8_t*)key.data(), key.size());
+
+   fill_pathname_join(dir, s, hash, sizeof(dir));
+   strlcpy(s, dir, len);
+   strlcat(s, ".spv", len);
+   return true;
+}
+
+static bool glslang_cache_load(const char *path, glslang_output *output)
+{
+   glslang_cache_header header;
+   void *buf   = NULL;
+   int64_t len = 0;
+   bool ret    = false;
+
+   if (!path_is_valid(path) || !filestream_read_file(path, &buf, &len))
+      return false;
+
+   if (len < (int64_t)sizeof(header))
+      goto end;
+
+   memcpy(&header, buf, sizeof(header));
+
+   if (     header.magic   != GLSLANG_CACHE_MAGIC
+         || header.version != GLSLANG_CACHE_VERSION
+         || len != (int64_t)(sizeof(header) + (uint64_t)(
+               header.vertex_size + header.fragment_size) * sizeof(uint32_t)))
+      goto end;
+
+   {
+      const uint32_t *words = (const uint32_t*)
+         ((const uint8_t*)buf + sizeof(header));
+      output->vertex.assign(words, words + header.vertex_size);
+      words += header.vertex_size;
+      output->fragment.assign(words, words + header.fragment_size);
+   }
+
+   ret = true;
+
+end:
+   free(buf);
+   return ret;
+}
+
+static void glslang_cache_store(const char *path, const glslang_output *output)
+{
+   char tmp_path[PATH_MAX_LENGTH];
+   glslang_cache_header header;
+   vector<uint8_t> blob;
+
+   header.magic         = GLSLANG_CACHE_MAGIC;
+   header.version       = GLSLANG_CACHE_VERSION;
+   header.vertex_size   = (uint32_t)output->vertex.size();
+   header.fragment_size = (uint32_t)output->fragment.size();
+
+   blob.resize(sizeof(header) +
+         (output->vertex.size() + output->fragment.size()) * sizeof(uint32_t));
+   memcpy(blob.data(), &header, sizeof(header));
+   memcpy(blob.data() + sizeof(header), output->vertex.data(),
+         output->vertex.size() * sizeof(uint32_t));
+   memcpy(blob.data() + sizeof(header)
+         + output->vertex.size() * sizeof(uint32_t),
+         output->fragment.data(),
+         output->fragment.size() * sizeof(uint32_t));
+
+   /* Passes compile in parallel and other instances share the
+    * cache, so never expose a partly written file: write a
+    * temporary next to it and rename it over the target. If the
+    * rename fails, someone else stored the same blob already. */
+   snprintf(tmp_path, sizeof(tmp_path), "%s.%llx-%llx.tmp", path,
+         (unsigned long long)cpu_features_get_time_usec(),
+         (unsigned long long)(uintptr_t)&header);
+
+   if (!filestream_write_file(tmp_path, blob.data(), blob.size()))
+   {
+      RARCH_WARN("[slang]: Failed to write SPIR-V cache \"%s\".\n", path);
+      filestream_delete(tmp_path);
+      return;
+   }
+
+   if (filestream_rename(tmp_path, path) != 0)
+      filestream_delete(tmp_path);
+}
+
 bool glslang_compile_shader(const char *shader_path, glslang_output *output)
 {
+   char cache_path[PATH_MAX_LENGTH];
    vector<string> lines;
+   string vertex_source;
+   string fragment_source;
+   bool use_cache = false;
 
-   RARCH_LOG("[slang]: Compiling shader \"%s\".\n", shader_path);
+   cache_path[0] = '\0';
 
    if (!glslang_read_shader_file(shader_path, &lines, true))
       return false;
@@ -382,20 +582,37 @@ bool glslang_compile_shader(const char *shader_path, glslang_output *output)
    if (!glslang_parse_meta(lines, &output->meta))
       return false;
 
-   if (    !glslang::compile_spirv(build_stage_source(lines, "vertex"),
+   vertex_source   = build_stage_source(lines, "vertex");
+   fragment_source = build_stage_source(lines, "fragment");
+
+   use_cache = glslang_cache_path(cache_path, sizeof(cache_path),
+         vertex_source, fragment_source);
+
+   if (use_cache && glslang_cache_load(cache_path, output))
+   {
+      RARCH_LOG("[slang]: Loaded cached shader \"%s\".\n", shader_path);
+      return true;
+   }
+
+   RARCH_LOG("[slang]: Compiling shader \"%s\".\n", shader_path);
+
+   if (    !glslang::compile_spirv(vertex_source,
             glslang::StageVertex, &output->vertex))
    {
       RARCH_ERR("Failed to compile vertex shader stage.\n");
       return false;
    }
 
-   if (    !glslang::compile_spirv(build_stage_source(lines, "fragment"),
+   if (    !glslang::compile_spirv(fragment_source,
             glslang::StageFragment, &output->fragment))
    {
       RARCH_ERR("Failed to compile fragment shader stage.\n");
       return false;
    }
 
+   if (use_cache)
+      glslang_cache_store(cache_path, output);
+
    return true;
 }
 #else
@@ -71,6 +71,7 @@ const char *glslang_format_to_string(glslang_format fmt);
 RETRO_END_DECLS
 
 #ifdef __cplusplus
+#include <functional>
 #include <vector>
 #include <string>
 
@@ -105,6 +106,11 @@ struct glslang_output
 
 bool glslang_compile_shader(const char *shader_path, glslang_output *output);
 
+/* Runs job(0) .. job(count - 1) concurrently, one worker
+ * thread per core, and returns once all of them are done. */
+void glslang_parallel_for(unsigned count,
+      const std::function<void(unsigned)> &job);
+
 /* Helpers for internal use. */
 bool glslang_read_shader_file(const char *path, std::vector<std::string> *output, bool root_file);
 bool glslang_parse_meta(const std::vector<std::string> &lines, glslang_meta *meta);
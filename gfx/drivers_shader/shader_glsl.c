@@ -21,6 +21,7 @@
 #include <compat/posix_string.h>
 #include <file/file_path.h>
 #include <retro_assert.h>
+#include <rhash.h>
 #include <streams/file_stream.h>
 #include <string/stdstring.h>
 
@@ -36,6 +37,11 @@
 #include "shader_glsl.h"
 #include "../../managers/state_manager.h"
 #include "../../core.h"
+#include "../../paths.h"
+
+#if !defined(HAVE_OPENGLES) || defined(HAVE_OPENGLES3)
+#define GLSL_PROGRAM_BINARY
+#endif
 
 #define PREV_TEXTURES (GFX_MAX_TEXTURES - 1)
 
@@ -153,6 +159,7 @@ typedef struct glsl_shader_data
    struct shader_program_glsl_data prg[GFX_MAX_SHADERS];
    struct video_shader *shader;
    state_tracker_t *state_tracker;
+   bool program_binary;
 } glsl_shader_data_t;
 
 static bool glsl_core;
@@ -402,6 +409,135 @@ static bool gl_glsl_link_program(GLuint prog)
 }
 
 
+#ifdef GLSL_PROGRAM_BINARY
+/* Program binary cache.
+ *
+ * Linked programs are stored under the cache directory, named
+ * after a hash of their sources and of the GL vendor, renderer
+ * and version strings, so edited shaders and driver updates
+ * simply miss. A driver may still reject a binary, in which case
+ * the program is compiled from source and the entry rewritten. */
+#define GLSL_CACHE_MAGIC   0x42534c47 /* "GLSB" */
+#define GLSL_CACHE_VERSION 1
+
+struct glsl_cache_header
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t format;
+   uint32_t size;
+};
+
+static bool gl_glsl_cache_path(glsl_shader_data_t *glsl,
+      char *s, size_t len,
+      const struct shader_program_info *program_info)
+{
+   unsigned i;
+   char hash[65];
+   char name[80];
+   char profile[64];
+   char dir[PATH_MAX_LENGTH];
+   const char *parts[7];
+   size_t size = 0;
+   char *key   = NULL;
+
+   if (!path_get_cache_dir(dir, "glsl", sizeof(dir)))
+      return false;
+
+   snprintf(profile, sizeof(profile), "%u %u.%u %s",
+         GLSL_CACHE_VERSION, glsl_major, glsl_minor,
+         glsl_core ? "core" : "compat");
+
+   parts[0] = (const char*)glGetString(GL_VENDOR);
+   parts[1] = (const char*)glGetString(GL_RENDERER);
+   parts[2] = (const char*)glGetString(GL_VERSION);
+   parts[3] = profile;
+   parts[4] = glsl->alias_define;
+   parts[5] = program_info->vertex;
+   parts[6] = program_info->fragment;
+
+   for (i = 0; i < ARRAY_SIZE(parts); i++)
+      size += (parts[i] ? strlen(parts[i]) : 0) + 1;
+
+   key = (char*)malloc(size);
+   if (!key)
+      return false;
+
+   size = 0;
+   for (i = 0; i < ARRAY_SIZE(parts); i++)
+   {
+      size_t part_len = parts[i] ? strlen(parts[i]) : 0;
+      memcpy(key + size, parts[i], part_len);
+      size          += part_len;
+      key[size++]    = '\0';
+   }
+
+   sha256_hash(hash, (const uint8_t*)key, size);
+   free(key);
+
+   snprintf(name, sizeof(name), "%s.bin", hash);
+   fill_pathname_join(s, dir, name, len);
+   return true;
+}
+
+static bool gl_glsl_cache_load(const char *path, GLuint prog)
+{
+   struct glsl_cache_header header;
+   GLint status = GL_FALSE;
+   void *buf    = NULL;
+   int64_t len  = 0;
+
+   if (!path_is_valid(path) || !filestream_read_file(path, &buf, &len))
+      return false;
+
+   if (len >= (int64_t)sizeof(header))
+   {
+      memcpy(&header, buf, sizeof(header));
+
+      if (     header.magic   == GLSL_CACHE_MAGIC
+            && header.version == GLSL_CACHE_VERSION
+            && len == (int64_t)(sizeof(header) + header.size))
+      {
+         glProgramBinary(prog, header.format,
+               (const uint8_t*)buf + sizeof(header), header.size);
+         glGetProgramiv(prog, GL_LINK_STATUS, &status);
+      }
+   }
+
+   free(buf);
+   return status == GL_TRUE;
+}
+
+static void gl_glsl_cache_store(const char *path, GLuint prog)
+{
+   struct glsl_cache_header header;
+   GLenum format = 0;
+   GLint size    = 0;
+   uint8_t *blob = NULL;
+
+   glGetProgramiv(prog, GL_PROGRAM_BINARY_LENGTH, &size);
+   if (size <= 0)
+      return;
+
+   blob = (uint8_t*)malloc(sizeof(header) + size);
+   if (!blob)
+      return;
+
+   glGetProgramBinary(prog, size, &size, &format, blob + sizeof(header));
+
+   header.magic   = GLSL_CACHE_MAGIC;
+   header.version = GLSL_CACHE_VERSION;
+   header.format  = format;
+   header.size    = size;
+   memcpy(blob, &header, sizeof(header));
+
+   if (size <= 0 || !filestream_write_file(path, blob, sizeof(header) + size))
+      RARCH_WARN("[GLSL]: Failed to write program cache \"%s\".\n", path);
+
+   free(blob);
+}
+#endif
+
 static bool gl_glsl_compile_program(
       void *data,
       unsigned idx,
@@ -411,6 +547,11 @@ static bool gl_glsl_compile_program(
    glsl_shader_data_t *glsl = (glsl_shader_data_t*)data;
    struct shader_program_glsl_data *program = (struct shader_program_glsl_data*)program_data;
    GLuint prog = glCreateProgram();
+   bool use_cache = false;
+   bool cached    = false;
+   char cache_path[PATH_MAX_LENGTH];
+
+   cache_path[0] = '\0';
 
    if (!program)
       program = &glsl->prg[idx];
@@ -418,7 +559,33 @@ static bool gl_glsl_compile_program(
    if (!prog)
       goto error;
 
-   if (program_info->vertex)
+#ifdef GLSL_PROGRAM_BINARY
+   if (glsl->program_binary && (program_info->vertex || program_info->fragment))
+   {
+      use_cache = gl_glsl_cache_path(glsl,
+            cache_path, sizeof(cache_path), program_info);
+
+      if (use_cache)
+      {
+         cached = gl_glsl_cache_load(cache_path, prog);
+
+         if (cached)
+            RARCH_LOG("[GLSL]: Loaded program #%u from cache.\n", idx);
+         else
+         {
+            /* Don't build on top of a rejected binary. */
+            glDeleteProgram(prog);
+            prog = glCreateProgram();
+            if (!prog)
+               goto error;
+            glProgramParameteri(prog,
+                  GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+         }
+      }
+   }
+#endif
+
+   if (program_info->vertex && !cached)
    {
       RARCH_LOG("[GLSL]: Found GLSL vertex shader.\n");
       program->vprg = glCreateShader(GL_VERTEX_SHADER);
@@ -435,7 +602,7 @@ static bool gl_glsl_compile_program(
       glAttachShader(prog, program->vprg);
    }
 
-   if (program_info->fragment)
+   if (program_info->fragment && !cached)
    {
       RARCH_LOG("[GLSL]: Found GLSL fragment shader.\n");
       program->fprg = glCreateShader(GL_FRAGMENT_SHADER);
@@ -449,7 +616,7 @@ static bool gl_glsl_compile_program(
       glAttachShader(prog, program->fprg);
    }
 
-   if (program_info->vertex || program_info->fragment)
+   if ((program_info->vertex || program_info->fragment) && !cached)
    {
       RARCH_LOG("[GLSL]: Linking GLSL program.\n");
       if (!gl_glsl_link_program(prog))
@@ -465,6 +632,14 @@ static bool gl_glsl_compile_program(
       program->vprg = 0;
       program->fprg = 0;
 
+#ifdef GLSL_PROGRAM_BINARY
+      if (use_cache)
+         gl_glsl_cache_store(cache_path, prog);
+#endif
+   }
+
+   if (program_info->vertex || program_info->fragment)
+   {
       glUseProgram(prog);
       glUniform1i(gl_glsl_get_uniform(glsl, prog, "Texture"), 0);
       glUseProgram(0);
@@ -952,6 +1127,17 @@ static void *gl_glsl_init(void *data, const char *path)
    }
 #endif
 
+#ifdef GLSL_PROGRAM_BINARY
+   if (gl_check_capability(GL_CAPS_PROGRAM_BINARY))
+   {
+      /* Some drivers expose the entry points without
+       * supporting a single binary format. */
+      GLint formats = 0;
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+      glsl->program_binary = formats > 0;
+   }
+#endif
+
    glsl->shader = (struct video_shader*)calloc(1, sizeof(*glsl->shader));
    if (!glsl->shader)
       goto error;
@@ -522,6 +522,7 @@ struct vulkan_filter_chain
       VkPhysicalDevice gpu;
       const VkPhysicalDeviceMemoryProperties &memory_properties;
       VkPipelineCache cache;
+      slock_t *queue_lock;
       vector<unique_ptr<Pass>> passes;
       vector<vulkan_filter_chain_pass_info> pass_info;
       vector<vector<function<void ()>>> deferred_calls;
@@ -559,6 +560,7 @@ vulkan_filter_chain::vulkan_filter_chain(
      gpu(info.gpu),
      memory_properties(*info.memory_properties),
      cache(info.pipeline_cache),
+     queue_lock(info.queue_lock),
      common(info.device, *info.memory_properties),
      original_format(info.original_format)
 {
@@ -684,7 +686,13 @@ void vulkan_filter_chain::execute_deferred()
 
 void vulkan_filter_chain::flush()
 {
+#ifdef HAVE_THREADS
+   slock_lock(queue_lock);
+#endif
    vkDeviceWaitIdle(device);
+#ifdef HAVE_THREADS
+   slock_unlock(queue_lock);
+#endif
    execute_deferred();
 }
 
@@ -2780,8 +2788,14 @@ static bool vulkan_filter_chain_load_luts(
    vkEndCommandBuffer(cmd);
    submit_info.commandBufferCount = 1;
    submit_info.pCommandBuffers    = &cmd;
+#ifdef HAVE_THREADS
+   slock_lock(info->queue_lock);
+#endif
    vkQueueSubmit(info->queue, 1, &submit_info, VK_NULL_HANDLE);
    vkQueueWaitIdle(info->queue);
+#ifdef HAVE_THREADS
+   slock_unlock(info->queue_lock);
+#endif
    vkFreeCommandBuffers(info->device, info->command_pool, 1, &cmd);
    chain->release_staging_buffers();
    return true;
@@ -2825,9 +2839,19 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
 
    shader->num_parameters = 0;
 
+   /* Compile every pass up front on worker threads, only
+    * the Vulkan object creation below has to be serial. */
+   vector<glslang_output> outputs(shader->passes);
+   vector<uint8_t> compiled(shader->passes);
+
+   glslang_parallel_for(shader->passes, [&](unsigned j) {
+         compiled[j] = glslang_compile_shader(
+               shader->pass[j].source.path, &outputs[j]);
+      });
+
    for (i = 0; i < shader->passes; i++)
    {
-      glslang_output output;
+      glslang_output &output = outputs[i];
       struct vulkan_filter_chain_pass_info pass_info;
       const video_shader_pass *pass      = &shader->pass[i];
       const video_shader_pass *next_pass =
@@ -2843,7 +2867,7 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
       pass_info.address       = VULKAN_FILTER_CHAIN_ADDRESS_REPEAT;
       pass_info.max_levels    = 0;
 
-      if (!glslang_compile_shader(pass->source.path, &output))
+      if (!compiled[i])
       {
          RARCH_ERR("Failed to compile shader: \"%s\".\n",
                pass->source.path);
@@ -99,6 +99,8 @@ struct vulkan_filter_chain_create_info
    const VkPhysicalDeviceMemoryProperties *memory_properties;
    VkPipelineCache pipeline_cache;
    VkQueue queue;
+   /* Taken around queue access, may be NULL. */
+   slock_t *queue_lock;
    VkCommandPool command_pool;
    unsigned num_passes;
 
@@ -1,6 +1,7 @@
 ﻿
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <spirv_glsl.hpp>
 #include <spirv_hlsl.hpp>
 #include <spirv_msl.hpp>
@@ -342,71 +343,71 @@ static bool slang_process_reflection(
    return true;
 }
 
-bool slang_process(
-      video_shader*          shader_info,
-      unsigned               pass_number,
+/* Everything slang_process needs from a pass that does not
+ * depend on the passes before it: the SPIR-V and its translation
+ * to the target shading language. */
+struct slang_pass_compile
+{
+   string               path;
+   glslang_output       output;
+   unique_ptr<Compiler> vs_compiler;
+   unique_ptr<Compiler> ps_compiler;
+   ShaderResources      vs_resources;
+   ShaderResources      ps_resources;
+   string               vs_code;
+   string               ps_code;
+   bool                 ok = false;
+};
+
+struct slang_compiled_passes
+{
+   vector<slang_pass_compile> passes;
+   enum rarch_shader_type     type;
+   unsigned                   version;
+};
+
+static bool slang_compile_pass(
+      slang_pass_compile*    pass,
+      const video_shader*    shader_info,
       enum rarch_shader_type dst_type,
-      unsigned               version,
-      const semantics_map_t* semantics_map,
-      pass_semantics_t*      out)
+      unsigned               version)
 {
-   glslang_output     output;
-   Compiler*          vs_compiler = NULL;
-   Compiler*          ps_compiler = NULL;
-   video_shader_pass& pass        = shader_info->pass[pass_number];
-
-   if (!glslang_compile_shader(pass.source.path, &output))
+   if (!glslang_compile_shader(pass->path.c_str(), &pass->output))
       return false;
 
-   if (!slang_preprocess_parse_parameters(output.meta, shader_info))
-      return false;
-
-   if (!*pass.alias && !output.meta.name.empty())
-      strlcpy(pass.alias, output.meta.name.c_str(), sizeof(pass.alias) - 1);
-
-   out->format = output.meta.rt_format;
-
-   if (out->format == SLANG_FORMAT_UNKNOWN)
-   {
-      if (pass.fbo.srgb_fbo)
-         out->format = SLANG_FORMAT_R8G8B8A8_SRGB;
-      else if (pass.fbo.fp_fbo)
-         out->format = SLANG_FORMAT_R16G16B16A16_SFLOAT;
-      else
-         out->format = SLANG_FORMAT_R8G8B8A8_UNORM;
-   }
-
-   pass.source.string.vertex   = NULL;
-   pass.source.string.fragment = NULL;
-
    try
    {
-      ShaderResources vs_resources;
-      ShaderResources ps_resources;
-      string          vs_code;
-      string          ps_code;
+      glslang_output& output = pass->output;
 
       switch (dst_type)
       {
          case RARCH_SHADER_HLSL:
          case RARCH_SHADER_CG:
 #ifdef ENABLE_HLSL
-            vs_compiler = new CompilerHLSL(output.vertex);
-            ps_compiler = new CompilerHLSL(output.fragment);
+            pass->vs_compiler.reset(new CompilerHLSL(output.vertex));
+            pass->ps_compiler.reset(new CompilerHLSL(output.fragment));
 #endif
             break;
 
          case RARCH_SHADER_METAL:
-            vs_compiler = new CompilerMSL(output.vertex);
-            ps_compiler = new CompilerMSL(output.fragment);
+            pass->vs_compiler.reset(new CompilerMSL(output.vertex));
+            pass->ps_compiler.reset(new CompilerMSL(output.fragment));
             break;
 
          default:
-            vs_compiler = new CompilerGLSL(output.vertex);
-            ps_compiler = new CompilerGLSL(output.fragment);
+            pass->vs_compiler.reset(new CompilerGLSL(output.vertex));
+            pass->ps_compiler.reset(new CompilerGLSL(output.fragment));
             break;
       }
 
+      if (!pass->vs_compiler || !pass->ps_compiler)
+         return false;
+
+      Compiler*        vs_compiler  = pass->vs_compiler.get();
+      Compiler*        ps_compiler  = pass->ps_compiler.get();
+      ShaderResources& vs_resources = pass->vs_resources;
+      ShaderResources& ps_resources = pass->ps_resources;
+
       vs_resources = vs_compiler->get_shader_resources();
       ps_resources = ps_compiler->get_shader_resources();
 
@@ -460,8 +461,8 @@ bool slang_process(
             }
          }
 
-         vs_code = vs->compile();
-         ps_code = ps->compile(ps_attrib_remap);
+         pass->vs_code = vs->compile();
+         pass->ps_code = ps->compile(ps_attrib_remap);
       }
       else
 #endif
@@ -482,8 +483,8 @@ bool slang_process(
             std::string name = vs->get_name(resource.id);
          }
 
-         vs_code = vs->compile();
-         ps_code = ps->compile();
+         pass->vs_code = vs->compile();
+         pass->ps_code = ps->compile();
       }
       else if (shader_info->type == RARCH_SHADER_GLSL)
       {
@@ -494,21 +495,108 @@ bool slang_process(
          ps->set_common_options(options);
          vs->set_common_options(options);
 
-         vs_code = vs->compile();
-         ps_code = ps->compile();
+         pass->vs_code = vs->compile();
+         pass->ps_code = ps->compile();
       }
       else
-         goto error;
+         return false;
+   }
+   catch (const std::exception& e)
+   {
+      RARCH_ERR("[slang]: SPIRV-Cross threw exception: %s.\n", e.what());
+      return false;
+   }
 
-      pass.source.string.vertex   = strdup(vs_code.c_str());
-      pass.source.string.fragment = strdup(ps_code.c_str());
+   return true;
+}
 
+slang_compiled_passes_t* slang_compile_passes(
+      video_shader*          shader_info,
+      enum rarch_shader_type dst_type,
+      unsigned               version)
+{
+   unsigned i;
+   slang_compiled_passes_t* compiled = new (std::nothrow) slang_compiled_passes_t;
+
+   if (!compiled)
+      return NULL;
+
+   compiled->type    = dst_type;
+   compiled->version = version;
+   compiled->passes.resize(shader_info->passes);
+
+   for (i = 0; i < shader_info->passes; i++)
+      compiled->passes[i].path = shader_info->pass[i].source.path;
+
+   glslang_parallel_for(shader_info->passes, [&](unsigned j) {
+         compiled->passes[j].ok = slang_compile_pass(
+               &compiled->passes[j], shader_info, dst_type, version);
+         });
+
+   return compiled;
+}
+
+void slang_compiled_passes_free(slang_compiled_passes_t* passes)
+{
+   delete passes;
+}
+
+bool slang_process(
+      video_shader*            shader_info,
+      unsigned                 pass_number,
+      enum rarch_shader_type   dst_type,
+      unsigned                 version,
+      const semantics_map_t*   semantics_map,
+      pass_semantics_t*        out,
+      slang_compiled_passes_t* passes)
+{
+   slang_pass_compile compiled;
+   video_shader_pass& pass        = shader_info->pass[pass_number];
+
+   if (     passes
+         && pass_number < passes->passes.size()
+         && passes->type    == dst_type
+         && passes->version == version
+         && passes->passes[pass_number].path == pass.source.path)
+      compiled = std::move(passes->passes[pass_number]);
+   else
+   {
+      compiled.path = pass.source.path;
+      compiled.ok   = slang_compile_pass(
+            &compiled, shader_info, dst_type, version);
+   }
+
+   if (!compiled.ok)
+      return false;
+
+   if (!slang_preprocess_parse_parameters(compiled.output.meta, shader_info))
+      return false;
+
+   if (!*pass.alias && !compiled.output.meta.name.empty())
+      strlcpy(pass.alias, compiled.output.meta.name.c_str(), sizeof(pass.alias) - 1);
+
+   out->format = compiled.output.meta.rt_format;
+
+   if (out->format == SLANG_FORMAT_UNKNOWN)
+   {
+      if (pass.fbo.srgb_fbo)
+         out->format = SLANG_FORMAT_R8G8B8A8_SRGB;
+      else if (pass.fbo.fp_fbo)
+         out->format = SLANG_FORMAT_R16G16B16A16_SFLOAT;
+      else
+         out->format = SLANG_FORMAT_R8G8B8A8_UNORM;
+   }
+
+   pass.source.string.vertex   = strdup(compiled.vs_code.c_str());
+   pass.source.string.fragment = strdup(compiled.ps_code.c_str());
+
+   try
+   {
       if (!slang_process_reflection(
-                vs_compiler, ps_compiler,
-                vs_resources, ps_resources, shader_info, pass_number,
-                semantics_map, out))
+                compiled.vs_compiler.get(), compiled.ps_compiler.get(),
+                compiled.vs_resources, compiled.ps_resources,
+                shader_info, pass_number, semantics_map, out))
          goto error;
-
    }
    catch (const std::exception& e)
    {
@@ -516,9 +604,6 @@ bool slang_process(
       goto error;
    }
 
-   delete vs_compiler;
-   delete ps_compiler;
-
    return true;
 
 error:
@@ -528,8 +613,5 @@ error:
    pass.source.string.vertex   = NULL;
    pass.source.string.fragment = NULL;
 
-   delete vs_compiler;
-   delete ps_compiler;
-
    return false;
 }
@@ -84,13 +84,29 @@ typedef struct
 
 RETRO_BEGIN_DECLS
 
-bool slang_process(
+/* Passes of a preset compiled ahead of slang_process. */
+typedef struct slang_compiled_passes slang_compiled_passes_t;
+
+/* Compiles every pass of the preset concurrently. Returns NULL
+ * on allocation failure, slang_process then compiles each pass
+ * on its own. */
+slang_compiled_passes_t* slang_compile_passes(
       struct video_shader*   shader_info,
-      unsigned               pass_number,
       enum rarch_shader_type dst_type,
-      unsigned               version,
-      const semantics_map_t* semantics_map,
-      pass_semantics_t*      out);
+      unsigned               version);
+
+void slang_compiled_passes_free(slang_compiled_passes_t* passes);
+
+/* Takes the result for pass_number out of passes when it
+ * matches, otherwise compiles the pass. passes may be NULL. */
+bool slang_process(
+      struct video_shader*     shader_info,
+      unsigned                 pass_number,
+      enum rarch_shader_type   dst_type,
+      unsigned                 version,
+      const semantics_map_t*   semantics_map,
+      pass_semantics_t*        out,
+      slang_compiled_passes_t* passes);
 
 RETRO_END_DECLS
 
@@ -16,6 +16,8 @@
 
 #include <stdlib.h>
 
+#include <retro_miscellaneous.h>
+
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
 #endif
@@ -46,6 +48,9 @@ static const font_renderer_driver_t *font_backends[] = {
 
 static void *video_font_driver = NULL;
 
+/* Text draw calls issued since the last reset, for the statistics overlay. */
+static unsigned font_driver_draw_calls = 0;
+
 int font_renderer_create_default(
       const font_renderer_driver_t **drv,
       void **handle,
@@ -1013,3 +1018,103 @@ void font_driver_free_osd(void)
 
    video_font_driver = NULL;
 }
+
+void font_driver_count_draw_call(void)
+{
+   font_driver_draw_calls++;
+}
+
+/**
+ * font_driver_reset_draw_calls:
+ *
+ * Returns the number of text draw calls issued by the font
+ * drivers since the previous call, and restarts the count.
+ **/
+unsigned font_driver_reset_draw_calls(void)
+{
+   unsigned draw_calls    = font_driver_draw_calls;
+   font_driver_draw_calls = 0;
+   return draw_calls;
+}
+
+/**
+ * font_atlas_mark_dirty:
+ * @atlas                : Font atlas.
+ * @x                    : Left edge of the changed region.
+ * @y                    : Top edge of the changed region.
+ * @width                : Width of the changed region.
+ * @height               : Height of the changed region.
+ *
+ * Grows the pending dirty region of @atlas so that font
+ * drivers only have to re-upload the part that changed.
+ **/
+void font_atlas_mark_dirty(struct font_atlas *atlas,
+      unsigned x, unsigned y, unsigned width, unsigned height)
+{
+   unsigned x1, y1;
+
+   if (!atlas || !width || !height)
+      return;
+
+   /* A full upload is already pending. */
+   if (atlas->dirty && (!atlas->dirty_width || !atlas->dirty_height))
+      return;
+
+   if (!atlas->dirty)
+   {
+      atlas->dirty_x      = x;
+      atlas->dirty_y      = y;
+      atlas->dirty_width  = width;
+      atlas->dirty_height = height;
+      atlas->dirty        = true;
+      return;
+   }
+
+   x1                  = MAX(atlas->dirty_x + atlas->dirty_width,  x + width);
+   y1                  = MAX(atlas->dirty_y + atlas->dirty_height, y + height);
+   atlas->dirty_x      = MIN(atlas->dirty_x, x);
+   atlas->dirty_y      = MIN(atlas->dirty_y, y);
+   atlas->dirty_width  = x1 - atlas->dirty_x;
+   atlas->dirty_height = y1 - atlas->dirty_y;
+}
+
+/**
+ * font_atlas_get_dirty_rect:
+ * @atlas                : Font atlas.
+ * @x                    : Left edge of the region to upload.
+ * @y                    : Top edge of the region to upload.
+ * @width                : Width of the region to upload.
+ * @height               : Height of the region to upload.
+ *
+ * Returns the region of @atlas that needs uploading, clamped
+ * to the atlas. Renderers that only set the dirty flag get
+ * the whole atlas.
+ **/
+void font_atlas_get_dirty_rect(const struct font_atlas *atlas,
+      unsigned *x, unsigned *y, unsigned *width, unsigned *height)
+{
+   if (!atlas->dirty_width || !atlas->dirty_height
+         || atlas->dirty_x >= atlas->width
+         || atlas->dirty_y >= atlas->height)
+   {
+      *x      = 0;
+      *y      = 0;
+      *width  = atlas->width;
+      *height = atlas->height;
+      return;
+   }
+
+   *x      = atlas->dirty_x;
+   *y      = atlas->dirty_y;
+   *width  = MIN(atlas->dirty_width,  atlas->width  - atlas->dirty_x);
+   *height = MIN(atlas->dirty_height, atlas->height - atlas->dirty_y);
+}
+
+void font_atlas_clear_dirty(struct font_atlas *atlas)
+{
+   atlas->dirty_x      = 0;
+   atlas->dirty_y      = 0;
+   atlas->dirty_width  = 0;
+   atlas->dirty_height = 0;
+   atlas->dirty        = false;
+}
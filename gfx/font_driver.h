@@ -58,6 +58,12 @@ struct font_atlas
    uint8_t *buffer; /* Alpha channel. */
    unsigned width;
    unsigned height;
+   /* Region touched since the last upload.
+    * An empty region while dirty means the whole atlas. */
+   unsigned dirty_x;
+   unsigned dirty_y;
+   unsigned dirty_width;
+   unsigned dirty_height;
    bool dirty;
 };
 
@@ -156,6 +162,18 @@ void font_driver_init_osd(
       enum font_driver_render_api api);
 void font_driver_free_osd(void);
 
+void font_driver_count_draw_call(void);
+
+unsigned font_driver_reset_draw_calls(void);
+
+void font_atlas_mark_dirty(struct font_atlas *atlas,
+      unsigned x, unsigned y, unsigned width, unsigned height);
+
+void font_atlas_get_dirty_rect(const struct font_atlas *atlas,
+      unsigned *x, unsigned *y, unsigned *width, unsigned *height);
+
+void font_atlas_clear_dirty(struct font_atlas *atlas);
+
 extern font_renderer_t gl_raster_font;
 extern font_renderer_t libdbg_font;
 extern font_renderer_t d3d_xbox360_font;
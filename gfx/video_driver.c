@@ -169,7 +169,9 @@ static bool video_driver_window_title_update             = true;
 
 static retro_time_t video_driver_frame_time_samples[MEASURE_FRAME_TIME_SAMPLES_COUNT];
 static uint64_t video_driver_frame_time_count            = 0;
+static retro_time_t video_driver_frame_time_start        = 0;
 static uint64_t video_driver_frame_count                 = 0;
+static unsigned video_driver_text_draw_calls              = 0;
 
 static void *video_driver_data                           = NULL;
 static video_driver_t *current_video                     = NULL;
@@ -1363,6 +1365,29 @@ bool video_monitor_fps_statistics(double *refresh_rate,
    return true;
 }
 
+/**
+ * video_driver_get_frame_timing:
+ * @frame_time         : time between the last two frames, in usec.
+ * @frame_start        : time the last frame was handed to the
+ *                       video driver.
+ *
+ * Returns: number of frame time samples taken so far.
+ **/
+uint64_t video_driver_get_frame_timing(retro_time_t *frame_time,
+      retro_time_t *frame_start)
+{
+   if (frame_time)
+      *frame_time  = video_driver_frame_time_count
+         ? video_driver_frame_time_samples[
+         (video_driver_frame_time_count - 1)
+         & (MEASURE_FRAME_TIME_SAMPLES_COUNT - 1)]
+         : 0;
+   if (frame_start)
+      *frame_start = video_driver_frame_time_start;
+
+   return video_driver_frame_time_count;
+}
+
 float video_driver_get_aspect_ratio(void)
 {
    return video_driver_aspect_ratio;
@@ -1815,6 +1840,7 @@ void video_driver_free(void)
 void video_driver_monitor_reset(void)
 {
    video_driver_frame_time_count = 0;
+   video_driver_frame_time_start = 0;
 }
 
 void video_driver_set_aspect_ratio(void)
@@ -2440,6 +2466,11 @@ void video_driver_frame(const void *data, unsigned width,
 
    video_driver_build_info(&video_info);
 
+   video_driver_frame_time_start = new_time;
+
+   /* Text draw calls issued while rendering the previous frame. */
+   video_driver_text_draw_calls  = font_driver_reset_draw_calls();
+
    /* Get the amount of frames per seconds. */
    if (video_driver_frame_count)
    {
@@ -2614,6 +2645,33 @@ void video_driver_frame(const void *data, unsigned width,
             av_info->timing.fps,
             av_info->timing.sample_rate);
 
+      if (compute_audio_latency_statistics(&audio_stats))
+      {
+         char latency_text[256];
+
+         latency_text[0] = '\0';
+
+         snprintf(latency_text, sizeof(latency_text),
+               "Audio Latency:\n -Median: %.2f ms\n -99th percentile: %.2f ms\n -Underruns: %u\n",
+               audio_stats.latency_p50,
+               audio_stats.latency_p99,
+               audio_stats.underruns);
+         strlcat(video_info.stat_text, latency_text,
+               sizeof(video_info.stat_text));
+      }
+
+      {
+         char text_stats[128];
+
+         text_stats[0] = '\0';
+
+         snprintf(text_stats, sizeof(text_stats),
+               "Text Rendering:\n -Draw calls: %u\n",
+               video_driver_text_draw_calls);
+         strlcat(video_info.stat_text, text_stats,
+               sizeof(video_info.stat_text));
+      }
+
       /* TODO/FIXME - add OSD chat text here */
 #if 0
       snprintf(video_info.chat_text, sizeof(video_info.chat_text),
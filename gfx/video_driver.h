@@ -460,7 +460,7 @@ typedef struct video_frame_info
    float xmb_alpha_factor;
 
    char fps_text[128];
-   char stat_text[512];
+   char stat_text[1024];
    char chat_text[256];
 
    uint64_t frame_count;
@@ -1049,6 +1049,17 @@ void video_monitor_set_refresh_rate(float hz);
 bool video_monitor_fps_statistics(double *refresh_rate,
       double *deviation, unsigned *sample_points);
 
+/**
+ * video_driver_get_frame_timing:
+ * @frame_time         : time between the last two frames, in usec.
+ * @frame_start        : time the last frame was handed to the
+ *                       video driver.
+ *
+ * Returns: number of frame time samples taken so far.
+ **/
+uint64_t video_driver_get_frame_timing(retro_time_t *frame_time,
+      retro_time_t *frame_start);
+
 unsigned video_pixel_get_alignment(unsigned pitch);
 
 const video_poke_interface_t *video_driver_get_poke(void);
@@ -1171,6 +1171,7 @@ MENU
 #include "../menu/menu_shader.c"
 #include "../menu/menu_displaylist.c"
 #include "../menu/menu_animation.c"
+#include "../menu/menu_thumbnail_cache.c"
 
 #include "../menu/drivers/null.c"
 #include "../menu/drivers/menu_generic.c"
@@ -38,6 +38,10 @@ MSG_HASH(MENU_ENUM_LABEL_AUDIO_MAX_TIMING_SKEW,
       "audio_max_timing_skew")
 MSG_HASH(MENU_ENUM_LABEL_AUDIO_MUTE,
       "audio_mute_enable")
+MSG_HASH(MENU_ENUM_LABEL_AUDIO_PIPELINE_THREADED,
+      "audio_pipeline_threaded")
+MSG_HASH(MENU_ENUM_LABEL_AUDIO_LATENCY_STATS_ENABLE,
+      "audio_latency_stats_enable")
 MSG_HASH(MENU_ENUM_LABEL_AUDIO_OUTPUT_RATE,
       "audio_output_rate")
 MSG_HASH(MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_DELTA,
@@ -951,6 +955,8 @@ MSG_HASH(MENU_ENUM_LABEL_REWIND_SETTINGS,
       "rewind_settings")
 MSG_HASH(MENU_ENUM_LABEL_VRR_RUNLOOP_ENABLE,
       "vrr_runloop_enable")
+MSG_HASH(MENU_ENUM_LABEL_FRAME_PACING_PRECISE,
+      "frame_pacing_precise")
 MSG_HASH(MENU_ENUM_LABEL_CHEAT_SETTINGS,
       "cheat_settings")
 MSG_HASH(MENU_ENUM_LABEL_RGUI_BROWSER_DIRECTORY,
@@ -1177,6 +1183,10 @@ MSG_HASH(MENU_ENUM_LABEL_VIDEO_FORCE_SRGB_DISABLE,
       "video_force_srgb_disable")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_FRAME_DELAY,
       "video_frame_delay")
+MSG_HASH(MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,
+      "video_frame_delay_auto")
+MSG_HASH(MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO_MARGIN,
+      "video_frame_delay_auto_margin")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_FULLSCREEN,
       "video_fullscreen")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_GAMMA,
@@ -1185,6 +1195,8 @@ MSG_HASH(MENU_ENUM_LABEL_VIDEO_GPU_RECORD,
       "video_gpu_record")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_GPU_SCREENSHOT,
       "video_gpu_screenshot")
+MSG_HASH(MENU_ENUM_LABEL_SCREENSHOT_COMPRESSION_LEVEL,
+      "screenshot_compression_level")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_HARD_SYNC,
       "video_hard_sync")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_HARD_SYNC_FRAMES,
@@ -1243,6 +1255,8 @@ MSG_HASH(MENU_ENUM_LABEL_VIDEO_TAB,
       "video_tab")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_THREADED,
       "video_threaded")
+MSG_HASH(MENU_ENUM_LABEL_VIDEO_SHADER_ASYNC_LOAD,
+      "video_shader_async_load")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_VFILTER,
       "video_vfilter")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_VIEWPORT_CUSTOM_HEIGHT,
@@ -154,6 +154,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_VIDEO_THREADED,
     "Improves performance at the cost of latency and more video stuttering. Use only if you cannot obtain full speed otherwise."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_VIDEO_SHADER_ASYNC_LOAD,
+    "Compile newly applied shader presets in the background. The previous shader keeps rendering until the new one is ready. Only supported by some video drivers."
+    )
 MSG_HASH(
     MSG_AUDIO_VOLUME,
     "Audio volume"
@@ -310,6 +314,14 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_AUDIO_SYNC,
     "Audio Sync"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_AUDIO_PIPELINE_THREADED,
+    "Threaded Audio Pipeline"
+    )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_AUDIO_LATENCY_STATS_ENABLE,
+    "Audio Latency Statistics"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_AUDIO_VOLUME,
     "Audio Volume Level (dB)"
@@ -822,6 +834,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VRR_RUNLOOP_ENABLE,
     "Sync to Exact Content Framerate (G-Sync, FreeSync)"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_FRAME_PACING_PRECISE,
+    "Precise Frame Pacing"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_FRAME_THROTTLE_SETTINGS,
     "Frame Throttle"
@@ -3050,6 +3066,14 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DELAY,
     "Frame Delay"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DELAY_AUTO,
+    "Automatic Frame Delay"
+    )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DELAY_AUTO_MARGIN,
+    "Automatic Frame Delay Margin"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_FULLSCREEN,
     "Start in Fullscreen Mode"
@@ -3066,6 +3090,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_GPU_SCREENSHOT,
     "GPU Screenshot Enable"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_SCREENSHOT_COMPRESSION_LEVEL,
+    "Screenshot Compression Level"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_HARD_SYNC,
     "Hard GPU Sync"
@@ -3178,6 +3206,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_THREADED,
     "Threaded Video"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_VIDEO_SHADER_ASYNC_LOAD,
+    "Background Shader Loading"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_VFILTER,
     "Deflicker"
@@ -3610,6 +3642,14 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_VIDEO_FRAME_DELAY,
     "Reduces latency at the cost of a higher risk of video stuttering. Adds a delay after V-Sync (in ms)."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_VIDEO_FRAME_DELAY_AUTO,
+    "Measure how long the core takes to run each frame and use the largest frame delay that still leaves the margin below before V-Sync. Backs off as soon as a frame is missed. Overrides Frame Delay."
+    )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_VIDEO_FRAME_DELAY_AUTO_MARGIN,
+    "Headroom (in ms) Automatic Frame Delay keeps between the end of the core's frame and V-Sync."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_VIDEO_HARD_SYNC_FRAMES,
     "Sets how many frames the CPU can run ahead of the GPU when using 'Hard GPU Sync'."
@@ -4490,6 +4530,14 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_AUDIO_SYNC,
     "Synchronize audio. Recommended."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_AUDIO_PIPELINE_THREADED,
+    "Convert, filter, resample and output audio on a separate thread. Expensive resampler settings no longer cost core frame time, at the cost of slightly higher latency."
+    )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_AUDIO_LATENCY_STATS_ENABLE,
+    "Measure the time between the core producing audio and the audio driver playing it back, and count buffer underruns. Shown in the onscreen statistics and logged when audio is deinitialized."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_INPUT_AXIS_THRESHOLD,
     "How far an axis must be tilted to result in a button press."
@@ -4842,6 +4890,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_VIDEO_GPU_SCREENSHOT,
     "Screenshots output of GPU shaded material if available."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_SCREENSHOT_COMPRESSION_LEVEL,
+    "PNG compression level of screenshots and savestate thumbnails. Higher levels make smaller files but take longer to save."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_VIDEO_ROTATION,
     "Forces a certain rotation of the screen. The rotation is added to rotations which the core sets."
@@ -5470,6 +5522,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_VRR_RUNLOOP_ENABLE,
     "No deviation from core requested timing. Use for Variable Refresh Rate screens, G-Sync, FreeSync."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_FRAME_PACING_PRECISE,
+    "Time frame limiting and frame delay to the microsecond, spinning briefly before each deadline. Reduces frame time jitter at the cost of some CPU time. Pacing errors are reported in the performance counters."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_XMB_LAYOUT,
     "Select a different layout for the XMB interface."
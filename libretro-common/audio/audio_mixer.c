@@ -30,6 +30,12 @@
 #include <rthreads/rthreads.h>
 #endif
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -65,6 +71,15 @@
 #define AUDIO_MIXER_MAX_VOICES      8
 #define AUDIO_MIXER_TEMP_BUFFER 8192
 
+/* Size in samples of the per-voice decode and output buffers.
+ * These are the only buffers a streaming voice uses, so
+ * memory does not grow with the length of the sound. */
+#define AUDIO_MIXER_STREAM_SAMPLES  AUDIO_MIXER_TEMP_BUFFER
+
+typedef unsigned (*audio_mixer_decode_t)(audio_mixer_voice_t *voice,
+      float *out, unsigned frames);
+typedef void (*audio_mixer_rewind_t)(audio_mixer_voice_t *voice);
+
 struct audio_mixer_sound
 {
    enum audio_mixer_type type;
@@ -74,8 +89,7 @@ struct audio_mixer_sound
       struct
       {
          /* wav */
-         unsigned frames;
-         const float* pcm;
+         rwav_t wav;
       } wav;
 
 #ifdef HAVE_STB_VORBIS
@@ -124,6 +138,23 @@ struct audio_mixer_voice
    audio_mixer_sound_t *sound;
    audio_mixer_stop_cb_t stop_cb;
 
+   /* Streaming state of the WAV/OGG/FLAC/MP3 voices.
+    * Frames are decoded decode_frames at a time into 'decode',
+    * resampled into 'buffer' and consumed from there.
+    * Both buffers are allocated once per voice slot and
+    * reused for every sound played on it. */
+   struct
+   {
+      float    *decode;
+      float    *buffer;
+      unsigned decode_frames;
+      unsigned position;
+      unsigned samples;
+      float    ratio;
+      void     *resampler_data;
+      const retro_resampler_t *resampler;
+   } stream;
+
    union
    {
       struct
@@ -134,42 +165,21 @@ struct audio_mixer_voice
 #ifdef HAVE_STB_VORBIS
       struct
       {
-         unsigned    position;
-         unsigned    samples;
-         unsigned    buf_samples;
-         float*      buffer;
-         float       ratio;
          stb_vorbis *stream;
-         void       *resampler_data;
-         const retro_resampler_t *resampler;
       } ogg;
 #endif
 
 #ifdef HAVE_DR_FLAC
       struct
       {
-         unsigned    position;
-         unsigned    samples;
-         unsigned    buf_samples;
-         float*      buffer;
-         float       ratio;
          drflac      *stream;
-         void        *resampler_data;
-         const retro_resampler_t *resampler;
       } flac;
 #endif
 
 #ifdef HAVE_DR_MP3
       struct
       {
-         unsigned    position;
-         unsigned    samples;
-         unsigned    buf_samples;
-         float*      buffer;
-         float       ratio;
          drmp3       stream;
-         void        *resampler_data;
-         const retro_resampler_t *resampler;
       } mp3;
 #endif
 
@@ -193,117 +203,63 @@ static unsigned s_rate = 0;
 static slock_t* s_locker = NULL;
 #endif
 
-static bool wav2float(const rwav_t* wav, float** pcm, size_t samples_out)
+/**
+ * audio_mixer_mix_samples:
+ * @dst                  : destination buffer.
+ * @src                  : source buffer.
+ * @samples              : amount of samples to mix.
+ * @volume               : gain applied to @src.
+ *
+ * Accumulates @src * @volume into @dst.
+ **/
+static void audio_mixer_mix_samples(float *dst, const float *src,
+      unsigned samples, float volume)
 {
-   size_t i;
-   /* Allocate on a 16-byte boundary, and pad to a multiple of 16 bytes */
-   float *f           = (float*)memalign_alloc(16,
-         ((samples_out + 15) & ~15) * sizeof(float));
-
-   if (!f)
-      return false;
-
-   *pcm = f;
-
-   if (wav->bitspersample == 8)
-   {
-      float sample      = 0.0f;
-      const uint8_t *u8 = (const uint8_t*)wav->samples;
-
-      if (wav->numchannels == 1)
-      {
-         for (i = wav->numsamples; i != 0; i--)
-         {
-            sample = (float)*u8++ / 255.0f;
-            sample = sample * 2.0f - 1.0f;
-            *f++   = sample;
-            *f++   = sample;
-         }
-      }
-      else if (wav->numchannels == 2)
-      {
-         for (i = wav->numsamples; i != 0; i--)
-         {
-            sample = (float)*u8++ / 255.0f;
-            sample = sample * 2.0f - 1.0f;
-            *f++   = sample;
-            sample = (float)*u8++ / 255.0f;
-            sample = sample * 2.0f - 1.0f;
-            *f++   = sample;
-         }
-      }
-   }
-   else
-   {
-      /* TODO/FIXME note to leiradel - can we use audio/conversion/s16_to_float
-       * functions here? */
-
-      float sample       = 0.0f;
-      const int16_t *s16 = (const int16_t*)wav->samples;
-
-      if (wav->numchannels == 1)
-      {
-         for (i = wav->numsamples; i != 0; i--)
-         {
-            sample = (float)((int)*s16++ + 32768) / 65535.0f;
-            sample = sample * 2.0f - 1.0f;
-            *f++   = sample;
-            *f++   = sample;
-         }
-      }
-      else if (wav->numchannels == 2)
-      {
-         for (i = wav->numsamples; i != 0; i--)
-         {
-            sample = (float)((int)*s16++ + 32768) / 65535.0f;
-            sample = sample * 2.0f - 1.0f;
-            *f++   = sample;
-            sample = (float)((int)*s16++ + 32768) / 65535.0f;
-            sample = sample * 2.0f - 1.0f;
-            *f++   = sample;
-         }
-      }
-   }
+   unsigned i = 0;
+#if defined(__SSE__)
+   __m128 vol = _mm_set1_ps(volume);
+
+   for (; i + 4 <= samples; i += 4)
+      _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i),
+               _mm_mul_ps(_mm_loadu_ps(src + i), vol)));
+#elif defined(__ARM_NEON__)
+   float32x4_t vol = vdupq_n_f32(volume);
+
+   for (; i + 4 <= samples; i += 4)
+      vst1q_f32(dst + i, vmlaq_f32(vld1q_f32(dst + i),
+               vld1q_f32(src + i), vol));
+#endif
 
-   return true;
+   for (; i < samples; i++)
+      dst[i] += src[i] * volume;
 }
 
-static bool one_shot_resample(const float* in, size_t samples_in,
-      unsigned rate, float** out, size_t* samples_out)
+static void audio_mixer_clamp_samples(float *buffer, size_t samples)
 {
-   struct resampler_data info;
-   void* data                         = NULL;
-   const retro_resampler_t* resampler = NULL;
-   float ratio                        = (double)s_rate / (double)rate;
-
-   if (!retro_resampler_realloc(&data, &resampler, NULL, 
-            RESAMPLER_QUALITY_DONTCARE, ratio))
-      return false;
-
-   /*
-    * Allocate on a 16-byte boundary, and pad to a multiple of 16 bytes. We
-    * add four more samples in the formula below just as safeguard, because
-    * resampler->process sometimes reports more output samples than the
-    * formula below calculates. Ideally, audio resamplers should have a
-    * function to return the number of samples they will output given a
-    * count of input samples.
-    */
-   *samples_out                       = samples_in * ratio + 4;
-   *out                               = (float*)memalign_alloc(16,
-         ((*samples_out + 15) & ~15) * sizeof(float));
-
-   if (*out == NULL)
-      return false;
-
-   info.data_in                       = in;
-   info.data_out                      = *out;
-   info.input_frames                  = samples_in / 2;
-   info.output_frames                 = 0;
-   info.ratio                         = ratio;
+   size_t i = 0;
+#if defined(__SSE__)
+   __m128 lo = _mm_set1_ps(-1.0f);
+   __m128 hi = _mm_set1_ps(1.0f);
+
+   for (; i + 4 <= samples; i += 4)
+      _mm_storeu_ps(buffer + i, _mm_min_ps(hi,
+               _mm_max_ps(lo, _mm_loadu_ps(buffer + i))));
+#elif defined(__ARM_NEON__)
+   float32x4_t lo = vdupq_n_f32(-1.0f);
+   float32x4_t hi = vdupq_n_f32(1.0f);
+
+   for (; i + 4 <= samples; i += 4)
+      vst1q_f32(buffer + i, vminq_f32(hi,
+               vmaxq_f32(lo, vld1q_f32(buffer + i))));
+#endif
 
-   resampler->process(data, &info);
-   resampler->free(data);
-   return true;
+   for (; i < samples; i++)
+   {
+      if (buffer[i] < -1.0f)
+         buffer[i] = -1.0f;
+      else if (buffer[i] > 1.0f)
+         buffer[i] = 1.0f;
+   }
 }
 
 void audio_mixer_init(unsigned rate)
@@ -331,16 +287,29 @@ void audio_mixer_done(void)
 #endif
 
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
-      s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
+   {
+      audio_mixer_voice_t *voice = &s_voices[i];
+
+      voice->type = AUDIO_MIXER_TYPE_NONE;
+
+      if (voice->stream.resampler && voice->stream.resampler_data)
+         voice->stream.resampler->free(voice->stream.resampler_data);
+      if (voice->stream.decode)
+         memalign_free(voice->stream.decode);
+      if (voice->stream.buffer)
+         memalign_free(voice->stream.buffer);
+
+      voice->stream.resampler      = NULL;
+      voice->stream.resampler_data = NULL;
+      voice->stream.decode         = NULL;
+      voice->stream.buffer         = NULL;
+   }
 }
 
 audio_mixer_sound_t* audio_mixer_load_wav(void *buffer, int32_t size)
 {
    /* WAV data */
    rwav_t wav;
-   /* WAV samples converted to float */
-   float* pcm                 = NULL;
-   size_t samples             = 0;
    /* Result */
    audio_mixer_sound_t* sound = NULL;
    enum rwav_state rwav_ret   = rwav_load(&wav, buffer, size);
@@ -348,36 +317,23 @@ audio_mixer_sound_t* audio_mixer_load_wav(void *buffer, int32_t size)
    if (rwav_ret != RWAV_ITERATE_DONE)
       return NULL;
 
-   samples       = wav.numsamples * 2;
-
-   if (!wav2float(&wav, &pcm, samples))
-      return NULL;
-
-   if (wav.samplerate != s_rate)
+   if (wav.numchannels != 1 && wav.numchannels != 2)
    {
-      float* resampled           = NULL;
-
-      if (!one_shot_resample(pcm, samples,
-               wav.samplerate, &resampled, &samples))
-         return NULL;
-
-      memalign_free((void*)pcm);
-      pcm = resampled;
+      rwav_free(&wav);
+      return NULL;
    }
 
    sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
 
    if (!sound)
    {
-      memalign_free((void*)pcm);
+      rwav_free(&wav);
       return NULL;
    }
 
-   sound->type             = AUDIO_MIXER_TYPE_WAV;
-   sound->types.wav.frames = (unsigned)(samples / 2);
-   sound->types.wav.pcm    = pcm;
-
-   rwav_free(&wav);
+   /* Samples are converted and resampled while mixing. */
+   sound->type            = AUDIO_MIXER_TYPE_WAV;
+   sound->types.wav.wav   = wav;
 
    return sound;
 }
@@ -464,9 +420,7 @@ void audio_mixer_destroy(audio_mixer_sound_t* sound)
    switch (sound->type)
    {
       case AUDIO_MIXER_TYPE_WAV:
-         handle = (void*)sound->types.wav.pcm;
-         if (handle)
-            memalign_free(handle);
+         rwav_free(&sound->types.wav.wav);
          break;
       case AUDIO_MIXER_TYPE_OGG:
 #ifdef HAVE_STB_VORBIS
@@ -503,12 +457,107 @@ void audio_mixer_destroy(audio_mixer_sound_t* sound)
    free(sound);
 }
 
+/**
+ * audio_mixer_play_stream:
+ * @voice                : voice to set up.
+ * @rate                 : sample rate the sound decodes at.
+ *
+ * Prepares the streaming state of @voice. The per-voice
+ * buffers are only allocated the first time the slot is used.
+ *
+ * Returns: true on success, otherwise false.
+ **/
+static bool audio_mixer_play_stream(audio_mixer_voice_t* voice,
+      unsigned rate)
+{
+   float ratio         = 1.0f;
+   unsigned out_frames = AUDIO_MIXER_STREAM_SAMPLES / 2;
+
+   if (!voice->stream.decode)
+      voice->stream.decode = (float*)memalign_alloc(16,
+            AUDIO_MIXER_STREAM_SAMPLES * sizeof(float));
+   if (!voice->stream.buffer)
+      voice->stream.buffer = (float*)memalign_alloc(16,
+            AUDIO_MIXER_STREAM_SAMPLES * sizeof(float));
+
+   if (!voice->stream.decode || !voice->stream.buffer)
+      return false;
+
+   if (voice->stream.resampler && voice->stream.resampler_data)
+      voice->stream.resampler->free(voice->stream.resampler_data);
+   voice->stream.resampler      = NULL;
+   voice->stream.resampler_data = NULL;
+
+   if (rate != s_rate)
+   {
+      ratio = (double)s_rate / (double)rate;
+
+      if (!retro_resampler_realloc(&voice->stream.resampler_data,
+               &voice->stream.resampler, NULL, RESAMPLER_QUALITY_DONTCARE,
+               ratio))
+      {
+         voice->stream.resampler = NULL;
+         return false;
+      }
+   }
+
+   /* Leave some headroom, resamplers sometimes output
+    * a few more frames than input_frames * ratio. */
+   voice->stream.decode_frames = (unsigned)((out_frames - 16) / ratio);
+   if (voice->stream.decode_frames > out_frames)
+      voice->stream.decode_frames = out_frames;
+   if (voice->stream.decode_frames == 0)
+      voice->stream.decode_frames = 1;
+
+   voice->stream.ratio    = ratio;
+   voice->stream.position = 0;
+   voice->stream.samples  = 0;
+
+   return true;
+}
+
+/* Closes the decoder of @voice and drops its resampler.
+ * The per-voice buffers are kept for the next sound. */
+static void audio_mixer_release(audio_mixer_voice_t* voice)
+{
+   switch (voice->type)
+   {
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         stb_vorbis_close(voice->types.ogg.stream);
+         voice->types.ogg.stream = NULL;
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         drflac_close(voice->types.flac.stream);
+         voice->types.flac.stream = NULL;
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         drmp3_uninit(&voice->types.mp3.stream);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_WAV:
+      case AUDIO_MIXER_TYPE_MOD:
+      case AUDIO_MIXER_TYPE_NONE:
+         break;
+   }
+
+   if (voice->stream.resampler && voice->stream.resampler_data)
+      voice->stream.resampler->free(voice->stream.resampler_data);
+   voice->stream.resampler      = NULL;
+   voice->stream.resampler_data = NULL;
+}
+
 static bool audio_mixer_play_wav(audio_mixer_sound_t* sound,
       audio_mixer_voice_t* voice, bool repeat, float volume,
       audio_mixer_stop_cb_t stop_cb)
 {
    voice->types.wav.position = 0;
-   return true;
+   return audio_mixer_play_stream(voice,
+         sound->types.wav.wav.samplerate);
 }
 
 #ifdef HAVE_STB_VORBIS
@@ -520,11 +569,6 @@ static bool audio_mixer_play_ogg(
 {
    stb_vorbis_info info;
    int res                         = 0;
-   float ratio                     = 1.0f;
-   unsigned samples                = 0;
-   void *ogg_buffer                = NULL;
-   void *resampler_data            = NULL;
-   const retro_resampler_t* resamp = NULL;
    stb_vorbis *stb_vorbis          = stb_vorbis_open_memory(
          (const unsigned char*)sound->types.ogg.data,
          sound->types.ogg.size, &res, NULL);
@@ -534,34 +578,10 @@ static bool audio_mixer_play_ogg(
 
    info                    = stb_vorbis_get_info(stb_vorbis);
 
-   if (info.sample_rate != s_rate)
-   {
-      ratio = (double)s_rate / (double)info.sample_rate;
-
-      if (!retro_resampler_realloc(&resampler_data,
-               &resamp, NULL, RESAMPLER_QUALITY_DONTCARE,
-               ratio))
-         goto error;
-   }
-
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   ogg_buffer                      = (float*)memalign_alloc(16,
-         ((samples + 15) & ~15) * sizeof(float));
-
-   if (!ogg_buffer)
-   {
-      resamp->free(resampler_data);
+   if (!audio_mixer_play_stream(voice, info.sample_rate))
       goto error;
-   }
 
-   voice->types.ogg.resampler      = resamp;
-   voice->types.ogg.resampler_data = resampler_data;
-   voice->types.ogg.buffer         = (float*)ogg_buffer;
-   voice->types.ogg.buf_samples    = samples;
-   voice->types.ogg.ratio          = ratio;
    voice->types.ogg.stream         = stb_vorbis;
-   voice->types.ogg.position       = 0;
-   voice->types.ogg.samples        = 0;
 
    return true;
 
@@ -647,45 +667,15 @@ static bool audio_mixer_play_flac(
       bool repeat, float volume,
       audio_mixer_stop_cb_t stop_cb)
 {
-   float ratio                     = 1.0f;
-   unsigned samples                = 0;
-   void *flac_buffer                = NULL;
-   void *resampler_data            = NULL;
-   const retro_resampler_t* resamp = NULL;
    drflac *dr_flac          = drflac_open_memory((const unsigned char*)sound->types.flac.data,sound->types.flac.size);
-   
 
    if (!dr_flac)
       return false;
-   if (dr_flac->sampleRate != s_rate)
-   {
-      ratio = (double)s_rate / (double)(dr_flac->sampleRate);
-
-      if (!retro_resampler_realloc(&resampler_data,
-               &resamp, NULL, RESAMPLER_QUALITY_DONTCARE,
-               ratio))
-         goto error;
-   }
-
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   flac_buffer                      = (float*)memalign_alloc(16,
-         ((samples + 15) & ~15) * sizeof(float));
 
-   if (!flac_buffer)
-   {
-      if (resamp && resamp->free)
-         resamp->free(resampler_data);
+   if (!audio_mixer_play_stream(voice, dr_flac->sampleRate))
       goto error;
-   }
 
-   voice->types.flac.resampler      = resamp;
-   voice->types.flac.resampler_data = resampler_data;
-   voice->types.flac.buffer         = (float*)flac_buffer;
-   voice->types.flac.buf_samples    = samples;
-   voice->types.flac.ratio          = ratio;
    voice->types.flac.stream         = dr_flac;
-   voice->types.flac.position       = 0;
-   voice->types.flac.samples        = 0;
 
    return true;
 
@@ -702,41 +692,12 @@ static bool audio_mixer_play_mp3(
       bool repeat, float volume,
       audio_mixer_stop_cb_t stop_cb)
 {
-   float ratio                     = 1.0f;
-   unsigned samples                = 0;
-   void *mp3_buffer                = NULL;
-   void *resampler_data            = NULL;
-   const retro_resampler_t* resamp = NULL;
    bool res =drmp3_init_memory(&voice->types.mp3.stream,(const unsigned char*)sound->types.mp3.data,sound->types.mp3.size,NULL);
    if (!res)
       return false;
-   if (voice->types.mp3.stream.sampleRate != s_rate)
-   {
-      ratio = (double)s_rate / (double)(voice->types.mp3.stream.sampleRate);
 
-      if (!retro_resampler_realloc(&resampler_data,
-               &resamp, NULL, RESAMPLER_QUALITY_DONTCARE,
-               ratio))
-         goto error;
-   }
-
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   mp3_buffer                      = (float*)memalign_alloc(16,
-         ((samples + 15) & ~15) * sizeof(float));
-
-   if (!mp3_buffer)
-   {
-      resamp->free(resampler_data);
+   if (!audio_mixer_play_stream(voice, voice->types.mp3.stream.sampleRate))
       goto error;
-   }
-
-   voice->types.mp3.resampler      = resamp;
-   voice->types.mp3.resampler_data = resampler_data;
-   voice->types.mp3.buffer         = (float*)mp3_buffer;
-   voice->types.mp3.buf_samples    = samples;
-   voice->types.mp3.ratio          = ratio;
-   voice->types.mp3.position       = 0;
-   voice->types.mp3.samples        = 0;
 
    return true;
 
@@ -830,6 +791,7 @@ void audio_mixer_stop(audio_mixer_voice_t* voice)
       slock_lock(s_locker);
 #endif
 
+      audio_mixer_release(voice);
       voice->type = AUDIO_MIXER_TYPE_NONE;
 
 #ifdef HAVE_THREADS
@@ -841,124 +803,187 @@ void audio_mixer_stop(audio_mixer_voice_t* voice)
    }
 }
 
-static void audio_mixer_mix_wav(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
+static unsigned audio_mixer_decode_wav(audio_mixer_voice_t* voice,
+      float *out, unsigned frames)
 {
-   int i;
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   const audio_mixer_sound_t* sound = voice->sound;
-   unsigned pcm_available           = sound->types.wav.frames
-      * 2 - voice->types.wav.position;
-   const float* pcm                 = sound->types.wav.pcm +
-      voice->types.wav.position;
+   unsigned i;
+   float sample      = 0.0f;
+   const rwav_t *wav = &voice->sound->types.wav.wav;
+   unsigned position = voice->types.wav.position;
+   unsigned avail    = (unsigned)wav->numsamples - position;
 
-again:
-   if (pcm_available < buf_free)
+   if (frames > avail)
+      frames = avail;
+
+   if (wav->bitspersample == 8)
    {
-      for (i = pcm_available; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      const uint8_t *u8 = (const uint8_t*)wav->samples
+         + position * wav->numchannels;
 
-      if (voice->repeat)
+      for (i = 0; i < frames * wav->numchannels; i++)
       {
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-         buf_free                  -= pcm_available;
-         pcm_available              = sound->types.wav.frames * 2;
-         pcm                        = sound->types.wav.pcm;
-         voice->types.wav.position  = 0;
-         goto again;
+         sample = (float)*u8++ / 255.0f;
+         sample = sample * 2.0f - 1.0f;
+         *out++ = sample;
+         if (wav->numchannels == 1)
+            *out++ = sample;
       }
-
-      if (voice->stop_cb)
-         voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-      voice->type = AUDIO_MIXER_TYPE_NONE;
    }
    else
    {
-      for (i = buf_free; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      const int16_t *s16 = (const int16_t*)wav->samples
+         + position * wav->numchannels;
 
-      voice->types.wav.position += buf_free;
+      for (i = 0; i < frames * wav->numchannels; i++)
+      {
+         sample = (float)((int)*s16++ + 32768) / 65535.0f;
+         sample = sample * 2.0f - 1.0f;
+         *out++ = sample;
+         if (wav->numchannels == 1)
+            *out++ = sample;
+      }
    }
+
+   voice->types.wav.position += frames;
+
+   return frames;
+}
+
+static void audio_mixer_seek_start_wav(audio_mixer_voice_t* voice)
+{
+   voice->types.wav.position = 0;
 }
 
 #ifdef HAVE_STB_VORBIS
-static void audio_mixer_mix_ogg(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
+static unsigned audio_mixer_decode_ogg(audio_mixer_voice_t* voice,
+      float *out, unsigned frames)
 {
-   int i;
-   struct resampler_data info = { 0 };
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
+   return stb_vorbis_get_samples_float_interleaved(
+         voice->types.ogg.stream, 2, out, frames * 2);
+}
+
+static void audio_mixer_seek_start_ogg(audio_mixer_voice_t* voice)
+{
+   stb_vorbis_seek_start(voice->types.ogg.stream);
+}
+#endif
+
+#ifdef HAVE_DR_FLAC
+static unsigned audio_mixer_decode_flac(audio_mixer_voice_t* voice,
+      float *out, unsigned frames)
+{
+   return (unsigned)drflac_read_f32(voice->types.flac.stream,
+         frames * 2, out) / 2;
+}
+
+static void audio_mixer_seek_start_flac(audio_mixer_voice_t* voice)
+{
+   drflac_seek_to_sample(voice->types.flac.stream, 0);
+}
+#endif
+
+#ifdef HAVE_DR_MP3
+static unsigned audio_mixer_decode_mp3(audio_mixer_voice_t* voice,
+      float *out, unsigned frames)
+{
+   return (unsigned)drmp3_read_f32(&voice->types.mp3.stream,
+         frames, out);
+}
 
-   if (voice->types.ogg.position == voice->types.ogg.samples)
+static void audio_mixer_seek_start_mp3(audio_mixer_voice_t* voice)
+{
+   drmp3_seek_to_frame(&voice->types.mp3.stream, 0);
+}
+#endif
+
+/**
+ * audio_mixer_mix_stream:
+ * @buffer               : buffer to mix into.
+ * @num_frames           : amount of frames to mix.
+ * @voice                : streaming voice.
+ * @volume               : gain of the voice.
+ * @decode               : decodes up to N frames of the sound.
+ * @seek_start           : restarts decoding from the beginning.
+ *
+ * Mixes a WAV/OGG/FLAC/MP3 voice, decoding and resampling
+ * one chunk at a time into the voice's fixed-size buffer.
+ **/
+static void audio_mixer_mix_stream(float* buffer, size_t num_frames,
+      audio_mixer_voice_t* voice, float volume,
+      audio_mixer_decode_t decode, audio_mixer_rewind_t seek_start)
+{
+   unsigned buf_free = (unsigned)(num_frames * 2);
+   bool rewound      = false;
+
+   while (buf_free)
    {
-again:
-      temp_samples = stb_vorbis_get_samples_float_interleaved(
-            voice->types.ogg.stream, 2, temp_buffer,
-            AUDIO_MIXER_TEMP_BUFFER) * 2;
+      unsigned samples;
 
-      if (temp_samples == 0)
+      if (voice->stream.samples == 0)
       {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
+         /* Without a resampler, decode straight into the output buffer. */
+         float *out      = voice->stream.resampler
+            ? voice->stream.decode : voice->stream.buffer;
+         unsigned frames = decode(voice, out, voice->stream.decode_frames);
 
-            stb_vorbis_seek_start(voice->types.ogg.stream);
-            goto again;
-         }
-         else
+         if (frames == 0)
          {
+            /* 'rewound' keeps an empty sound from looping forever. */
+            if (voice->repeat && !rewound)
+            {
+               if (voice->stop_cb)
+                  voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
+
+               seek_start(voice);
+               rewound = true;
+               continue;
+            }
+
+            audio_mixer_release(voice);
+
             if (voice->stop_cb)
                voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
 
             voice->type = AUDIO_MIXER_TYPE_NONE;
             return;
          }
-      }
 
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.ogg.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.ogg.ratio;
-
-      if (voice->types.ogg.resampler)
-        voice->types.ogg.resampler->process(voice->types.ogg.resampler_data, &info);
-      else
-        memcpy(voice->types.ogg.buffer, temp_buffer, temp_samples * sizeof(float));
-      voice->types.ogg.position = 0;
-      voice->types.ogg.samples  = voice->types.ogg.buf_samples;
-   }
+         rewound = false;
 
-   pcm = voice->types.ogg.buffer + voice->types.ogg.position;
+         if (voice->stream.resampler)
+         {
+            struct resampler_data info;
 
-   if (voice->types.ogg.samples < buf_free)
-   {
-      for (i = voice->types.ogg.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+            info.data_in       = voice->stream.decode;
+            info.data_out      = voice->stream.buffer;
+            info.input_frames  = frames;
+            info.output_frames = 0;
+            info.ratio         = voice->stream.ratio;
 
-      buf_free -= voice->types.ogg.samples;
-      goto again;
-   }
-   else
-   {
-      int i;
-      for (i = buf_free; i != 0; --i )
-         *buffer++ += *pcm++ * volume;
+            voice->stream.resampler->process(
+                  voice->stream.resampler_data, &info);
+
+            frames             = (unsigned)info.output_frames;
+         }
 
-      voice->types.ogg.position += buf_free;
-      voice->types.ogg.samples  -= buf_free;
+         voice->stream.position = 0;
+         voice->stream.samples  = frames * 2;
+         continue;
+      }
+
+      samples = voice->stream.samples < buf_free
+         ? voice->stream.samples : buf_free;
+
+      audio_mixer_mix_samples(buffer,
+            voice->stream.buffer + voice->stream.position,
+            samples, volume);
+
+      buffer                 += samples;
+      buf_free               -= samples;
+      voice->stream.position += samples;
+      voice->stream.samples  -= samples;
    }
 }
-#endif
 
 #ifdef HAVE_IBXM
 static void audio_mixer_mix_mod(float* buffer, size_t num_frames,
@@ -1035,156 +1060,9 @@ again:
 }
 #endif
 
-#ifdef HAVE_DR_FLAC
-static void audio_mixer_mix_flac(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   struct resampler_data info = { 0 };
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
-
-   if (voice->types.flac.position == voice->types.flac.samples)
-   {
-again:
-      temp_samples = (unsigned)drflac_read_f32( voice->types.flac.stream, AUDIO_MIXER_TEMP_BUFFER, temp_buffer);
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            drflac_seek_to_sample(voice->types.flac.stream,0);
-            goto again;
-         }
-         else
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-            voice->type = AUDIO_MIXER_TYPE_NONE;
-            return;
-         }
-      }
-
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.flac.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.flac.ratio;
-
-      if (voice->types.flac.resampler)
-        voice->types.flac.resampler->process(voice->types.flac.resampler_data, &info);
-      else
-        memcpy(voice->types.flac.buffer, temp_buffer, temp_samples * sizeof(float));
-      voice->types.flac.position = 0;
-      voice->types.flac.samples  = voice->types.flac.buf_samples;
-   }
-
-   pcm = voice->types.flac.buffer + voice->types.flac.position;
-
-   if (voice->types.flac.samples < buf_free)
-   {
-      for (i = voice->types.flac.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      buf_free -= voice->types.flac.samples;
-      goto again;
-   }
-   else
-   {
-      int i;
-      for (i = buf_free; i != 0; --i )
-         *buffer++ += *pcm++ * volume;
-
-      voice->types.flac.position += buf_free;
-      voice->types.flac.samples  -= buf_free;
-   }
-}
-#endif
-
-#ifdef HAVE_DR_MP3
-static void audio_mixer_mix_mp3(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   struct resampler_data info = { 0 };
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
-
-   if (voice->types.mp3.position == voice->types.mp3.samples)
-   {
-again:
-      temp_samples = (unsigned)drmp3_read_f32(&voice->types.mp3.stream, AUDIO_MIXER_TEMP_BUFFER/2, temp_buffer) * 2;
-      
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            drmp3_seek_to_frame(&voice->types.mp3.stream,0);
-            goto again;
-         }
-         else
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-            voice->type = AUDIO_MIXER_TYPE_NONE;
-            return;
-         }
-      }
-
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.mp3.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.mp3.ratio;
-
-      if (voice->types.mp3.resampler)
-        voice->types.mp3.resampler->process(voice->types.mp3.resampler_data, &info);
-      else
-        memcpy(voice->types.mp3.buffer, temp_buffer, temp_samples * sizeof(float));
-      voice->types.mp3.position = 0;
-      voice->types.mp3.samples  = voice->types.mp3.buf_samples;
-   }
-
-   pcm = voice->types.mp3.buffer + voice->types.mp3.position;
-
-   if (voice->types.mp3.samples < buf_free)
-   {
-      for (i = voice->types.mp3.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      buf_free -= voice->types.mp3.samples;
-      goto again;
-   }
-   else
-   {
-      int i;
-      for (i = buf_free; i != 0; --i )
-         *buffer++ += *pcm++ * volume;
-
-      voice->types.mp3.position += buf_free;
-      voice->types.mp3.samples  -= buf_free;
-   }
-}
-#endif
-
 void audio_mixer_mix(float* buffer, size_t num_frames, float volume_override, bool override)
 {
    unsigned i;
-   size_t j                   = 0;
-   float* sample              = NULL;
    audio_mixer_voice_t* voice = s_voices;
 
 #ifdef HAVE_THREADS
@@ -1198,11 +1076,13 @@ void audio_mixer_mix(float* buffer, size_t num_frames, float volume_override, bo
       switch (voice->type)
       {
          case AUDIO_MIXER_TYPE_WAV:
-            audio_mixer_mix_wav(buffer, num_frames, voice, volume);
+            audio_mixer_mix_stream(buffer, num_frames, voice, volume,
+                  audio_mixer_decode_wav, audio_mixer_seek_start_wav);
             break;
          case AUDIO_MIXER_TYPE_OGG:
 #ifdef HAVE_STB_VORBIS
-            audio_mixer_mix_ogg(buffer, num_frames, voice, volume);
+            audio_mixer_mix_stream(buffer, num_frames, voice, volume,
+                  audio_mixer_decode_ogg, audio_mixer_seek_start_ogg);
 #endif
             break;
          case AUDIO_MIXER_TYPE_MOD:
@@ -1212,12 +1092,14 @@ void audio_mixer_mix(float* buffer, size_t num_frames, float volume_override, bo
             break;
          case AUDIO_MIXER_TYPE_FLAC:
 #ifdef HAVE_DR_FLAC
-            audio_mixer_mix_flac(buffer, num_frames, voice, volume);
+            audio_mixer_mix_stream(buffer, num_frames, voice, volume,
+                  audio_mixer_decode_flac, audio_mixer_seek_start_flac);
 #endif
             break;
             case AUDIO_MIXER_TYPE_MP3:
 #ifdef HAVE_DR_MP3
-            audio_mixer_mix_mp3(buffer, num_frames, voice, volume);
+            audio_mixer_mix_stream(buffer, num_frames, voice, volume,
+                  audio_mixer_decode_mp3, audio_mixer_seek_start_mp3);
 #endif
             break;
          case AUDIO_MIXER_TYPE_NONE:
@@ -1229,13 +1111,7 @@ void audio_mixer_mix(float* buffer, size_t num_frames, float volume_override, bo
    slock_unlock(s_locker);
 #endif
 
-   for (j = 0, sample = buffer; j < num_frames; j++, sample++)
-   {
-      if (*sample < -1.0f)
-         *sample = -1.0f;
-      else if (*sample > 1.0f)
-         *sample = 1.0f;
-   }
+   audio_mixer_clamp_samples(buffer, num_frames * 2);
 }
 
 float audio_mixer_voice_get_volume(audio_mixer_voice_t *voice)
@@ -48,8 +48,17 @@
  * NORMAL: 70 dB
  * HIGHER: 110 dB
  * HIGHEST: 140 dB
+ * POLYPHASE: 110 dB at integer ratios, ~70 dB otherwise
  */
 
+/* Upper bound for the interpolation factor of an
+ * integer resampling ratio (e.g. 48000 / 44100 = 160 / 147). */
+#define SINC_POLYPHASE_MAX_PHASES      1024
+/* Minimum size of the phase bank, so that truncating time to a phase
+ * stays accurate when dynamic rate control moves the ratio
+ * off the integer one. */
+#define SINC_POLYPHASE_MIN_PHASES      512
+
 /* TODO, make all this more configurable. */
 
 enum sinc_window
@@ -78,6 +87,18 @@ typedef struct rarch_sinc_resampler
    float kaiser_beta;
    enum sinc_window window_type;
 
+   /* Polyphase mode. The phase bank holds poly_phases
+    * precomputed filters and time is kept in units of
+    * poly_phases << poly_frac_bits. When the requested ratio
+    * rounds to the same step as poly_ratio, time advances by
+    * the integer poly_step and every output sample lands on a
+    * precomputed phase without drift. */
+   bool polyphase;
+   unsigned poly_phases;
+   unsigned poly_frac_bits;
+   uint32_t poly_step;
+   double poly_ratio;
+
    /* A buffer for phase_table, buffer_l and buffer_r
     * are created in a single calloc().
     * Ensure that we get as good cache locality as we can hope for. */
@@ -85,6 +106,9 @@ typedef struct rarch_sinc_resampler
    float *phase_table;
    float *buffer_l;
    float *buffer_r;
+
+   /* Kernel picked for this instance at creation time. */
+   void (*process)(void *re, struct resampler_data *data);
 } rarch_sinc_resampler_t;
 
 #if defined(__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
@@ -440,6 +464,269 @@ static void resampler_sinc_process_c(void *re_, struct resampler_data *data)
    data->output_frames = out_frames;
 }
 
+typedef void (*sinc_dot_t)(float *out, const float *left,
+      const float *right, const float *coeff, unsigned taps);
+
+static void sinc_dot_c(float *out, const float *left,
+      const float *right, const float *coeff, unsigned taps)
+{
+   unsigned i;
+   float sum_l = 0.0f;
+   float sum_r = 0.0f;
+
+   for (i = 0; i < taps; i++)
+   {
+      sum_l += left[i]  * coeff[i];
+      sum_r += right[i] * coeff[i];
+   }
+
+   out[0] = sum_l;
+   out[1] = sum_r;
+}
+
+#if defined(__SSE__)
+static void sinc_dot_sse(float *out, const float *left,
+      const float *right, const float *coeff, unsigned taps)
+{
+   unsigned i;
+   __m128 sum;
+   __m128 sum_l = _mm_setzero_ps();
+   __m128 sum_r = _mm_setzero_ps();
+
+   for (i = 0; i < taps; i += 4)
+   {
+      __m128 _sinc = _mm_load_ps(coeff + i);
+      sum_l        = _mm_add_ps(sum_l, _mm_mul_ps(_mm_loadu_ps(left + i), _sinc));
+      sum_r        = _mm_add_ps(sum_r, _mm_mul_ps(_mm_loadu_ps(right + i), _sinc));
+   }
+
+   /* Same horizontal reduction as resampler_sinc_process_sse. */
+   sum = _mm_add_ps(_mm_shuffle_ps(sum_l, sum_r,
+            _MM_SHUFFLE(1, 0, 1, 0)),
+         _mm_shuffle_ps(sum_l, sum_r, _MM_SHUFFLE(3, 2, 3, 2)));
+   sum = _mm_add_ps(_mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 1, 1)), sum);
+
+   _mm_store_ss(out + 0, sum);
+   _mm_store_ss(out + 1, _mm_movehl_ps(sum, sum));
+}
+#endif
+
+#if defined(__AVX__)
+static void sinc_dot_avx(float *out, const float *left,
+      const float *right, const float *coeff, unsigned taps)
+{
+   unsigned i;
+   __m256 res_l, res_r;
+   __m256 sum_l = _mm256_setzero_ps();
+   __m256 sum_r = _mm256_setzero_ps();
+
+   for (i = 0; i < taps; i += 8)
+   {
+      __m256 sinc  = _mm256_load_ps(coeff + i);
+      __m256 buf_l = _mm256_loadu_ps(left + i);
+      __m256 buf_r = _mm256_loadu_ps(right + i);
+#if defined(__FMA__)
+      /* AVX2-class CPUs: fused multiply-add halves the
+       * instruction count of the inner loop. */
+      sum_l        = _mm256_fmadd_ps(buf_l, sinc, sum_l);
+      sum_r        = _mm256_fmadd_ps(buf_r, sinc, sum_r);
+#else
+      sum_l        = _mm256_add_ps(sum_l, _mm256_mul_ps(buf_l, sinc));
+      sum_r        = _mm256_add_ps(sum_r, _mm256_mul_ps(buf_r, sinc));
+#endif
+   }
+
+   res_l = _mm256_hadd_ps(sum_l, sum_l);
+   res_r = _mm256_hadd_ps(sum_r, sum_r);
+   res_l = _mm256_hadd_ps(res_l, res_l);
+   res_r = _mm256_hadd_ps(res_r, res_r);
+   res_l = _mm256_add_ps(_mm256_permute2f128_ps(res_l, res_l, 1), res_l);
+   res_r = _mm256_add_ps(_mm256_permute2f128_ps(res_r, res_r, 1), res_r);
+
+   _mm_store_ss(out + 0, _mm256_extractf128_ps(res_l, 0));
+   _mm_store_ss(out + 1, _mm256_extractf128_ps(res_r, 0));
+}
+#endif
+
+static INLINE void resampler_sinc_process_polyphase(
+      rarch_sinc_resampler_t *resamp, struct resampler_data *data,
+      sinc_dot_t dot)
+{
+   uint32_t phases                = resamp->poly_phases << resamp->poly_frac_bits;
+   uint32_t step                  = (uint32_t)(phases / data->ratio);
+   uint32_t exact_step            = resamp->poly_step << resamp->poly_frac_bits;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   /* A ratio within rounding of poly_ratio gets the exact step,
+    * anything further away (e.g. dynamic rate control) keeps the
+    * truncated one. */
+   if (resamp->poly_step && step + 1 >= exact_step && step <= exact_step + 1)
+      step = exact_step;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!resamp->ptr)
+            resamp->ptr = resamp->taps;
+         resamp->ptr--;
+
+         resamp->buffer_l[resamp->ptr + resamp->taps] =
+         resamp->buffer_l[resamp->ptr]                = *input++;
+
+         resamp->buffer_r[resamp->ptr + resamp->taps] =
+         resamp->buffer_r[resamp->ptr]                = *input++;
+
+         resamp->time                                -= phases;
+         frames--;
+      }
+
+      while (resamp->time < phases)
+      {
+         unsigned phase = resamp->time >> resamp->poly_frac_bits;
+
+         dot(output,
+               resamp->buffer_l + resamp->ptr,
+               resamp->buffer_r + resamp->ptr,
+               resamp->phase_table + phase * resamp->taps,
+               resamp->taps);
+
+         output += 2;
+         out_frames++;
+         resamp->time += step;
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+
+static void resampler_sinc_process_polyphase_c(void *re_,
+      struct resampler_data *data)
+{
+   resampler_sinc_process_polyphase((rarch_sinc_resampler_t*)re_,
+         data, sinc_dot_c);
+}
+
+#if defined(__SSE__)
+static void resampler_sinc_process_polyphase_sse(void *re_,
+      struct resampler_data *data)
+{
+   resampler_sinc_process_polyphase((rarch_sinc_resampler_t*)re_,
+         data, sinc_dot_sse);
+}
+#endif
+
+#if defined(__AVX__)
+static void resampler_sinc_process_polyphase_avx(void *re_,
+      struct resampler_data *data)
+{
+   resampler_sinc_process_polyphase((rarch_sinc_resampler_t*)re_,
+         data, sinc_dot_avx);
+}
+#endif
+
+#if defined(WANT_NEON)
+static void resampler_sinc_process_polyphase_neon(void *re_,
+      struct resampler_data *data)
+{
+   resampler_sinc_process_polyphase((rarch_sinc_resampler_t*)re_,
+         data, process_sinc_neon_asm);
+}
+#endif
+
+/**
+ * sinc_polyphase_find_ratio:
+ * @ratio                : output rate / input rate.
+ * @num                  : numerator (interpolation factor).
+ * @den                  : denominator (decimation factor).
+ *
+ * Finds an exact integer representation num / den of @ratio
+ * with num <= SINC_POLYPHASE_MAX_PHASES using continued fractions.
+ *
+ * Returns: true if such a representation exists.
+ **/
+static bool sinc_polyphase_find_ratio(double ratio,
+      unsigned *num, unsigned *den)
+{
+   unsigned i;
+   double   x      = ratio;
+   uint64_t h_prev = 1;
+   uint64_t h      = (uint64_t)x;
+   uint64_t k_prev = 0;
+   uint64_t k      = 1;
+
+   for (i = 0; i < 16; i++)
+   {
+      double   frac;
+      uint64_t a, h_next, k_next;
+
+      if (h > SINC_POLYPHASE_MAX_PHASES)
+         return false;
+
+      if (fabs((double)h / k - ratio) <= ratio * 1e-12)
+      {
+         *num = (unsigned)h;
+         *den = (unsigned)k;
+         return h > 0;
+      }
+
+      frac = x - floor(x);
+      if (frac < 1e-12)
+         return false;
+
+      x      = 1.0 / frac;
+      a      = (uint64_t)x;
+      h_next = a * h + h_prev;
+      k_next = a * k + k_prev;
+      h_prev = h;
+      k_prev = k;
+      h      = h_next;
+      k      = k_next;
+   }
+
+   return false;
+}
+
+static void sinc_polyphase_init(rarch_sinc_resampler_t *re,
+      double ratio)
+{
+   unsigned num = 0;
+   unsigned den = 0;
+
+   re->poly_ratio = ratio;
+
+   if (sinc_polyphase_find_ratio(ratio, &num, &den))
+   {
+      /* Scale up so the bank also has enough phases
+       * for the truncated-phase path. */
+      unsigned k      = (SINC_POLYPHASE_MIN_PHASES + num - 1) / num;
+      re->poly_phases = num * k;
+      re->poly_step   = den * k;
+   }
+   else
+   {
+      re->poly_phases = SINC_POLYPHASE_MAX_PHASES;
+      re->poly_step   = 0;
+   }
+
+   /* Keep phases << frac_bits well inside 32 bits, even when
+    * downsampling by AUDIO_MAX_RATIO. */
+   re->poly_frac_bits = 0;
+   while ((re->poly_phases << (re->poly_frac_bits + 1)) <= (1u << 26))
+      re->poly_frac_bits++;
+}
+
+static void resampler_sinc_process(void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *re = (rarch_sinc_resampler_t*)re_;
+   if (re)
+      re->process(re_, data);
+}
+
 static void resampler_sinc_free(void *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)data;
@@ -615,6 +902,15 @@ static void *resampler_sinc_new(const struct resampler_config *config,
          re->kaiser_beta   = 14.5;
          re->enable_avx    = 1;
          break;
+      case RESAMPLER_QUALITY_POLYPHASE:
+         cutoff            = 0.90;
+         sidelobes         = 32;
+         re->window_type   = SINC_WINDOW_KAISER;
+         re->kaiser_beta   = 10.5;
+         re->enable_avx    = 1;
+         re->polyphase     = true;
+         sinc_polyphase_init(re, bandwidth_mod);
+         break;
       case RESAMPLER_QUALITY_NORMAL:
       case RESAMPLER_QUALITY_DONTCARE:
          cutoff            = 0.825;
@@ -653,9 +949,14 @@ static void *resampler_sinc_new(const struct resampler_config *config,
 #endif
    }
 
-   phase_elems     = ((1 << re->phase_bits) * re->taps);
-   if (re->window_type == SINC_WINDOW_KAISER)
-      phase_elems  = phase_elems * 2;
+   if (re->polyphase)
+      phase_elems  = re->poly_phases * re->taps;
+   else
+   {
+      phase_elems  = ((1 << re->phase_bits) * re->taps);
+      if (re->window_type == SINC_WINDOW_KAISER)
+         phase_elems  = phase_elems * 2;
+   }
    elems           = phase_elems + 4 * re->taps;
 
    re->main_buffer = (float*)memalign_alloc(128, sizeof(float) * elems);
@@ -666,6 +967,35 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    re->buffer_l    = re->main_buffer + phase_elems;
    re->buffer_r    = re->buffer_l + 2 * re->taps;
 
+   if (re->polyphase)
+   {
+      sinc_init_table_kaiser(re, cutoff, re->phase_table,
+            re->poly_phases, re->taps, false);
+
+      re->process = resampler_sinc_process_polyphase_c;
+
+      if (mask & RESAMPLER_SIMD_AVX)
+      {
+#if defined(__AVX__)
+         re->process = resampler_sinc_process_polyphase_avx;
+#endif
+      }
+      else if (mask & RESAMPLER_SIMD_SSE)
+      {
+#if defined(__SSE__)
+         re->process = resampler_sinc_process_polyphase_sse;
+#endif
+      }
+      else if (mask & RESAMPLER_SIMD_NEON)
+      {
+#if defined(WANT_NEON)
+         re->process = resampler_sinc_process_polyphase_neon;
+#endif
+      }
+
+      return re;
+   }
+
    switch (re->window_type)
    {
       case SINC_WINDOW_LANCZOS:
@@ -680,24 +1010,24 @@ static void *resampler_sinc_new(const struct resampler_config *config,
          goto error;
    }
 
-   sinc_resampler.process = resampler_sinc_process_c;
+   re->process = resampler_sinc_process_c;
 
    if (mask & RESAMPLER_SIMD_AVX && re->enable_avx)
    {
 #if defined(__AVX__)
-      sinc_resampler.process = resampler_sinc_process_avx;
+      re->process = resampler_sinc_process_avx;
 #endif
    }
    else if (mask & RESAMPLER_SIMD_SSE)
    {
 #if defined(__SSE__)
-      sinc_resampler.process = resampler_sinc_process_sse;
+      re->process = resampler_sinc_process_sse;
 #endif
    }
    else if (mask & RESAMPLER_SIMD_NEON && re->window_type != SINC_WINDOW_KAISER)
    {
 #if defined(WANT_NEON)
-      sinc_resampler.process = resampler_sinc_process_neon;
+      re->process = resampler_sinc_process_neon;
 #endif
    }
 
@@ -710,7 +1040,7 @@ error:
 
 retro_resampler_t sinc_resampler = {
    resampler_sinc_new,
-   resampler_sinc_process_c,
+   resampler_sinc_process,
    resampler_sinc_free,
    RESAMPLER_API_VERSION,
    "sinc",
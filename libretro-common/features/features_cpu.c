@@ -133,6 +133,16 @@ static int ra_clock_gettime(int clk_ik, struct timespec *t)
 
 #include <string.h>
 
+/* Sleep on an absolute CLOCK_MONOTONIC deadline wherever that is
+ * the clock cpu_features_get_time_usec() reads. */
+#if !defined(_WIN32) && !defined(__CELLOS_LV2__) && !defined(GEKKO) \
+   && !defined(SWITCH) && !defined(HAVE_LIBNX) && !defined(__MACH__) \
+   && defined(_POSIX_MONOTONIC_CLOCK) \
+   && defined(_POSIX_CLOCK_SELECTION) && (_POSIX_CLOCK_SELECTION > 0)
+#include <errno.h>
+#define HAVE_CLOCK_NANOSLEEP_ABS
+#endif
+
 /**
  * cpu_features_get_perf_counter:
  *
@@ -245,6 +255,40 @@ retro_time_t cpu_features_get_time_usec(void)
 #endif
 }
 
+/**
+ * cpu_features_sleep_until_usec:
+ * @deadline          : time to return at, as given by
+ *                      cpu_features_get_time_usec().
+ * @spin_usec         : how long before @deadline to stop
+ *                      sleeping and poll the clock instead.
+ *
+ * Waits until @deadline. Most of the wait is spent asleep, on an
+ * absolute timer where the platform has one so that a late wake-up
+ * does not carry over to the next deadline. The final @spin_usec
+ * absorb the scheduler's wake-up latency.
+ **/
+void cpu_features_sleep_until_usec(retro_time_t deadline,
+      retro_time_t spin_usec)
+{
+   retro_time_t wake = deadline - spin_usec;
+   retro_time_t now  = cpu_features_get_time_usec();
+
+   if (wake > now)
+   {
+#ifdef HAVE_CLOCK_NANOSLEEP_ABS
+      struct timespec tv;
+      tv.tv_sec  = wake / 1000000;
+      tv.tv_nsec = (wake % 1000000) * 1000;
+      while (clock_nanosleep(CLOCK_MONOTONIC,
+               TIMER_ABSTIME, &tv, NULL) == EINTR);
+#else
+      retro_sleep((unsigned)((wake - now) / 1000));
+#endif
+   }
+
+   while (cpu_features_get_time_usec() < deadline);
+}
+
 #if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__) || (defined(_M_X64) && _MSC_VER > 1310) || (defined(_M_IX86)  && _MSC_VER > 1310)
 #define CPU_X86
 #endif
@@ -46,6 +46,15 @@
 #include <lists/string_list.h>
 #include <string/stdstring.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+/* Number of archive directories kept parsed in memory */
+#define FILE_ARCHIVE_CACHE_SIZE 4
+/* Trailing bytes compared to tell whether a cached archive changed */
+#define FILE_ARCHIVE_CACHE_TAIL 64
+
 struct file_archive_file_data
 {
 #ifdef HAVE_MMAP
@@ -55,6 +64,25 @@ struct file_archive_file_data
    size_t size;
 };
 
+struct file_archive_cache_entry
+{
+   struct file_archive_index *index;
+   int64_t size;
+   unsigned stamp;
+   uint8_t tail[FILE_ARCHIVE_CACHE_TAIL];
+   char path[PATH_MAX_LENGTH];
+};
+
+typedef bool (*file_archive_index_cb_t)(
+      const struct file_archive_index *index, void *data);
+
+static struct file_archive_cache_entry
+   file_archive_cache[FILE_ARCHIVE_CACHE_SIZE];
+static unsigned file_archive_cache_stamp = 0;
+#ifdef HAVE_THREADS
+static slock_t *file_archive_cache_slock = NULL;
+#endif
+
 static size_t file_archive_size(file_archive_file_data_t *data)
 {
    if (!data)
@@ -152,6 +180,348 @@ error:
 }
 #endif
 
+void file_archive_index_free(struct file_archive_index *index)
+{
+   if (!index)
+      return;
+
+   free(index->entries);
+   free(index->sorted);
+   free(index->names);
+   free(index);
+}
+
+static int file_archive_index_cmp(const void *a, const void *b)
+{
+   const struct file_archive_index_entry *entry_a =
+      *(const struct file_archive_index_entry**)a;
+   const struct file_archive_index_entry *entry_b =
+      *(const struct file_archive_index_entry**)b;
+
+   return strcmp(entry_a->name, entry_b->name);
+}
+
+/* Sorting only pays off for an index that is kept around */
+static struct file_archive_index *file_archive_index_new(
+      const struct file_archive_file_backend *backend, const char *path,
+      bool sort)
+{
+   size_t i;
+   struct file_archive_index *index = backend->archive_index_new(path);
+
+   if (!index || !sort)
+      return index;
+
+   index->sorted = (struct file_archive_index_entry**)
+      malloc((index->count ? index->count : 1) * sizeof(*index->sorted));
+
+   if (!index->sorted)
+   {
+      file_archive_index_free(index);
+      return NULL;
+   }
+
+   for (i = 0; i < index->count; i++)
+      index->sorted[i] = &index->entries[i];
+
+   qsort(index->sorted, index->count, sizeof(*index->sorted),
+         file_archive_index_cmp);
+
+   return index;
+}
+
+/* Size and last bytes of the archive, which change
+ * whenever its directory does for the formats we index. */
+static bool file_archive_cache_stat(const char *path,
+      int64_t *size, uint8_t *tail)
+{
+   int64_t len;
+   bool ret    = false;
+   RFILE *file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   memset(tail, 0, FILE_ARCHIVE_CACHE_TAIL);
+
+   *size = filestream_get_size(file);
+   len   = MIN(*size, FILE_ARCHIVE_CACHE_TAIL);
+
+   if (*size >= 0
+         && filestream_seek(file, *size - len,
+            RETRO_VFS_SEEK_POSITION_START) >= 0
+         && filestream_read(file, tail, len) == len)
+      ret = true;
+
+   filestream_close(file);
+   return ret;
+}
+
+static struct file_archive_index *file_archive_cache_get(
+      const struct file_archive_file_backend *backend, const char *path,
+      int64_t size, const uint8_t *tail)
+{
+   unsigned i;
+   struct file_archive_cache_entry *slot = NULL;
+
+   for (i = 0; i < FILE_ARCHIVE_CACHE_SIZE; i++)
+   {
+      struct file_archive_cache_entry *entry = &file_archive_cache[i];
+
+      if (!entry->index || !string_is_equal(entry->path, path))
+         continue;
+
+      if (entry->size == size
+            && !memcmp(entry->tail, tail, FILE_ARCHIVE_CACHE_TAIL))
+         slot = entry;
+      else
+      {
+         /* Archive was modified since */
+         file_archive_index_free(entry->index);
+         entry->index = NULL;
+      }
+      break;
+   }
+
+   if (!slot)
+   {
+      struct file_archive_index *index = file_archive_index_new(backend, path, true);
+
+      if (!index)
+         return NULL;
+
+      /* Reuse an empty slot or evict the least recently used */
+      slot = &file_archive_cache[0];
+      for (i = 0; i < FILE_ARCHIVE_CACHE_SIZE; i++)
+      {
+         if (!file_archive_cache[i].index)
+         {
+            slot = &file_archive_cache[i];
+            break;
+         }
+         if (file_archive_cache[i].stamp < slot->stamp)
+            slot = &file_archive_cache[i];
+      }
+
+      file_archive_index_free(slot->index);
+      slot->index = index;
+      slot->size  = size;
+      memcpy(slot->tail, tail, FILE_ARCHIVE_CACHE_TAIL);
+      strlcpy(slot->path, path, sizeof(slot->path));
+   }
+
+   slot->stamp = ++file_archive_cache_stamp;
+   return slot->index;
+}
+
+/**
+ * file_archive_index_run:
+ * @path                         : filename path of archive
+ * @cb                           : called with the directory index
+ * @data                         : passed to @cb
+ *
+ * Runs @cb on the directory index of the archive, parsing it
+ * first unless a cached copy is still current. The index
+ * must not be used once @cb returns.
+ *
+ * Returns: what @cb returned, or false if the backend has
+ * no directory index or the archive could not be read.
+ **/
+static bool file_archive_index_run(const char *path,
+      file_archive_index_cb_t cb, void *data)
+{
+   char archive[PATH_MAX_LENGTH];
+   uint8_t tail[FILE_ARCHIVE_CACHE_TAIL];
+   int64_t size                                    = 0;
+   bool ret                                        = false;
+   char *delim                                     = NULL;
+   struct file_archive_index *index                = NULL;
+   const struct file_archive_file_backend *backend = NULL;
+
+   strlcpy(archive, path, sizeof(archive));
+
+   delim = (char*)path_get_archive_delim(archive);
+   if (delim)
+      *delim = '\0';
+
+   backend = file_archive_get_file_backend(archive);
+   if (!backend || !backend->archive_index_new)
+      return false;
+
+   if (!file_archive_cache_stat(archive, &size, tail))
+      return false;
+
+   /* No cache to share between threads */
+   if (!file_archive_cache_lock())
+   {
+      index = file_archive_index_new(backend, archive, false);
+      if (!index)
+         return false;
+
+      ret = cb(index, data);
+      file_archive_index_free(index);
+      return ret;
+   }
+
+   index = file_archive_cache_get(backend, archive, size, tail);
+   if (index)
+      ret = cb(index, data);
+
+   file_archive_cache_unlock();
+
+   return ret;
+}
+
+bool file_archive_cache_lock(void)
+{
+#ifdef HAVE_THREADS
+   if (!file_archive_cache_slock)
+      return false;
+   slock_lock(file_archive_cache_slock);
+#endif
+   return true;
+}
+
+void file_archive_cache_unlock(void)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(file_archive_cache_slock);
+#endif
+}
+
+void file_archive_cache_init(void)
+{
+#ifdef HAVE_THREADS
+   if (!file_archive_cache_slock)
+      file_archive_cache_slock = slock_new();
+#endif
+}
+
+void file_archive_cache_deinit(void)
+{
+   unsigned i;
+
+   for (i = 0; i < FILE_ARCHIVE_CACHE_SIZE; i++)
+   {
+      file_archive_index_free(file_archive_cache[i].index);
+      file_archive_cache[i].index = NULL;
+   }
+
+#ifdef HAVE_7ZIP
+   sevenzip_cache_free();
+#endif
+
+#ifdef HAVE_THREADS
+   if (file_archive_cache_slock)
+      slock_free(file_archive_cache_slock);
+   file_archive_cache_slock = NULL;
+#endif
+}
+
+void file_archive_cache_release(void)
+{
+#ifdef HAVE_7ZIP
+   if (!file_archive_cache_lock())
+      return;
+   sevenzip_cache_free();
+   file_archive_cache_unlock();
+#endif
+}
+
+struct file_archive_index_find_state
+{
+   const char *needle;
+   struct file_archive_index_entry *entry;
+   bool exact;
+};
+
+static bool file_archive_index_find_cb(
+      const struct file_archive_index *index, void *data)
+{
+   size_t i;
+   struct file_archive_index_find_state *state =
+      (struct file_archive_index_find_state*)data;
+   const struct file_archive_index_entry *found = NULL;
+
+   if (index->sorted)
+   {
+      struct file_archive_index_entry key;
+      struct file_archive_index_entry *keyp   = &key;
+      struct file_archive_index_entry **match = NULL;
+
+      key.name = state->needle;
+      match    = (struct file_archive_index_entry**)bsearch(&keyp,
+            index->sorted, index->count, sizeof(*index->sorted),
+            file_archive_index_cmp);
+
+      if (match)
+         found = *match;
+   }
+   else
+   {
+      for (i = 0; i < index->count; i++)
+      {
+         if (string_is_equal(index->entries[i].name, state->needle))
+         {
+            found = &index->entries[i];
+            break;
+         }
+      }
+   }
+
+   if (found)
+   {
+      *state->entry      = *found;
+      state->entry->name = NULL;
+      return true;
+   }
+
+   if (state->exact)
+      return false;
+
+   for (i = 0; i < index->count; i++)
+   {
+      const char *name = index->entries[i].name;
+      size_t len       = strlen(name);
+
+      /* Ignore directories. */
+      if (!len || name[len - 1] == '/' || name[len - 1] == '\\')
+         continue;
+
+      if (strstr(name, state->needle))
+      {
+         *state->entry      = index->entries[i];
+         state->entry->name = NULL;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+static bool file_archive_index_lookup(const char *path, const char *needle,
+      bool exact, struct file_archive_index_entry *entry)
+{
+   struct file_archive_index_find_state state;
+
+   if (!needle || !entry)
+      return false;
+
+   state.needle = needle;
+   state.entry  = entry;
+   state.exact  = exact;
+
+   return file_archive_index_run(path, file_archive_index_find_cb, &state);
+}
+
+bool file_archive_index_find(const char *path, const char *needle,
+      struct file_archive_index_entry *entry)
+{
+   return file_archive_index_lookup(path, needle, false, entry);
+}
+
 static int file_archive_get_file_list_cb(
       const char *path,
       const char *valid_exts,
@@ -584,6 +954,32 @@ end:
    return ret;
 }
 
+struct file_archive_list_state
+{
+   const char *valid_exts;
+   struct archive_extract_userdata *userdata;
+};
+
+static bool file_archive_get_file_list_index_cb(
+      const struct file_archive_index *index, void *data)
+{
+   size_t i;
+   struct file_archive_list_state *state =
+      (struct file_archive_list_state*)data;
+
+   for (i = 0; i < index->count; i++)
+   {
+      const struct file_archive_index_entry *entry = &index->entries[i];
+
+      if (!file_archive_get_file_list_cb(entry->name, state->valid_exts,
+               NULL, entry->cmode, entry->csize, entry->size,
+               entry->crc32, state->userdata))
+         break;
+   }
+
+   return true;
+}
+
 /**
  * file_archive_get_file_list:
  * @path                        : filename path of archive
@@ -594,6 +990,7 @@ struct string_list *file_archive_get_file_list(const char *path,
       const char *valid_exts)
 {
    int ret;
+   struct file_archive_list_state state;
    struct archive_extract_userdata userdata;
 
    strlcpy(userdata.archive_path, path, sizeof(userdata.archive_path));
@@ -618,6 +1015,13 @@ struct string_list *file_archive_get_file_list(const char *path,
    if (!userdata.list)
       goto error;
 
+   state.valid_exts = valid_exts;
+   state.userdata   = &userdata;
+
+   if (file_archive_index_run(path,
+            file_archive_get_file_list_index_cb, &state))
+      return userdata.list;
+
    ret = file_archive_walk(path, valid_exts,
          file_archive_get_file_list_cb, &userdata);
 
@@ -829,6 +1233,18 @@ const struct file_archive_file_backend* file_archive_get_file_backend(const char
    return NULL;
 }
 
+static bool file_archive_get_file_crc32_index_cb(
+      const struct file_archive_index *index, void *data)
+{
+   uint32_t *crc = (uint32_t*)data;
+
+   if (!index->count)
+      return false;
+
+   *crc = index->entries[0].crc32;
+   return true;
+}
+
 /**
  * file_archive_get_file_crc32:
  * @path                         : filename path of archive
@@ -860,6 +1276,24 @@ uint32_t file_archive_get_file_crc32(const char *path)
          archive_path += 1;
    }
 
+   if (backend->archive_index_new)
+   {
+      uint32_t crc = 0;
+
+      if (archive_path)
+      {
+         struct file_archive_index_entry entry;
+
+         if (file_archive_index_lookup(path, archive_path, true, &entry))
+            crc = entry.crc32;
+      }
+      else
+         file_archive_index_run(path,
+               file_archive_get_file_crc32_index_cb, &crc);
+
+      return crc;
+   }
+
    state.type          = ARCHIVE_TRANSFER_INIT;
    state.archive_size  = 0;
    state.handle        = NULL;
@@ -21,6 +21,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <boolean.h>
 #include <file/archive_file.h>
@@ -119,23 +120,81 @@ static void sevenzip_stream_free(void *data)
    File_Close(&sevenzip_context->archiveStream.file);
 }
 
-/* Extract the relative path (needle) from a 7z archive
- * (path) and allocate a buf for it to write it in.
- * If optional_outfile is set, extract to that instead
- * and don't allocate buffer.
+/* Decompressed solid blocks at most this big are kept for the next read */
+#if defined(PSP) || defined(_3DS) || defined(GEKKO) || defined(VITA) || defined(WIIU) || defined(_XBOX1)
+#define SEVENZIP_BLOCK_CACHE_MAX (16 * 1024 * 1024)
+#else
+#define SEVENZIP_BLOCK_CACHE_MAX (128 * 1024 * 1024)
+#endif
+/* Signature header, holds the CRC and location of the archive headers */
+#define SEVENZIP_SIGNATURE_HEADER_LEN 32
+
+struct sevenzip_block_cache
+{
+   char path[PATH_MAX_LENGTH];
+   uint8_t header[SEVENZIP_SIGNATURE_HEADER_LEN];
+   int64_t size;
+   uint32_t block_index;
+   uint8_t *output;
+   size_t output_size;
+};
+
+/* Most recently decompressed solid block, so that reading
+ * another file from it, like the next disc of a set, does
+ * not decompress the whole block again. */
+static struct sevenzip_block_cache sevenzip_block_cache;
+
+static bool sevenzip_block_cache_stat(const char *path,
+      int64_t *size, uint8_t *header)
+{
+   bool ret    = false;
+   RFILE *file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   *size = filestream_get_size(file);
+   if (filestream_read(file, header, SEVENZIP_SIGNATURE_HEADER_LEN)
+         == SEVENZIP_SIGNATURE_HEADER_LEN)
+      ret = true;
+
+   filestream_close(file);
+   return ret;
+}
+
+void sevenzip_cache_free(void)
+{
+   free(sevenzip_block_cache.output);
+   sevenzip_block_cache.output      = NULL;
+   sevenzip_block_cache.output_size = 0;
+}
+
+/* Extract the relative paths (needles) from a 7z archive
+ * (path) and allocate a buf for each to write it in.
+ * If outfiles is set, extract to those instead
+ * and don't allocate buffers.
  */
-static int sevenzip_file_read(
+static unsigned sevenzip_files_read(
       const char *path,
-      const char *needle, void **buf,
-      const char *optional_outfile)
+      const char **needles, void **bufs,
+      const char **outfiles,
+      int64_t *lengths, unsigned count)
 {
    CFileInStream archiveStream;
    CLookToRead lookStream;
    ISzAlloc allocImp;
    ISzAlloc allocTempImp;
    CSzArEx db;
+   uint8_t header[SEVENZIP_SIGNATURE_HEADER_LEN];
+   int64_t archive_size = 0;
+   bool cacheable       = false;
    uint8_t *output      = 0;
-   long outsize         = -1;
+   size_t output_size   = 0;
+   uint32_t block_index = 0xFFFFFFFF;
+   unsigned found       = 0;
+   unsigned read        = 0;
 
    /*These are the allocation routines.
     * Currently using the non-standard 7zip choices. */
@@ -155,7 +214,7 @@ static int sevenzip_file_read(
          if (InFile_OpenW(&archiveStream.file, pathW))
          {
             free(pathW);
-            return -1;
+            return 0;
          }
 
          free(pathW);
@@ -164,9 +223,27 @@ static int sevenzip_file_read(
 #else
    /* Could not open 7zip archive? */
    if (InFile_Open(&archiveStream.file, path))
-      return -1;
+      return 0;
 #endif
 
+   /* Pick up the cached block if it is from this same archive */
+   cacheable = sevenzip_block_cache_stat(path, &archive_size, header);
+   if (cacheable && file_archive_cache_lock())
+   {
+      if (     sevenzip_block_cache.output
+            && sevenzip_block_cache.size == archive_size
+            && string_is_equal(sevenzip_block_cache.path, path)
+            && !memcmp(sevenzip_block_cache.header, header, sizeof(header)))
+      {
+         block_index                      = sevenzip_block_cache.block_index;
+         output                           = sevenzip_block_cache.output;
+         output_size                      = sevenzip_block_cache.output_size;
+         sevenzip_block_cache.output      = NULL;
+         sevenzip_block_cache.output_size = 0;
+      }
+      file_archive_cache_unlock();
+   }
+
    FileInStream_CreateVTable(&archiveStream);
    LookToRead_CreateVTable(&lookStream, false);
    lookStream.realStream = &archiveStream.s;
@@ -196,18 +273,14 @@ static int sevenzip_file_read(
    if (SzArEx_Open(&db, &lookStream.s, &allocImp, &allocTempImp) == SZ_OK)
    {
       uint32_t i;
-      bool file_found      = false;
       uint16_t *temp       = NULL;
       size_t temp_size     = 0;
-      uint32_t block_index = 0xFFFFFFFF;
-      SRes res             = SZ_OK;
 
-      for (i = 0; i < db.db.NumFiles; i++)
+      for (i = 0; i < db.db.NumFiles && found < count; i++)
       {
+         unsigned k;
          size_t len;
          char infile[PATH_MAX_LENGTH];
-         size_t offset                = 0;
-         size_t outSizeProcessed      = 0;
          const CSzFileItem    *f      = db.db.Files + i;
 
          /* We skip over everything which is not a directory.
@@ -225,47 +298,54 @@ static int sevenzip_file_read(
             temp = (uint16_t *)malloc(temp_size * sizeof(temp[0]));
 
             if (temp == 0)
-            {
-               res = SZ_ERROR_MEM;
                break;
-            }
          }
 
          SzArEx_GetFileNameUtf16(&db, i, temp);
-         res       = SZ_ERROR_FAIL;
          infile[0] = '\0';
 
-         if (temp)
-            res = utf16_to_char_string(temp, infile, sizeof(infile))
-               ? SZ_OK : SZ_ERROR_FAIL;
+         if (!temp || !utf16_to_char_string(temp, infile, sizeof(infile)))
+            continue;
 
-         if (string_is_equal(infile, needle))
+         for (k = 0; k < count; k++)
          {
-            size_t output_size   = 0;
+            SRes res;
+            int64_t outsize         = -1;
+            size_t offset           = 0;
+            size_t outSizeProcessed = 0;
+
+            if (lengths[k] != -1 || !string_is_equal(infile, needles[k]))
+               continue;
 
             /* C LZMA SDK does not support chunked extraction - see here:
              * sourceforge.net/p/sevenzip/discussion/45798/thread/6fb59aaf/
-             * */
-            file_found = true;
+             *
+             * Files sharing a solid block reuse the one
+             * decompressed for the previous file. */
+            found++;
             res = SzArEx_Extract(&db, &lookStream.s, i, &block_index,
                   &output, &output_size, &offset, &outSizeProcessed,
                   &allocImp, &allocTempImp);
 
             if (res != SZ_OK)
-               break; /* This goes to the error section. */
+            {
+               /* Failed to open compressed file inside 7zip archive.
+                * Do not trust whatever is left in the buffer. */
+               IAlloc_Free(&allocImp, output);
+               output      = NULL;
+               output_size = 0;
+               block_index = 0xFFFFFFFF;
+               break;
+            }
 
             outsize = outSizeProcessed;
 
-            if (optional_outfile != NULL)
+            if (outfiles)
             {
                const void *ptr = (const void*)(output + offset);
 
-               if (!filestream_write_file(optional_outfile, ptr, outsize))
-               {
-                  res        = SZ_OK;
-                  file_found = true;
+               if (!filestream_write_file(outfiles[k], ptr, outsize))
                   outsize    = -1;
-               }
             }
             else
             {
@@ -274,32 +354,58 @@ static int sevenzip_file_read(
                 * We would however need to realloc anyways, because RetroArch
                 * expects a \0 at the end, therefore we allocate new,
                 * copy and free the old one. */
-               *buf = malloc(outsize + 1);
-               ((char*)(*buf))[outsize] = '\0';
-               memcpy(*buf,output + offset,outsize);
+               bufs[k] = malloc(outsize + 1);
+               ((char*)(bufs[k]))[outsize] = '\0';
+               memcpy(bufs[k], output + offset, outsize);
             }
+
+            lengths[k] = outsize;
+            if (outsize != -1)
+               read++;
             break;
          }
       }
 
       if (temp)
          free(temp);
-      IAlloc_Free(&allocImp, output);
-
-      if (!(file_found && res == SZ_OK))
-      {
-         /* Error handling
-          *
-          * Failed to open compressed file inside 7zip archive.
-          */
-
-         outsize    = -1;
-      }
    }
 
    SzArEx_Free(&db, &allocImp);
    File_Close(&archiveStream.file);
 
+   /* Keep the block for the next read, unless it is too big */
+   if (     output
+         && cacheable
+         && output_size <= SEVENZIP_BLOCK_CACHE_MAX
+         && file_archive_cache_lock())
+   {
+      IAlloc_Free(&allocImp, sevenzip_block_cache.output);
+      strlcpy(sevenzip_block_cache.path, path,
+            sizeof(sevenzip_block_cache.path));
+      memcpy(sevenzip_block_cache.header, header, sizeof(header));
+      sevenzip_block_cache.size        = archive_size;
+      sevenzip_block_cache.block_index = block_index;
+      sevenzip_block_cache.output      = output;
+      sevenzip_block_cache.output_size = output_size;
+      output                           = NULL;
+      file_archive_cache_unlock();
+   }
+
+   IAlloc_Free(&allocImp, output);
+
+   return read;
+}
+
+static int sevenzip_file_read(
+      const char *path,
+      const char *needle, void **buf,
+      const char *optional_outfile)
+{
+   int64_t outsize = -1;
+
+   sevenzip_files_read(path, &needle, buf,
+         optional_outfile ? &optional_outfile : NULL, &outsize, 1);
+
    return (int)outsize;
 }
 
@@ -512,5 +618,6 @@ const struct file_archive_file_backend sevenzip_backend = {
    sevenzip_file_read,
    sevenzip_parse_file_init,
    sevenzip_parse_file_iterate_step,
+   NULL,
    "7z"
 };
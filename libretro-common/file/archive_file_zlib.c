@@ -37,6 +37,10 @@
 #define CENTRAL_FILE_HEADER_SIGNATURE 0x02014b50
 #endif
 
+#ifndef LOCAL_FILE_HEADER_SIGNATURE
+#define LOCAL_FILE_HEADER_SIGNATURE 0x04034b50
+#endif
+
 #ifndef END_OF_CENTRAL_DIR_SIGNATURE
 #define END_OF_CENTRAL_DIR_SIGNATURE 0x06054b50
 #endif
@@ -153,7 +157,8 @@ static bool zip_file_decompressed_handle(
 #endif
 
    if (handle->stream)
-      free(handle->stream);
+      zlib_stream_free(handle->stream);
+   handle->stream = NULL;
 
    return true;
 #if 0
@@ -174,108 +179,207 @@ error:
  *
  * optional_outfile if not NULL will be used to extract the file to.
  * buf will be 0 then.
+ *
+ * The member is looked up in the cached central directory and
+ * read straight from its offset, without walking the archive.
  */
-
-static int zip_file_decompressed(
-      const char *name, const char *valid_exts,
-      const uint8_t *cdata, unsigned cmode,
-      uint32_t csize, uint32_t size,
-      uint32_t crc32, struct archive_extract_userdata *userdata)
+static int zip_file_read(
+      const char *path,
+      const char *needle, void **buf,
+      const char *optional_outfile)
 {
-   /* Ignore directories. */
-   if (name[strlen(name) - 1] == '/' || name[strlen(name) - 1] == '\\')
-      return 1;
+   struct file_archive_index_entry entry;
+   uint8_t header[30];
+   int ret         = -1;
+   uint8_t *cdata  = NULL;
+   uint8_t *data   = NULL;
+   RFILE *file     = NULL;
+
+   if (!file_archive_index_find(path, needle, &entry))
+      return -1;
+
+   file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return -1;
+
+   /* Skip the local file header, its name and extra
+    * field lengths can differ from the central directory. */
+   if (filestream_seek(file, entry.offset,
+            RETRO_VFS_SEEK_POSITION_START) < 0
+         || filestream_read(file, header, sizeof(header)) != sizeof(header)
+         || read_le(header, 4) != LOCAL_FILE_HEADER_SIGNATURE)
+      goto end;
 
-   if (strstr(name, userdata->decomp_state.needle))
+   if (filestream_seek(file, entry.offset + sizeof(header)
+            + read_le(header + 26, 2) + read_le(header + 28, 2),
+            RETRO_VFS_SEEK_POSITION_START) < 0)
+      goto end;
+
+   cdata = (uint8_t*)malloc(entry.csize ? entry.csize : 1);
+
+   if (!cdata || filestream_read(file, cdata, entry.csize) != entry.csize)
+      goto end;
+
+   if (entry.cmode == ARCHIVE_MODE_UNCOMPRESSED)
+   {
+      if (entry.csize != entry.size)
+         goto end;
+      data  = cdata;
+      cdata = NULL;
+   }
+   else
    {
-      bool goto_error = false;
       file_archive_file_handle_t handle = {0};
 
-      userdata->decomp_state.found = true;
+      if (!zip_file_decompressed_handle(&handle,
+               cdata, entry.csize, entry.size, entry.crc32))
+         goto end;
+      data = handle.data;
+   }
+
+   if (optional_outfile)
+   {
+      /* Called in case core has need_fullpath enabled. */
+      if (filestream_write_file(optional_outfile, data, entry.size))
+         ret = 0;
+      free(data);
+   }
+   else
+   {
+      /* Called in case core has need_fullpath disabled.
+       * Will hand the decompressed content directly to
+       * RetroArch as its ROM buffer. */
+      *buf = data;
+      ret  = (int)entry.size;
+   }
+
+end:
+   free(cdata);
+   filestream_close(file);
+   return ret;
+}
 
-      if (zip_file_decompressed_handle(&handle,
-               cdata, csize, size, crc32))
+/* Reads the central directory into an index, using only
+ * the end of the archive rather than the whole file. */
+static struct file_archive_index *zip_index_new(const char *path)
+{
+   uint32_t i, count, dir_offset, dir_size;
+   int64_t size, tail_size;
+   size_t names_len                 = 0;
+   const uint8_t *footer            = NULL;
+   const uint8_t *entry_ptr         = NULL;
+   uint8_t *tail                    = NULL;
+   uint8_t *dir                     = NULL;
+   struct file_archive_index *index = NULL;
+   RFILE *file                      = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return NULL;
+
+   size = filestream_get_size(file);
+   if (size < 22)
+      goto error;
+
+   /* End of central directory record plus the longest comment */
+   tail_size = MIN(size, 22 + 0xFFFF);
+   tail      = (uint8_t*)malloc((size_t)tail_size);
+
+   if (!tail
+         || filestream_seek(file, size - tail_size,
+            RETRO_VFS_SEEK_POSITION_START) < 0
+         || filestream_read(file, tail, tail_size) != tail_size)
+      goto error;
+
+   for (footer = tail + tail_size - 22; ; footer--)
+   {
+      if (read_le(footer, 4) == END_OF_CENTRAL_DIR_SIGNATURE)
       {
-         if (userdata->decomp_state.opt_file != 0)
-         {
-            /* Called in case core has need_fullpath enabled. */
-            char *buf       = (char*)malloc(size);
-
-            if (buf)
-            {
-               memcpy(buf, handle.data, size);
-
-               if (!filestream_write_file(userdata->decomp_state.opt_file, buf, size))
-                  goto_error = true;
-            }
-
-            free(buf);
-
-            userdata->decomp_state.size = 0;
-         }
-         else
-         {
-            /* Called in case core has need_fullpath disabled.
-             * Will copy decompressed content directly into
-             * RetroArch's ROM buffer. */
-            *userdata->decomp_state.buf = malloc(size);
-            memcpy(*userdata->decomp_state.buf, handle.data, size);
-
-            userdata->decomp_state.size = size;
-         }
+         unsigned comment_len = read_le(footer + 20, 2);
+         if (footer + 22 + comment_len == tail + tail_size)
+            break;
       }
+      if (footer == tail)
+         goto error;
+   }
 
-      if (handle.data)
-         free(handle.data);
+   count      = read_le(footer + 10, 2); /* total number of entries */
+   dir_size   = read_le(footer + 12, 4); /* size of central directory */
+   dir_offset = read_le(footer + 16, 4); /* offset of central directory */
 
-      if (goto_error)
-         return 0;
-   }
+   if ((int64_t)dir_offset + dir_size > size)
+      goto error;
 
-   return 1;
-}
+   dir = (uint8_t*)malloc(dir_size ? dir_size : 1);
 
-static int zip_file_read(
-      const char *path,
-      const char *needle, void **buf,
-      const char *optional_outfile)
-{
-   file_archive_transfer_t zlib             = {ARCHIVE_TRANSFER_NONE, 0, NULL, NULL, NULL, NULL, NULL, NULL };
-   struct archive_extract_userdata userdata = {{0}};
-   bool returnerr                           = true;
-   int ret                                  = 0;
+   if (!dir
+         || filestream_seek(file, dir_offset,
+            RETRO_VFS_SEEK_POSITION_START) < 0
+         || filestream_read(file, dir, dir_size) != dir_size)
+      goto error;
 
-   zlib.type                                = ARCHIVE_TRANSFER_INIT;
+   index = (struct file_archive_index*)calloc(1, sizeof(*index));
+   if (!index)
+      goto error;
 
-   userdata.decomp_state.needle             = NULL;
-   userdata.decomp_state.opt_file           = NULL;
-   userdata.decomp_state.found              = false;
-   userdata.decomp_state.buf                = buf;
+   index->entries = (struct file_archive_index_entry*)
+      calloc(count ? count : 1, sizeof(*index->entries));
+   /* Names take less than the directory itself, plus terminators */
+   index->names   = (char*)malloc(dir_size + count + 1);
 
-   if (needle)
-      userdata.decomp_state.needle          = strdup(needle);
-   if (optional_outfile)
-      userdata.decomp_state.opt_file        = strdup(optional_outfile);
+   if (!index->entries || !index->names)
+      goto error;
 
-   do
+   entry_ptr = dir;
+
+   for (i = 0; i < count; i++)
    {
-      ret = file_archive_parse_file_iterate(&zlib, &returnerr, path,
-            "", zip_file_decompressed, &userdata);
-      if (!returnerr)
+      uint32_t namelength, extralength, commentlength;
+      struct file_archive_index_entry *entry = &index->entries[i];
+
+      if (entry_ptr + 46 > dir + dir_size
+            || read_le(entry_ptr, 4) != CENTRAL_FILE_HEADER_SIGNATURE)
          break;
-   }while(ret == 0 && !userdata.decomp_state.found);
 
-   file_archive_parse_file_iterate_stop(&zlib);
+      namelength     = read_le(entry_ptr + 28, 2); /* file name length */
+      extralength    = read_le(entry_ptr + 30, 2); /* extra field length */
+      commentlength  = read_le(entry_ptr + 32, 2); /* file comment length */
 
-   if (userdata.decomp_state.opt_file)
-      free(userdata.decomp_state.opt_file);
-   if (userdata.decomp_state.needle)
-      free(userdata.decomp_state.needle);
+      if (namelength >= PATH_MAX_LENGTH
+            || entry_ptr + 46 + namelength > dir + dir_size)
+         break;
 
-   if (!userdata.decomp_state.found)
-      return -1;
+      entry->cmode   = read_le(entry_ptr + 10, 2); /* compression mode, 0 = store, 8 = deflate */
+      entry->crc32   = read_le(entry_ptr + 16, 4); /* CRC32 */
+      entry->csize   = read_le(entry_ptr + 20, 4); /* compressed size */
+      entry->size    = read_le(entry_ptr + 24, 4); /* uncompressed size */
+      entry->offset  = read_le(entry_ptr + 42, 4); /* relative offset of local file header */
+
+      memcpy(index->names + names_len, entry_ptr + 46, namelength);
+      index->names[names_len + namelength] = '\0';
+      entry->name    = index->names + names_len;
+      names_len     += namelength + 1;
+
+      entry_ptr     += 46 + namelength + extralength + commentlength;
+   }
 
-   return (int)userdata.decomp_state.size;
+   index->count = i;
+
+   free(dir);
+   free(tail);
+   filestream_close(file);
+   return index;
+
+error:
+   file_archive_index_free(index);
+   free(dir);
+   free(tail);
+   filestream_close(file);
+   return NULL;
 }
 
 static int zip_parse_file_init(file_archive_transfer_t *state,
@@ -380,5 +484,6 @@ const struct file_archive_file_backend zlib_backend = {
    zip_file_read,
    zip_parse_file_init,
    zip_parse_file_iterate_step,
+   zip_index_new,
    "zlib"
 };
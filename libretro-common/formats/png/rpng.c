@@ -29,6 +29,13 @@
 #include <malloc.h>
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RPNG_NEON
+#endif
+
 #include <boolean.h>
 #include <formats/image.h>
 #include <formats/rpng.h>
@@ -74,12 +81,6 @@ struct adam7_pass
    unsigned stride_y;
 };
 
-struct idat_buffer
-{
-   uint8_t *data;
-   size_t size;
-};
-
 struct png_chunk
 {
    uint32_t size;
@@ -124,7 +125,6 @@ struct rpng
    bool has_iend;
    bool has_plte;
    bool has_trns;
-   struct idat_buffer idat_buf;
    struct png_ihdr ihdr;
    uint8_t *buff_data;
    uint32_t palette[256];
@@ -231,11 +231,47 @@ end:
 static void png_reverse_filter_copy_line_rgb(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   unsigned i;
+   unsigned i = 0;
 
    bpp /= 8;
 
-   for (i = 0; i < width; i++)
+   if (bpp == 1)
+   {
+#if defined(__SSE2__)
+      const __m128i alpha = _mm_set1_epi32(0xff000000);
+      const __m128i green = _mm_set1_epi32(0x0000ff00);
+      const __m128i low   = _mm_set1_epi32(0x000000ff);
+
+      /* Loads 16 bytes to get 4 pixels, so stop early enough
+       * not to read past the end of the scanline. */
+      for (; i + 6 <= width; i += 4, decoded += 12)
+      {
+         __m128i v  = _mm_loadu_si128((const __m128i*)decoded);
+         __m128i p  = _mm_unpacklo_epi64(
+               _mm_unpacklo_epi32(v, _mm_srli_si128(v, 3)),
+               _mm_unpacklo_epi32(_mm_srli_si128(v, 6),
+                  _mm_srli_si128(v, 9)));
+         __m128i r  = _mm_slli_epi32(_mm_and_si128(p, low), 16);
+         __m128i b  = _mm_and_si128(_mm_srli_epi32(p, 16), low);
+         _mm_storeu_si128((__m128i*)(data + i), _mm_or_si128(
+                  _mm_or_si128(alpha, _mm_and_si128(p, green)),
+                  _mm_or_si128(r, b)));
+      }
+#elif defined(RPNG_NEON)
+      for (; i + 8 <= width; i += 8, decoded += 24)
+      {
+         uint8x8x3_t rgb = vld3_u8(decoded);
+         uint8x8x4_t bgra;
+         bgra.val[0]     = rgb.val[2];
+         bgra.val[1]     = rgb.val[1];
+         bgra.val[2]     = rgb.val[0];
+         bgra.val[3]     = vdup_n_u8(0xff);
+         vst4_u8((uint8_t*)(data + i), bgra);
+      }
+#endif
+   }
+
+   for (; i < width; i++)
    {
       uint32_t r, g, b;
 
@@ -252,11 +288,38 @@ static void png_reverse_filter_copy_line_rgb(uint32_t *data,
 static void png_reverse_filter_copy_line_rgba(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   unsigned i;
+   unsigned i = 0;
 
    bpp /= 8;
 
-   for (i = 0; i < width; i++)
+   if (bpp == 1)
+   {
+#if defined(__SSE2__)
+      const __m128i green_alpha = _mm_set1_epi32(0xff00ff00);
+      const __m128i low         = _mm_set1_epi32(0x000000ff);
+
+      /* Only red and blue trade places */
+      for (; i + 4 <= width; i += 4, decoded += 16)
+      {
+         __m128i p = _mm_loadu_si128((const __m128i*)decoded);
+         __m128i r = _mm_slli_epi32(_mm_and_si128(p, low), 16);
+         __m128i b = _mm_and_si128(_mm_srli_epi32(p, 16), low);
+         _mm_storeu_si128((__m128i*)(data + i), _mm_or_si128(
+                  _mm_and_si128(p, green_alpha), _mm_or_si128(r, b)));
+      }
+#elif defined(RPNG_NEON)
+      for (; i + 8 <= width; i += 8, decoded += 32)
+      {
+         uint8x8x4_t rgba = vld4_u8(decoded);
+         uint8x8_t   r    = rgba.val[0];
+         rgba.val[0]      = rgba.val[2];
+         rgba.val[2]      = r;
+         vst4_u8((uint8_t*)(data + i), rgba);
+      }
+#endif
+   }
+
+   for (; i < width; i++)
    {
       uint32_t r, g, b, a;
       r        = *decoded;
@@ -579,10 +642,166 @@ error:
    return -1;
 }
 
+#if defined(__SSE2__)
+static INLINE __m128i png_load_pixel(const uint8_t *p, unsigned bpp)
+{
+   uint32_t v = 0;
+   if (bpp == 4)
+      memcpy(&v, p, 4);
+   else
+      v = p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16);
+   return _mm_cvtsi32_si128((int)v);
+}
+
+static INLINE void png_store_pixel(uint8_t *p, __m128i x, unsigned bpp)
+{
+   uint32_t v = (uint32_t)_mm_cvtsi128_si32(x);
+   if (bpp == 4)
+      memcpy(p, &v, 4);
+   else
+   {
+      p[0] = (uint8_t)v;
+      p[1] = (uint8_t)(v >> 8);
+      p[2] = (uint8_t)(v >> 16);
+   }
+}
+
+static INLINE __m128i png_abs_epi16(__m128i x)
+{
+   return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+#endif
+
+/* The filters below reconstruct one scanline from
+ * its filtered bytes 'in' and the previous reconstructed
+ * scanline 'prev'. The SIMD paths work on one whole
+ * pixel per step for the common 24/32-bit formats,
+ * every other format goes through the scalar loops. */
+static void png_unfilter_sub(uint8_t *out, const uint8_t *in,
+      unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+
+#if defined(__SSE2__)
+   if (bpp == 3 || bpp == 4)
+   {
+      __m128i a = _mm_setzero_si128();
+
+      for (i = 0; i < pitch; i += bpp)
+      {
+         a = _mm_add_epi8(a, png_load_pixel(in + i, bpp));
+         png_store_pixel(out + i, a, bpp);
+      }
+      return;
+   }
+#endif
+
+   for (i = 0; i < bpp; i++)
+      out[i] = in[i];
+   for (i = bpp; i < pitch; i++)
+      out[i] = out[i - bpp] + in[i];
+}
+
+static void png_unfilter_up(uint8_t *out, const uint8_t *in,
+      const uint8_t *prev, unsigned pitch)
+{
+   unsigned i = 0;
+
+#if defined(__SSE2__)
+   for (; i + 16 <= pitch; i += 16)
+      _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi8(
+               _mm_loadu_si128((const __m128i*)(in + i)),
+               _mm_loadu_si128((const __m128i*)(prev + i))));
+#elif defined(RPNG_NEON)
+   for (; i + 16 <= pitch; i += 16)
+      vst1q_u8(out + i, vaddq_u8(vld1q_u8(in + i), vld1q_u8(prev + i)));
+#endif
+
+   for (; i < pitch; i++)
+      out[i] = prev[i] + in[i];
+}
+
+static void png_unfilter_avg(uint8_t *out, const uint8_t *in,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+
+#if defined(__SSE2__)
+   if (bpp == 3 || bpp == 4)
+   {
+      const __m128i one = _mm_set1_epi8(1);
+      __m128i a         = _mm_setzero_si128();
+
+      for (i = 0; i < pitch; i += bpp)
+      {
+         __m128i b   = png_load_pixel(prev + i, bpp);
+         /* _mm_avg_epu8 rounds up, PNG wants (a + b) >> 1 */
+         __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+               _mm_and_si128(_mm_xor_si128(a, b), one));
+         a           = _mm_add_epi8(avg, png_load_pixel(in + i, bpp));
+         png_store_pixel(out + i, a, bpp);
+      }
+      return;
+   }
+#endif
+
+   for (i = 0; i < bpp; i++)
+      out[i] = (prev[i] >> 1) + in[i];
+   for (i = bpp; i < pitch; i++)
+      out[i] = ((out[i - bpp] + prev[i]) >> 1) + in[i];
+}
+
+static void png_unfilter_paeth(uint8_t *out, const uint8_t *in,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+
+#if defined(__SSE2__)
+   if (bpp == 3 || bpp == 4)
+   {
+      const __m128i zero = _mm_setzero_si128();
+      __m128i a          = zero;
+      __m128i c          = zero;
+
+      /* Same predictor as paeth(), evaluated on 16-bit lanes */
+      for (i = 0; i < pitch; i += bpp)
+      {
+         __m128i b  = _mm_unpacklo_epi8(png_load_pixel(prev + i, bpp), zero);
+         __m128i pa = _mm_sub_epi16(b, c);
+         __m128i pb = _mm_sub_epi16(a, c);
+         __m128i pc = png_abs_epi16(_mm_add_epi16(pa, pb));
+         __m128i smallest, use_a, use_b, pred;
+
+         pa         = png_abs_epi16(pa);
+         pb         = png_abs_epi16(pb);
+         smallest   = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+         use_a      = _mm_cmpeq_epi16(smallest, pa);
+         use_b      = _mm_andnot_si128(use_a, _mm_cmpeq_epi16(smallest, pb));
+         pred       = _mm_or_si128(_mm_or_si128(
+                  _mm_and_si128(use_a, a), _mm_and_si128(use_b, b)),
+               _mm_andnot_si128(_mm_or_si128(use_a, use_b), c));
+
+         pred       = _mm_add_epi8(_mm_packus_epi16(pred, zero),
+               png_load_pixel(in + i, bpp));
+         png_store_pixel(out + i, pred, bpp);
+
+         a          = _mm_unpacklo_epi8(pred, zero);
+         c          = b;
+      }
+      return;
+   }
+#endif
+
+   for (i = 0; i < bpp; i++)
+      out[i] = paeth(0, prev[i], 0) + in[i];
+   for (i = bpp; i < pitch; i++)
+      out[i] = paeth(out[i - bpp], prev[i], prev[i - bpp]) + in[i];
+}
+
 static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *ihdr,
       struct rpng_process *pngp, unsigned filter)
 {
-   unsigned i;
+   uint8_t *swap = NULL;
 
    switch (filter)
    {
@@ -590,33 +809,20 @@ static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *i
          memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
          break;
       case PNG_FILTER_SUB:
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] = pngp->inflate_buf[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = pngp->decoded_scanline[i - pngp->bpp] + pngp->inflate_buf[i];
+         png_unfilter_sub(pngp->decoded_scanline, pngp->inflate_buf,
+               pngp->pitch, pngp->bpp);
          break;
       case PNG_FILTER_UP:
-         for (i = 0; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = pngp->prev_scanline[i] + pngp->inflate_buf[i];
+         png_unfilter_up(pngp->decoded_scanline, pngp->inflate_buf,
+               pngp->prev_scanline, pngp->pitch);
          break;
       case PNG_FILTER_AVERAGE:
-         for (i = 0; i < pngp->bpp; i++)
-         {
-            uint8_t avg = pngp->prev_scanline[i] >> 1;
-            pngp->decoded_scanline[i] = avg + pngp->inflate_buf[i];
-         }
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-         {
-            uint8_t avg = (pngp->decoded_scanline[i - pngp->bpp] + pngp->prev_scanline[i]) >> 1;
-            pngp->decoded_scanline[i] = avg + pngp->inflate_buf[i];
-         }
+         png_unfilter_avg(pngp->decoded_scanline, pngp->inflate_buf,
+               pngp->prev_scanline, pngp->pitch, pngp->bpp);
          break;
       case PNG_FILTER_PAETH:
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] = paeth(0, pngp->prev_scanline[i], 0) + pngp->inflate_buf[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = paeth(pngp->decoded_scanline[i - pngp->bpp],
-                  pngp->prev_scanline[i], pngp->prev_scanline[i - pngp->bpp]) + pngp->inflate_buf[i];
+         png_unfilter_paeth(pngp->decoded_scanline, pngp->inflate_buf,
+               pngp->prev_scanline, pngp->pitch, pngp->bpp);
          break;
 
       default:
@@ -644,7 +850,10 @@ static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *i
          break;
    }
 
-   memcpy(pngp->prev_scanline, pngp->decoded_scanline, pngp->pitch);
+   /* The line just decoded is the reference for the next one */
+   swap                   = pngp->prev_scanline;
+   pngp->prev_scanline    = pngp->decoded_scanline;
+   pngp->decoded_scanline = swap;
 
    return IMAGE_PROCESS_NEXT;
 }
@@ -860,17 +1069,6 @@ static bool png_read_trns(uint8_t *buf, uint32_t *palette, unsigned entries)
    return true;
 }
 
-bool png_realloc_idat(const struct png_chunk *chunk, struct idat_buffer *buf)
-{
-   uint8_t *new_buffer = (uint8_t*)realloc(buf->data, buf->size + chunk->size);
-
-   if (!new_buffer)
-      return false;
-
-   buf->data  = new_buffer;
-   return true;
-}
-
 static struct rpng_process *rpng_process_init(rpng_t *rpng, unsigned *width, unsigned *height)
 {
    uint8_t *inflate_buf         = NULL;
@@ -899,13 +1097,9 @@ static struct rpng_process *rpng_process_init(rpng_t *rpng, unsigned *width, uns
       goto error;
 
    process->inflate_buf = inflate_buf;
-   process->avail_in = rpng->idat_buf.size;
+   process->avail_in = 0;
    process->avail_out = process->inflate_buf_size;
    process->total_out = 0;
-   process->stream_backend->set_in(
-         process->stream,
-         rpng->idat_buf.data,
-         (uint32_t)rpng->idat_buf.size);
    process->stream_backend->set_out(
          process->stream,
          process->inflate_buf,
@@ -923,6 +1117,60 @@ error:
    return NULL;
 }
 
+/**
+ * rpng_inflate_idat:
+ * @rpng                : PNG handle.
+ * @buf                 : IDAT chunk payload.
+ * @size                : Size of @buf in bytes.
+ *
+ * Feeds one IDAT chunk straight into the inflate stream,
+ * so the compressed data never has to be gathered into
+ * a separate buffer first.
+ *
+ * Returns: true if the chunk was consumed, false on
+ * a corrupt stream.
+ **/
+static bool rpng_inflate_idat(rpng_t *rpng, const uint8_t *buf, uint32_t size)
+{
+   struct rpng_process *process = rpng->process;
+
+   if (!process)
+   {
+      process = rpng_process_init(rpng, NULL, NULL);
+      if (!process)
+         return false;
+      rpng->process = process;
+   }
+
+   process->stream_backend->set_in(process->stream, buf, size);
+   process->avail_in = size;
+
+   while (process->avail_in > 0 && process->avail_out > 0)
+   {
+      uint32_t rd                = 0;
+      uint32_t wn                = 0;
+      enum trans_stream_error terror = TRANS_STREAM_ERROR_NONE;
+      bool zstatus               = process->stream_backend->trans(
+            process->stream, false, &rd, &wn, &terror);
+
+      if (!zstatus && terror != TRANS_STREAM_ERROR_BUFFER_FULL)
+         return false;
+
+      process->avail_in  -= rd;
+      process->avail_out -= wn;
+      process->total_out += wn;
+
+      /* End of the zlib stream, anything after it is ignored */
+      if (terror == TRANS_STREAM_ERROR_NONE || (rd == 0 && wn == 0))
+         break;
+   }
+
+   /* Don't keep pointing into the chunk once we move past it */
+   process->avail_in = 0;
+
+   return true;
+}
+
 static bool read_chunk_header(uint8_t *buf, struct png_chunk *chunk)
 {
    unsigned i;
@@ -962,7 +1210,6 @@ static bool png_parse_ihdr(uint8_t *buf,
 
 bool rpng_iterate_image(rpng_t *rpng)
 {
-   unsigned i;
    struct png_chunk chunk;
    uint8_t *buf           = (uint8_t*)rpng->buff_data;
 
@@ -974,9 +1221,10 @@ bool rpng_iterate_image(rpng_t *rpng)
       return false;
 
 #if 0
-   for (i = 0; i < 4; i++)
    {
-      fprintf(stderr, "chunktype: %c\n", chunk.type[i]);
+      unsigned i;
+      for (i = 0; i < 4; i++)
+         fprintf(stderr, "chunktype: %c\n", chunk.type[i]);
    }
 #endif
 
@@ -1051,16 +1299,9 @@ bool rpng_iterate_image(rpng_t *rpng)
          if (!(rpng->has_ihdr) || rpng->has_iend || (rpng->ihdr.color_type == PNG_IHDR_COLOR_PLT && !(rpng->has_plte)))
             goto error;
 
-         if (!png_realloc_idat(&chunk, &rpng->idat_buf))
+         if (!rpng_inflate_idat(rpng, buf + 8, chunk.size))
             goto error;
 
-         buf += 8;
-
-         for (i = 0; i < chunk.size; i++)
-            rpng->idat_buf.data[i + rpng->idat_buf.size] = buf[i];
-
-         rpng->idat_buf.size += chunk.size;
-
          rpng->has_idat = true;
          break;
 
@@ -1117,6 +1358,7 @@ error:
       if (rpng->process->stream)
          rpng->process->stream_backend->stream_free(rpng->process->stream);
       free(rpng->process);
+      rpng->process = NULL;
    }
    return IMAGE_PROCESS_ERROR;
 }
@@ -1126,8 +1368,6 @@ void rpng_free(rpng_t *rpng)
    if (!rpng)
       return;
 
-   if (rpng->idat_buf.data)
-      free(rpng->idat_buf.data);
    if (rpng->process)
    {
       if (rpng->process->inflate_buf)
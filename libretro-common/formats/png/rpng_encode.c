@@ -23,10 +23,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
+#include <compat/zlib.h>
 #include <encodings/crc32.h>
+#include <retro_miscellaneous.h>
 #include <streams/file_stream.h>
-#include <streams/trans_stream.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "rpng_internal.h"
 
@@ -145,212 +151,388 @@ static void copy_bgr24_line(uint8_t *dst, const uint8_t *src, unsigned width)
    }
 }
 
-static unsigned count_sad(const uint8_t *data, size_t size)
+/* Filtered bytes are scored in chunks of this size so a
+ * candidate filter can be abandoned as soon as it is
+ * known to lose against the best one found so far. */
+#define RPNG_FILTER_CHUNK 64
+
+#define RPNG_ENCODE_MAX_BANDS 16
+/* Fewer rows than this per band costs more ratio
+ * than the extra thread wins back. */
+#define RPNG_ENCODE_MIN_BAND_ROWS 32
+
+struct rpng_encode_band
+{
+   const uint8_t *data;
+   const uint8_t *prev_data;
+   uint8_t *out;
+   size_t out_size;
+   size_t in_size;
+   uint32_t adler;
+   unsigned width;
+   unsigned rows;
+   unsigned pitch;
+   unsigned bpp;
+   unsigned level;
+   bool last;
+   bool ok;
+};
+
+#define PNG_SAD(x) ((unsigned)abs((int8_t)(x)))
+
+static unsigned filter_none(uint8_t *target, const uint8_t *line,
+      size_t len, unsigned bound)
 {
-   size_t i;
-   unsigned cnt = 0;
-   for (i = 0; i < size; i++)
+   size_t i     = 0;
+   unsigned sad = 0;
+
+   while (i < len && sad < bound)
    {
-      if (data[i])
-         cnt += abs((int8_t)data[i]);
+      size_t end = MIN(i + RPNG_FILTER_CHUNK, len);
+      for (; i < end; i++)
+         sad += PNG_SAD(target[i] = line[i]);
    }
-   return cnt;
+
+   return sad;
 }
 
 static unsigned filter_up(uint8_t *target, const uint8_t *line,
-      const uint8_t *prev, unsigned width, unsigned bpp)
+      const uint8_t *prev, size_t len, unsigned bound)
 {
-   unsigned i;
-   width *= bpp;
-   for (i = 0; i < width; i++)
-      target[i] = line[i] - prev[i];
+   size_t i     = 0;
+   unsigned sad = 0;
 
-   return count_sad(target, width);
+   while (i < len && sad < bound)
+   {
+      size_t end = MIN(i + RPNG_FILTER_CHUNK, len);
+      for (; i < end; i++)
+         sad += PNG_SAD(target[i] = line[i] - prev[i]);
+   }
+
+   return sad;
 }
 
 static unsigned filter_sub(uint8_t *target, const uint8_t *line,
-      unsigned width, unsigned bpp)
+      size_t len, unsigned bpp, unsigned bound)
 {
-   unsigned i;
-   width *= bpp;
-   for (i = 0; i < bpp; i++)
-      target[i] = line[i];
-   for (i = bpp; i < width; i++)
-      target[i] = line[i] - line[i - bpp];
+   size_t i     = 0;
+   unsigned sad = 0;
+
+   for (; i < bpp; i++)
+      sad += PNG_SAD(target[i] = line[i]);
+
+   while (i < len && sad < bound)
+   {
+      size_t end = MIN(i + RPNG_FILTER_CHUNK, len);
+      for (; i < end; i++)
+         sad += PNG_SAD(target[i] = line[i] - line[i - bpp]);
+   }
 
-   return count_sad(target, width);
+   return sad;
 }
 
 static unsigned filter_avg(uint8_t *target, const uint8_t *line,
-      const uint8_t *prev, unsigned width, unsigned bpp)
+      const uint8_t *prev, size_t len, unsigned bpp, unsigned bound)
 {
-   unsigned i;
-   width *= bpp;
-   for (i = 0; i < bpp; i++)
-      target[i] = line[i] - (prev[i] >> 1);
-   for (i = bpp; i < width; i++)
-      target[i] = line[i] - ((line[i - bpp] + prev[i]) >> 1);
+   size_t i     = 0;
+   unsigned sad = 0;
+
+   for (; i < bpp; i++)
+      sad += PNG_SAD(target[i] = line[i] - (prev[i] >> 1));
+
+   while (i < len && sad < bound)
+   {
+      size_t end = MIN(i + RPNG_FILTER_CHUNK, len);
+      for (; i < end; i++)
+         sad += PNG_SAD(target[i] = line[i] - ((line[i - bpp] + prev[i]) >> 1));
+   }
 
-   return count_sad(target, width);
+   return sad;
 }
 
 static unsigned filter_paeth(uint8_t *target,
       const uint8_t *line, const uint8_t *prev,
-      unsigned width, unsigned bpp)
+      size_t len, unsigned bpp, unsigned bound)
 {
-   unsigned i;
-   width *= bpp;
-   for (i = 0; i < bpp; i++)
-      target[i] = line[i] - paeth(0, prev[i], 0);
-   for (i = bpp; i < width; i++)
-      target[i] = line[i] - paeth(line[i - bpp], prev[i], prev[i - bpp]);
+   size_t i     = 0;
+   unsigned sad = 0;
+
+   for (; i < bpp; i++)
+      sad += PNG_SAD(target[i] = line[i] - paeth(0, prev[i], 0));
 
-   return count_sad(target, width);
+   while (i < len && sad < bound)
+   {
+      size_t end = MIN(i + RPNG_FILTER_CHUNK, len);
+      for (; i < end; i++)
+         sad += PNG_SAD(target[i] = line[i] - paeth(line[i - bpp],
+                  prev[i], prev[i - bpp]));
+   }
+
+   return sad;
 }
 
-static bool rpng_save_image(const char *path,
-      const uint8_t *data,
-      unsigned width, unsigned height, unsigned pitch, unsigned bpp)
+static unsigned png_filter_line(unsigned filter, uint8_t *target,
+      const uint8_t *line, const uint8_t *prev,
+      size_t len, unsigned bpp, unsigned bound)
+{
+   switch (filter)
+   {
+      case 1:
+         return filter_sub(target, line, len, bpp, bound);
+      case 2:
+         return filter_up(target, line, prev, len, bound);
+      case 3:
+         return filter_avg(target, line, prev, len, bpp, bound);
+      case 4:
+         return filter_paeth(target, line, prev, len, bpp, bound);
+      default:
+         break;
+   }
+
+   return filter_none(target, line, len, bound);
+}
+
+/**
+ * png_encode_band:
+ * @data                : Pointer to a struct rpng_encode_band.
+ *
+ * Filters and deflates one band of rows as raw deflate data.
+ * Every band but the last ends on a sync flush, so the bands
+ * can be joined back to back into a single zlib stream.
+ *
+ * The filter of every row is picked by the smallest sum of
+ * absolute differences, the lowest filter type winning ties.
+ * The filter that won the previous row is scored first and sets
+ * the bound the other candidates are abandoned at, since
+ * neighbouring rows usually pick the same.
+ **/
+static void png_encode_band(void *data)
 {
    unsigned h;
-   bool ret = true;
-   struct png_ihdr ihdr = {0};
+   z_stream z;
+   struct rpng_encode_band *band = (struct rpng_encode_band*)data;
+   size_t line_size              = band->width * band->bpp;
+   uint8_t *encode_buf           = NULL;
+   uint8_t *encode_target        = NULL;
+   uint8_t *lines                = NULL;
+   uint8_t *line                 = NULL;
+   uint8_t *prev                 = NULL;
+   uint8_t *candidate            = NULL;
+   unsigned filter               = 0;
+   const uint8_t *src            = band->data;
+
+   memset(&z, 0, sizeof(z));
+
+   band->ok       = false;
+   band->in_size  = (line_size + 1) * band->rows;
+   encode_buf     = (uint8_t*)malloc(band->in_size);
+   lines          = (uint8_t*)calloc(3, line_size);
+   if (!encode_buf || !lines)
+      goto end;
+
+   line           = lines;
+   prev           = lines + line_size;
+   candidate      = lines + line_size * 2;
+
+   /* Filters look at the row above, which belongs to the
+    * previous band everywhere but at the top of the image. */
+   if (band->prev_data)
+   {
+      if (band->bpp == sizeof(uint32_t))
+         copy_argb_line(prev, (const uint32_t*)band->prev_data, band->width);
+      else
+         copy_bgr24_line(prev, band->prev_data, band->width);
+   }
 
-   const struct trans_stream_backend *stream_backend = NULL;
-   size_t encode_buf_size  = 0;
-   uint8_t *encode_buf     = NULL;
-   uint8_t *deflate_buf    = NULL;
-   uint8_t *rgba_line      = NULL;
-   uint8_t *up_filtered    = NULL;
-   uint8_t *sub_filtered   = NULL;
-   uint8_t *avg_filtered   = NULL;
-   uint8_t *paeth_filtered = NULL;
-   uint8_t *prev_encoded   = NULL;
-   uint8_t *encode_target  = NULL;
-   void *stream            = NULL;
-   uint32_t total_in       = 0;
-   uint32_t total_out      = 0;
-   RFILE *file             = filestream_open(path,
-         RETRO_VFS_FILE_ACCESS_WRITE,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
-   if (!file)
-      GOTO_END_ERROR();
+   encode_target = encode_buf;
+   for (h = 0; h < band->rows; h++, src += band->pitch)
+   {
+      uint8_t *swap;
 
-   stream_backend = trans_stream_get_zlib_deflate_backend();
+      if (band->bpp == sizeof(uint32_t))
+         copy_argb_line(line, (const uint32_t*)src, band->width);
+      else
+         copy_bgr24_line(line, src, band->width);
 
-   if (filestream_write(file, png_magic, sizeof(png_magic)) != sizeof(png_magic))
-      GOTO_END_ERROR();
+      /* Level 0 only stores, filtering would be wasted work */
+      if (band->level == 0)
+         memcpy(encode_target + 1, line, line_size);
+      else
+      {
+         unsigned i;
+         unsigned chosen = filter;
+         unsigned best   = png_filter_line(filter, encode_target + 1,
+               line, prev, line_size, band->bpp, UINT_MAX);
 
-   ihdr.width = width;
-   ihdr.height = height;
-   ihdr.depth = 8;
-   ihdr.color_type = bpp == sizeof(uint32_t) ? 6 : 2; /* RGBA or RGB */
-   if (!png_write_ihdr(file, &ihdr))
-      GOTO_END_ERROR();
+         for (i = 0; i < 5; i++)
+         {
+            unsigned score;
+            /* Ties go to the lowest filter type, as when every
+             * filter was scored in order, so a lower one also
+             * wins on an equal score. */
+            unsigned bound = (i < filter) ? best + 1 : best;
+
+            if (i == chosen)
+               continue;
+
+            score = png_filter_line(i, candidate,
+                  line, prev, line_size, band->bpp, bound);
+
+            if (score < bound)
+            {
+               best   = score;
+               filter = i;
+               memcpy(encode_target + 1, candidate, line_size);
+            }
+         }
+      }
 
-   encode_buf_size = (width * bpp + 1) * height;
-   encode_buf = (uint8_t*)malloc(encode_buf_size);
-   if (!encode_buf)
-      GOTO_END_ERROR();
+      *encode_target = (uint8_t)filter;
+      encode_target += line_size + 1;
 
-   prev_encoded = (uint8_t*)calloc(1, width * bpp);
-   if (!prev_encoded)
-      GOTO_END_ERROR();
+      swap = prev;
+      prev = line;
+      line = swap;
+   }
 
-   rgba_line      = (uint8_t*)malloc(width * bpp);
-   up_filtered    = (uint8_t*)malloc(width * bpp);
-   sub_filtered   = (uint8_t*)malloc(width * bpp);
-   avg_filtered   = (uint8_t*)malloc(width * bpp);
-   paeth_filtered = (uint8_t*)malloc(width * bpp);
-   if (!rgba_line || !up_filtered || !sub_filtered || !avg_filtered || !paeth_filtered)
-      GOTO_END_ERROR();
+   band->adler    = (uint32_t)adler32(adler32(0L, Z_NULL, 0),
+         encode_buf, (uInt)band->in_size);
 
-   encode_target = encode_buf;
-   for (h = 0; h < height;
-         h++, encode_target += width * bpp, data += pitch)
-   {
-      if (bpp == sizeof(uint32_t))
-         copy_argb_line(rgba_line, (const uint32_t*)data, width);
-      else
-         copy_bgr24_line(rgba_line, data, width);
-
-      /* Try every filtering method, and choose the method
-       * which has most entries as zero.
-       *
-       * This is probably not very optimal, but it's very
-       * simple to implement.
-       */
-      {
-         unsigned none_score  = count_sad(rgba_line, width * bpp);
-         unsigned up_score    = filter_up(up_filtered, rgba_line, prev_encoded, width, bpp);
-         unsigned sub_score   = filter_sub(sub_filtered, rgba_line, width, bpp);
-         unsigned avg_score   = filter_avg(avg_filtered, rgba_line, prev_encoded, width, bpp);
-         unsigned paeth_score = filter_paeth(paeth_filtered, rgba_line, prev_encoded, width, bpp);
+   if (deflateInit2(&z, (int)band->level, Z_DEFLATED,
+            -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+      goto end;
 
-         uint8_t filter       = 0;
-         unsigned min_sad     = none_score;
-         const uint8_t *chosen_filtered = rgba_line;
+   band->out_size = deflateBound(&z, (uLong)band->in_size) + 16;
+   band->out      = (uint8_t*)malloc(band->out_size);
+   if (!band->out)
+      goto end;
 
-         if (sub_score < min_sad)
-         {
-            filter = 1;
-            chosen_filtered = sub_filtered;
-            min_sad = sub_score;
-         }
+   z.next_in      = encode_buf;
+   z.avail_in     = (uInt)band->in_size;
+   z.next_out     = band->out;
+   z.avail_out    = (uInt)band->out_size;
 
-         if (up_score < min_sad)
-         {
-            filter = 2;
-            chosen_filtered = up_filtered;
-            min_sad = up_score;
-         }
+   if (band->last)
+      band->ok    = deflate(&z, Z_FINISH) == Z_STREAM_END;
+   else
+      band->ok    = deflate(&z, Z_SYNC_FLUSH) == Z_OK && z.avail_in == 0;
 
-         if (avg_score < min_sad)
-         {
-            filter = 3;
-            chosen_filtered = avg_filtered;
-            min_sad = avg_score;
-         }
+   band->out_size = band->out_size - z.avail_out;
 
-         if (paeth_score < min_sad)
-         {
-            filter = 4;
-            chosen_filtered = paeth_filtered;
-         }
+end:
+   deflateEnd(&z);
+   free(encode_buf);
+   free(lines);
+}
 
-         *encode_target++ = filter;
-         memcpy(encode_target, chosen_filtered, width * bpp);
+static bool rpng_save_image(const char *path,
+      const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch, unsigned bpp,
+      unsigned level, unsigned threads)
+{
+   unsigned i, bands, rows;
+   size_t idat_size;
+   bool ret = true;
+   struct png_ihdr ihdr = {0};
+   struct rpng_encode_band band[RPNG_ENCODE_MAX_BANDS];
+#ifdef HAVE_THREADS
+   sthread_t *thread[RPNG_ENCODE_MAX_BANDS];
+#endif
+   uint8_t *idat_buf       = NULL;
+   uint8_t *idat_target    = NULL;
+   uint32_t adler          = 0;
+   RFILE *file             = NULL;
+
+   if (level > 9)
+      level = 9;
+
+   bands = MIN(threads, height / RPNG_ENCODE_MIN_BAND_ROWS);
+   bands = MIN(bands, RPNG_ENCODE_MAX_BANDS);
+   if (bands < 1)
+      bands = 1;
+   rows  = (height + bands - 1) / bands;
+   bands = (height + rows - 1) / rows;
+
+   memset(band, 0, sizeof(band));
+
+   for (i = 0; i < bands; i++)
+   {
+      band[i].data      = data + (size_t)i * rows * pitch;
+      band[i].prev_data = i ? band[i].data - pitch : NULL;
+      band[i].width     = width;
+      band[i].rows      = MIN(rows, height - i * rows);
+      band[i].pitch     = pitch;
+      band[i].bpp       = bpp;
+      band[i].level     = level;
+      band[i].last      = (i == bands - 1);
+   }
 
-         memcpy(prev_encoded, rgba_line, width * bpp);
-      }
+#ifdef HAVE_THREADS
+   /* The calling thread encodes the first band itself */
+   for (i = 1; i < bands; i++)
+      thread[i] = sthread_create(png_encode_band, &band[i]);
+   png_encode_band(&band[0]);
+   for (i = 1; i < bands; i++)
+   {
+      if (thread[i])
+         sthread_join(thread[i]);
+      else
+         png_encode_band(&band[i]);
+   }
+#else
+   for (i = 0; i < bands; i++)
+      png_encode_band(&band[i]);
+#endif
+
+   /* Chunk header, zlib header, bands, Adler-32 trailer */
+   idat_size = 8 + 2 + 4;
+   for (i = 0; i < bands; i++)
+   {
+      if (!band[i].ok)
+         GOTO_END_ERROR();
+      idat_size += band[i].out_size;
    }
 
-   deflate_buf = (uint8_t*)malloc(encode_buf_size * 2); /* Just to be sure. */
-   if (!deflate_buf)
+   idat_buf = (uint8_t*)malloc(idat_size);
+   if (!idat_buf)
       GOTO_END_ERROR();
 
-   stream = stream_backend->stream_new();
+   idat_target    = idat_buf + 8;
+   *idat_target++ = 0x78; /* Deflate, 32K window */
+   *idat_target   = (level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3) << 6;
+   *idat_target  += 31 - ((0x78 << 8) + *idat_target) % 31;
+   idat_target++;
+
+   adler = (uint32_t)adler32(0L, Z_NULL, 0);
+   for (i = 0; i < bands; i++)
+   {
+      memcpy(idat_target, band[i].out, band[i].out_size);
+      idat_target += band[i].out_size;
+      adler        = (uint32_t)adler32_combine(adler, band[i].adler,
+            (z_off_t)band[i].in_size);
+   }
+   dword_write_be(idat_target, adler);
 
-   if (!stream)
+   memcpy(idat_buf + 4, "IDAT", 4);
+   dword_write_be(idat_buf + 0, (uint32_t)(idat_size - 8));
+
+   file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   if (!file)
       GOTO_END_ERROR();
 
-   stream_backend->set_in(
-         stream,
-         encode_buf,
-         (unsigned)encode_buf_size);
-   stream_backend->set_out(
-         stream,
-         deflate_buf + 8,
-         (unsigned)(encode_buf_size * 2));
+   if (filestream_write(file, png_magic, sizeof(png_magic)) != sizeof(png_magic))
+      GOTO_END_ERROR();
 
-   if (!stream_backend->trans(stream, true, &total_in, &total_out, NULL))
-   {
+   ihdr.width = width;
+   ihdr.height = height;
+   ihdr.depth = 8;
+   ihdr.color_type = bpp == sizeof(uint32_t) ? 6 : 2; /* RGBA or RGB */
+   if (!png_write_ihdr(file, &ihdr))
       GOTO_END_ERROR();
-   }
 
-   memcpy(deflate_buf + 4, "IDAT", 4);
-   dword_write_be(deflate_buf + 0,        ((uint32_t)total_out));
-   if (!png_write_idat(file, deflate_buf, ((size_t)total_out + 8)))
+   if (!png_write_idat(file, idat_buf, idat_size))
       GOTO_END_ERROR();
 
    if (!png_write_iend(file))
@@ -359,23 +541,9 @@ static bool rpng_save_image(const char *path,
 end:
    if (file)
       filestream_close(file);
-   free(encode_buf);
-   free(deflate_buf);
-   free(rgba_line);
-   free(prev_encoded);
-   free(up_filtered);
-   free(sub_filtered);
-   free(avg_filtered);
-   free(paeth_filtered);
-
-   if (stream_backend)
-   {
-      if (stream)
-      {
-         if (stream_backend->stream_free)
-            stream_backend->stream_free(stream);
-      }
-   }
+   free(idat_buf);
+   for (i = 0; i < bands; i++)
+      free(band[i].out);
    return ret;
 }
 
@@ -383,12 +551,20 @@ bool rpng_save_image_argb(const char *path, const uint32_t *data,
       unsigned width, unsigned height, unsigned pitch)
 {
    return rpng_save_image(path, (const uint8_t*)data,
-         width, height, pitch, sizeof(uint32_t));
+         width, height, pitch, sizeof(uint32_t), 9, 1);
 }
 
 bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
       unsigned width, unsigned height, unsigned pitch)
 {
    return rpng_save_image(path, (const uint8_t*)data,
-         width, height, pitch, 3);
+         width, height, pitch, 3, 9, 1);
+}
+
+bool rpng_save_image_bgr24_fast(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch,
+      unsigned level, unsigned threads)
+{
+   return rpng_save_image(path, data,
+         width, height, pitch, 3, level, threads);
 }
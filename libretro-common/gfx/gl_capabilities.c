@@ -324,6 +324,19 @@ bool gl_check_capability(enum gl_capability_enum enum_idx)
 #else
          if (gl_query_extension("EXT_texture_storage"))
             return true;
+#endif
+         break;
+      case GL_CAPS_PROGRAM_BINARY:
+#ifdef HAVE_OPENGLES
+#ifdef HAVE_OPENGLES3
+         if (major >= 3)
+            return true;
+#endif
+#else
+         if (     (major > 4 || (major == 4 && minor >= 1)
+                  || gl_query_extension("ARB_get_program_binary"))
+               && glGetProgramBinary && glProgramBinary)
+            return true;
 #endif
          break;
       case GL_CAPS_NONE:
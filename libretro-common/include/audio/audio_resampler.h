@@ -54,7 +54,10 @@ enum resampler_quality
    RESAMPLER_QUALITY_LOWER,
    RESAMPLER_QUALITY_NORMAL,
    RESAMPLER_QUALITY_HIGHER,
-   RESAMPLER_QUALITY_HIGHEST
+   RESAMPLER_QUALITY_HIGHEST,
+   /* Precomputed polyphase filter bank, exact
+    * for integer ratios such as 44100 -> 48000. */
+   RESAMPLER_QUALITY_POLYPHASE
 };
 
 /* A bit-mask of all supported SIMD instruction sets.
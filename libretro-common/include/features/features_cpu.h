@@ -50,6 +50,18 @@ retro_perf_tick_t cpu_features_get_perf_counter(void);
  **/
 retro_time_t cpu_features_get_time_usec(void);
 
+/**
+ * cpu_features_sleep_until_usec:
+ * @deadline          : time to return at, as given by
+ *                      cpu_features_get_time_usec().
+ * @spin_usec         : how long before @deadline to stop
+ *                      sleeping and poll the clock instead.
+ *
+ * Waits until @deadline with sub-millisecond precision.
+ **/
+void cpu_features_sleep_until_usec(retro_time_t deadline,
+      retro_time_t spin_usec);
+
 /**
  * cpu_features_get:
  *
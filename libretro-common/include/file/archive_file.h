@@ -119,6 +119,30 @@ struct archive_extract_userdata
    decompress_state_t *dec;
 };
 
+struct file_archive_index_entry
+{
+   /* Name within the archive, NULL in copies handed out */
+   const char *name;
+   /* Backend specific location, the local header offset for zip */
+   uint32_t offset;
+   uint32_t csize;
+   uint32_t size;
+   uint32_t crc32;
+   unsigned cmode;
+};
+
+/* Directory of an archive, parsed once and cached across calls */
+struct file_archive_index
+{
+   /* In the order stored in the archive */
+   struct file_archive_index_entry *entries;
+   /* The same entries sorted by name, NULL if the index is not cached */
+   struct file_archive_index_entry **sorted;
+   /* Storage for the entry names */
+   char *names;
+   size_t count;
+};
+
 /* Returns true when parsing should continue. False to stop. */
 typedef int (*file_archive_file_cb)(const char *name, const char *valid_exts,
       const uint8_t *cdata, unsigned cmode, uint32_t csize, uint32_t size,
@@ -142,6 +166,8 @@ struct file_archive_file_backend
       const char *valid_exts,
       struct archive_extract_userdata *userdata,
       file_archive_file_cb file_cb);
+   /* Optional, reads the directory of an archive into an index */
+   struct file_archive_index *(*archive_index_new)(const char *path);
    const char *ident;
 };
 
@@ -207,9 +233,65 @@ const struct file_archive_file_backend* file_archive_get_file_backend(const char
  **/
 uint32_t file_archive_get_file_crc32(const char *path);
 
+/**
+ * file_archive_index_find:
+ * @path                         : filename path of archive
+ * @needle                       : file to look for within the archive
+ * @entry                        : filled in with the entry found
+ *
+ * Looks @needle up in the cached directory of the archive.
+ * An exact name match is preferred, otherwise the first file
+ * whose name contains @needle is used.
+ *
+ * Returns: true if found, false if not or the backend of
+ * @path has no directory index.
+ **/
+bool file_archive_index_find(const char *path, const char *needle,
+      struct file_archive_index_entry *entry);
+
+void file_archive_index_free(struct file_archive_index *index);
+
+/**
+ * file_archive_cache_init:
+ *
+ * Sets up the cache of archive directories. With threads
+ * enabled, directories are parsed again on each call until
+ * this has been called.
+ **/
+void file_archive_cache_init(void);
+
+void file_archive_cache_deinit(void);
+
+/**
+ * file_archive_cache_release:
+ *
+ * Frees the decompressed data archive backends keep for
+ * later reads, once nothing more is expected to be read.
+ * Archive directories stay cached.
+ **/
+void file_archive_cache_release(void);
+
+/**
+ * file_archive_cache_lock:
+ *
+ * Serializes access to what archive backends keep
+ * between calls.
+ *
+ * Returns: false if nothing may be cached, in which case
+ * file_archive_cache_unlock() must not be called.
+ **/
+bool file_archive_cache_lock(void);
+
+void file_archive_cache_unlock(void);
+
 extern const struct file_archive_file_backend zlib_backend;
 extern const struct file_archive_file_backend sevenzip_backend;
 
+#ifdef HAVE_7ZIP
+/* Frees the solid block the 7z backend keeps decompressed */
+void sevenzip_cache_free(void);
+#endif
+
 RETRO_END_DECLS
 
 #endif
@@ -56,6 +56,12 @@ bool rpng_save_image_argb(const char *path, const uint32_t *data,
 bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
       unsigned width, unsigned height, unsigned pitch);
 
+/* Splits the image in up to @threads bands of rows which are
+ * filtered and deflated in parallel at zlib @level (0-9). */
+bool rpng_save_image_bgr24_fast(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch,
+      unsigned level, unsigned threads);
+
 RETRO_END_DECLS
 
 #endif
@@ -27,6 +27,7 @@
 #include <stddef.h>
 
 #include <retro_common_api.h>
+#include <boolean.h>
 
 RETRO_BEGIN_DECLS
 
@@ -57,6 +58,13 @@ int64_t chdstream_seek(chdstream_t *stream, int64_t offset, int whence);
 
 ssize_t chdstream_get_size(chdstream_t *stream);
 
+/* Receives track data from chdstream_process(). Return false to stop. */
+typedef bool (*chdstream_data_cb_t)(const uint8_t *data, size_t len,
+      void *userdata);
+
+bool chdstream_process(chdstream_t *stream, unsigned threads,
+      chdstream_data_cb_t cb, void *userdata);
+
 RETRO_END_DECLS
 
 #endif
@@ -0,0 +1,172 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (resampler_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Compares throughput and passband ripple of the sinc
+ * resampler quality levels for common emulator rates. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include <audio/audio_resampler.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define CHUNK_FRAMES    1024
+#define BENCH_SECONDS   10
+#define RIPPLE_TONES    24
+
+static const char *quality_names[] = {
+   "dontcare", "lowest", "lower", "normal",
+   "higher", "highest", "polyphase"
+};
+
+static double bench_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static resampler_simd_mask_t bench_simd_mask(void)
+{
+   resampler_simd_mask_t mask = 0;
+#if defined(__AVX__)
+   mask |= RESAMPLER_SIMD_AVX;
+#endif
+#if defined(__SSE__)
+   mask |= RESAMPLER_SIMD_SSE;
+#endif
+#if defined(__ARM_NEON__)
+   mask |= RESAMPLER_SIMD_NEON;
+#endif
+   return mask;
+}
+
+/* Resamples a full-scale tone and returns its output gain in dB,
+ * measured once the filter has settled. */
+static double measure_gain(enum resampler_quality quality,
+      double in_rate, double out_rate, double freq)
+{
+   unsigned i;
+   struct resampler_data data;
+   double ratio     = out_rate / in_rate;
+   size_t in_frames = (size_t)in_rate / 2;
+   float *in        = (float*)malloc(in_frames * 2 * sizeof(float));
+   float *out       = (float*)malloc((size_t)(in_frames * ratio + 16) * 2 * sizeof(float));
+   void *re         = sinc_resampler.init(NULL, ratio, quality, bench_simd_mask());
+   double sum       = 0.0;
+   size_t skip;
+
+   for (i = 0; i < in_frames; i++)
+      in[2 * i] = in[2 * i + 1] = (float)sin(2.0 * M_PI * freq * i / in_rate);
+
+   data.data_in      = in;
+   data.data_out     = out;
+   data.input_frames = in_frames;
+   data.ratio        = ratio;
+   sinc_resampler.process(re, &data);
+
+   skip = data.output_frames / 4;
+   for (i = skip; i < data.output_frames; i++)
+      sum += out[2 * i] * out[2 * i];
+
+   sinc_resampler.free(re);
+   free(in);
+   free(out);
+
+   return 10.0 * log10(2.0 * sum / (data.output_frames - skip));
+}
+
+static void run_bench(double in_rate, double out_rate,
+      enum resampler_quality quality)
+{
+   unsigned i;
+   struct resampler_data data;
+   double start, elapsed;
+   double min_db        = 1e9;
+   double max_db        = -1e9;
+   double ratio         = out_rate / in_rate;
+   unsigned chunks      = (unsigned)(in_rate * BENCH_SECONDS / CHUNK_FRAMES);
+   float *in            = (float*)calloc(CHUNK_FRAMES * 2, sizeof(float));
+   float *out           = (float*)calloc((CHUNK_FRAMES * 2 + 16) * 2, sizeof(float));
+   void *re             = sinc_resampler.init(NULL, ratio, quality, bench_simd_mask());
+
+   if (!re || !in || !out)
+   {
+      fprintf(stderr, "Failed to create resampler.\n");
+      exit(1);
+   }
+
+   for (i = 0; i < CHUNK_FRAMES * 2; i++)
+      in[i] = (float)rand() / RAND_MAX - 0.5f;
+
+   data.data_in      = in;
+   data.data_out     = out;
+   data.input_frames = CHUNK_FRAMES;
+   data.ratio        = ratio;
+
+   start = bench_time();
+   for (i = 0; i < chunks; i++)
+      sinc_resampler.process(re, &data);
+   elapsed = bench_time() - start;
+
+   sinc_resampler.free(re);
+   free(in);
+   free(out);
+
+   /* Passband: 20 Hz up to 40% of the input rate. */
+   for (i = 0; i < RIPPLE_TONES; i++)
+   {
+      double freq = 20.0 + (0.40 * in_rate - 20.0) * i / (RIPPLE_TONES - 1);
+      double db   = measure_gain(quality, in_rate, out_rate, freq);
+      if (db < min_db)
+         min_db = db;
+      if (db > max_db)
+         max_db = db;
+   }
+
+   printf("%6.0f -> %6.0f  %-10s %8.1fx realtime  ripple %.4f dB\n",
+         in_rate, out_rate, quality_names[quality],
+         BENCH_SECONDS / elapsed, max_db - min_db);
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i, q;
+   static const double rates[][2] = {
+      { 32040.0, 48000.0 },
+      { 44100.0, 48000.0 },
+      { 48000.0, 44100.0 },
+      /* Off-integer ratio, as produced by dynamic rate control. */
+      { 44100.0 * 60.0 / 59.94, 48000.0 },
+   };
+
+   for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+      for (q = RESAMPLER_QUALITY_LOWEST; q <= RESAMPLER_QUALITY_POLYPHASE; q++)
+         run_bench(rates[i][0], rates[i][1], (enum resampler_quality)q);
+
+   return 0;
+}
@@ -0,0 +1,160 @@
+/* Copyright  (C) 2010-2017 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rpng_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Decodes a set of PNG files (e.g. a folder of boxart
+ * thumbnails) over and over and reports the decode speed.
+ *
+ * Usage: rpng_bench [-n iterations] <png file>... */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <formats/rpng.h>
+#include <formats/image.h>
+
+static bool rpng_bench_decode(uint8_t *buf, size_t len,
+      unsigned *width, unsigned *height)
+{
+   int retval;
+   bool ret        = false;
+   uint32_t *data  = NULL;
+   rpng_t *rpng    = rpng_alloc();
+
+   if (!rpng)
+      return false;
+
+   if (!rpng_set_buf_ptr(rpng, buf) || !rpng_start(rpng))
+      goto end;
+
+   while (rpng_iterate_image(rpng));
+
+   if (!rpng_is_valid(rpng))
+      goto end;
+
+   do
+   {
+      retval = rpng_process_image(rpng,
+            (void**)&data, len, width, height);
+   }while (retval == IMAGE_PROCESS_NEXT);
+
+   ret = (retval != IMAGE_PROCESS_ERROR && retval != IMAGE_PROCESS_ERROR_END);
+
+end:
+   rpng_free(rpng);
+   free(data);
+   return ret;
+}
+
+static uint8_t *rpng_bench_read_file(const char *path, size_t *len)
+{
+   long size;
+   uint8_t *buf = NULL;
+   FILE *file   = fopen(path, "rb");
+
+   if (!file)
+      return NULL;
+
+   fseek(file, 0, SEEK_END);
+   size = ftell(file);
+   fseek(file, 0, SEEK_SET);
+
+   if (size > 0)
+      buf = (uint8_t*)malloc(size);
+
+   if (buf && fread(buf, 1, size, file) != (size_t)size)
+   {
+      free(buf);
+      buf = NULL;
+   }
+
+   fclose(file);
+   *len = (size_t)size;
+   return buf;
+}
+
+int main(int argc, char *argv[])
+{
+   int i, first     = 1;
+   unsigned j;
+   unsigned iters   = 20;
+   unsigned images  = 0;
+   double pixels    = 0.0;
+   double seconds   = 0.0;
+
+   if (argc > 2 && !strcmp(argv[1], "-n"))
+   {
+      iters = (unsigned)strtoul(argv[2], NULL, 0);
+      first = 3;
+   }
+
+   if (first >= argc || iters == 0)
+   {
+      fprintf(stderr, "Usage: %s [-n iterations] <png file>...\n", argv[0]);
+      return 1;
+   }
+
+   for (i = first; i < argc; i++)
+   {
+      size_t len;
+      clock_t start;
+      unsigned width  = 0;
+      unsigned height = 0;
+      uint8_t *buf    = rpng_bench_read_file(argv[i], &len);
+
+      if (!buf)
+      {
+         fprintf(stderr, "Could not read %s.\n", argv[i]);
+         continue;
+      }
+
+      start = clock();
+      for (j = 0; j < iters; j++)
+      {
+         if (!rpng_bench_decode(buf, len, &width, &height))
+         {
+            fprintf(stderr, "Could not decode %s.\n", argv[i]);
+            break;
+         }
+      }
+
+      if (j == iters)
+      {
+         seconds += (double)(clock() - start) / CLOCKS_PER_SEC;
+         pixels  += (double)width * height * iters;
+         images++;
+      }
+
+      free(buf);
+   }
+
+   if (!images || seconds <= 0.0)
+      return 1;
+
+   printf("%u images, %u iterations: %.3f ms/image, %.1f Mpixels/s\n",
+         images, iters, seconds * 1000.0 / (images * iters),
+         pixels / seconds / 1000000.0);
+
+   return 0;
+}
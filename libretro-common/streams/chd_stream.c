@@ -28,15 +28,40 @@
 
 #include <streams/chd_stream.h>
 #include <retro_endianness.h>
+#include <retro_miscellaneous.h>
 #include <libchdr/chd.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #define SECTOR_SIZE 2352
 #define SUBCODE_SIZE 96
 #define TRACK_PAD 4
 
+/* Number of decompressed hunks kept around */
+#define CHDSTREAM_CACHE_SIZE 8
+/* Number of hunks decompressed ahead of a sequential reader */
+#define CHDSTREAM_READAHEAD 2
+/* Upper bound on chdstream_process() decompression threads */
+#define CHDSTREAM_BATCH_MAX_THREADS 16
+
+struct chdstream_hunk
+{
+   uint8_t *mem;
+   /* Hunk held by this slot, or -1 */
+   int32_t hunknum;
+   /* Last use, for LRU eviction */
+   uint32_t stamp;
+   /* Being decompressed, contents not usable yet */
+   bool loading;
+};
+
 struct chdstream
 {
    chd_file *chd;
+   /* Path of the chd, to open more handles to it */
+   char *path;
    /* Should we swap bytes? */
    bool swab;
    /* Size of frame taken from each hunk */
@@ -57,6 +82,23 @@ struct chdstream
    int32_t hunknum;
    /* Loaded hunk */
    uint8_t *hunkmem;
+   /* Cache slot of the loaded hunk, never evicted */
+   int32_t slot;
+   uint32_t stamp;
+   struct chdstream_hunk cache[CHDSTREAM_CACHE_SIZE];
+#ifdef HAVE_THREADS
+   /* Read-ahead worker, started on the first sequential read.
+    * 'lock' guards the cache slots and the read-ahead window,
+    * 'chd_lock' serializes access to the chd file itself. */
+   sthread_t *thread;
+   slock_t *lock;
+   slock_t *chd_lock;
+   scond_t *cond;
+   /* Hunks [readahead_next, readahead_end) are still to be loaded */
+   uint32_t readahead_next;
+   uint32_t readahead_end;
+   bool quit;
+#endif
 };
 
 typedef struct metadata {
@@ -201,6 +243,7 @@ chdstream_find_track(chd_file *fd, int32_t track, metadata_t *meta)
 
 chdstream_t *chdstream_open(const char *path, int32_t track)
 {
+   unsigned i;
    metadata_t meta;
    uint32_t pregap      = 0;
    const chd_header *hd = NULL;
@@ -219,9 +262,22 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
       goto error;
 
    hd              = chd_get_header(chd);
-   stream->hunkmem = (uint8_t*)malloc(hd->hunkbytes);
-   if (!stream->hunkmem)
+
+   for (i = 0; i < CHDSTREAM_CACHE_SIZE; i++)
+   {
+      stream->cache[i].hunknum = -1;
+      stream->cache[i].mem     = (uint8_t*)malloc(hd->hunkbytes);
+      if (!stream->cache[i].mem)
+         goto error;
+   }
+
+#ifdef HAVE_THREADS
+   stream->lock     = slock_new();
+   stream->chd_lock = slock_new();
+   stream->cond     = scond_new();
+   if (!stream->lock || !stream->chd_lock || !stream->cond)
       goto error;
+#endif
 
    if (!strcmp(meta.type, "MODE1_RAW"))
    {
@@ -260,6 +316,8 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
       (size_t) meta.frames * stream->frame_size;
    stream->offset          = 0;
    stream->hunknum         = -1;
+   stream->slot            = -1;
+   stream->path            = strdup(path);
 
    return stream;
 
@@ -275,40 +333,256 @@ error:
 
 void chdstream_close(chdstream_t *stream)
 {
+   unsigned i;
+
    if (stream)
    {
-      if (stream->hunkmem)
-         free(stream->hunkmem);
+#ifdef HAVE_THREADS
+      if (stream->thread)
+      {
+         slock_lock(stream->lock);
+         stream->quit = true;
+         scond_broadcast(stream->cond);
+         slock_unlock(stream->lock);
+         sthread_join(stream->thread);
+      }
+      if (stream->cond)
+         scond_free(stream->cond);
+      if (stream->chd_lock)
+         slock_free(stream->chd_lock);
+      if (stream->lock)
+         slock_free(stream->lock);
+#endif
+      for (i = 0; i < CHDSTREAM_CACHE_SIZE; i++)
+         free(stream->cache[i].mem);
+      free(stream->path);
       if (stream->chd)
          chd_close(stream->chd);
       free(stream);
    }
 }
 
-static bool
-chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
+static void chdstream_cache_lock(chdstream_t *stream)
+{
+#ifdef HAVE_THREADS
+   slock_lock(stream->lock);
+#endif
+}
+
+static void chdstream_cache_unlock(chdstream_t *stream)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(stream->lock);
+#endif
+}
+
+static int32_t chdstream_cache_find(chdstream_t *stream, uint32_t hunknum)
+{
+   int32_t i;
+
+   for (i = 0; i < CHDSTREAM_CACHE_SIZE; i++)
+      if (stream->cache[i].hunknum == (int32_t)hunknum)
+         return i;
+
+   return -1;
+}
+
+/* Picks a free slot, or else the least recently used one.
+ * Slots being loaded and the slot the reader is copying
+ * from are left alone. Called with the cache locked. */
+static int32_t chdstream_cache_evict(chdstream_t *stream)
+{
+   int32_t i;
+   int32_t victim = -1;
+
+   for (i = 0; i < CHDSTREAM_CACHE_SIZE; i++)
+   {
+      struct chdstream_hunk *entry = &stream->cache[i];
+
+      if (entry->loading || i == stream->slot)
+         continue;
+      if (entry->hunknum < 0)
+         return i;
+      if (victim < 0 || entry->stamp < stream->cache[victim].stamp)
+         victim = i;
+   }
+
+   return victim;
+}
+
+static void chdstream_swab_hunk(chdstream_t *stream, uint8_t *mem)
 {
-   chd_error err;
-   uint16_t *array;
    uint32_t i;
    uint32_t count;
+   uint16_t *array;
 
-   if (hunknum == stream->hunknum)
-      return true;
+   if (!stream->swab)
+      return;
+
+   count = chd_get_header(stream->chd)->hunkbytes / 2;
+   array = (uint16_t*)mem;
+
+   for (i = 0; i < count; ++i)
+      array[i] = SWAP16(array[i]);
+}
+
+/* Decompresses a hunk into a slot the caller has marked
+ * as loading. Called with the cache unlocked. */
+static bool chdstream_cache_fill(chdstream_t *stream,
+      struct chdstream_hunk *entry, uint32_t hunknum)
+{
+   chd_error err;
+
+#ifdef HAVE_THREADS
+   slock_lock(stream->chd_lock);
+#endif
+   err = chd_read(stream->chd, hunknum, entry->mem);
+#ifdef HAVE_THREADS
+   slock_unlock(stream->chd_lock);
+#endif
 
-   err = chd_read(stream->chd, hunknum, stream->hunkmem);
    if (err != CHDERR_NONE)
       return false;
 
-   if (stream->swab)
+   chdstream_swab_hunk(stream, entry->mem);
+   return true;
+}
+
+#ifdef HAVE_THREADS
+static void chdstream_readahead_thread(void *data)
+{
+   chdstream_t *stream = (chdstream_t*)data;
+
+   slock_lock(stream->lock);
+
+   while (!stream->quit)
    {
-      count = chd_get_header(stream->chd)->hunkbytes / 2;
-      array = (uint16_t*) stream->hunkmem;
-      for (i = 0; i < count; ++i)
-         array[i] = SWAP16(array[i]);
+      int32_t slot;
+      bool ok;
+      uint32_t hunknum;
+
+      if (stream->readahead_next >= stream->readahead_end)
+      {
+         scond_wait(stream->cond, stream->lock);
+         continue;
+      }
+
+      hunknum = stream->readahead_next++;
+      if (chdstream_cache_find(stream, hunknum) >= 0)
+         continue;
+
+      slot = chdstream_cache_evict(stream);
+      if (slot < 0)
+         continue;
+
+      stream->cache[slot].hunknum = hunknum;
+      stream->cache[slot].loading = true;
+      slock_unlock(stream->lock);
+
+      ok = chdstream_cache_fill(stream, &stream->cache[slot], hunknum);
+
+      slock_lock(stream->lock);
+      stream->cache[slot].loading = false;
+      stream->cache[slot].stamp   = stream->stamp;
+      if (!ok)
+         stream->cache[slot].hunknum = -1;
+      scond_broadcast(stream->cond);
+   }
+
+   slock_unlock(stream->lock);
+}
+
+/* Queues the hunks following 'hunknum' for the worker.
+ * Called with the cache locked. */
+static void chdstream_readahead(chdstream_t *stream, uint32_t hunknum)
+{
+   uint32_t total = chd_get_header(stream->chd)->totalhunks;
+
+   stream->readahead_end     = MIN(hunknum + 1 + CHDSTREAM_READAHEAD, total);
+
+   /* Restart the window after a seek in either direction,
+    * hunks still cached from before are skipped by the worker. */
+   if (stream->readahead_next <= hunknum
+         || stream->readahead_next >= stream->readahead_end)
+      stream->readahead_next = hunknum + 1;
+
+   if (stream->readahead_next >= stream->readahead_end)
+      return;
+
+   if (!stream->thread)
+      stream->thread = sthread_create(chdstream_readahead_thread, stream);
+
+   if (stream->thread)
+      scond_broadcast(stream->cond);
+   else
+      stream->readahead_next = stream->readahead_end;
+}
+#endif
+
+static bool
+chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
+{
+   int32_t slot;
+   bool sequential = (stream->hunknum >= 0 &&
+         hunknum == (uint32_t)stream->hunknum + 1);
+
+   if ((int32_t)hunknum == stream->hunknum)
+      return true;
+
+   chdstream_cache_lock(stream);
+
+   slot = chdstream_cache_find(stream, hunknum);
+
+#ifdef HAVE_THREADS
+   /* Already being read ahead, wait for it */
+   while (slot >= 0 && stream->cache[slot].loading)
+   {
+      scond_wait(stream->cond, stream->lock);
+      slot = chdstream_cache_find(stream, hunknum);
+   }
+#endif
+
+   if (slot < 0)
+   {
+      bool ok;
+
+      slot = chdstream_cache_evict(stream);
+      if (slot < 0)
+      {
+         chdstream_cache_unlock(stream);
+         return false;
+      }
+
+      stream->cache[slot].hunknum = hunknum;
+      stream->cache[slot].loading = true;
+      chdstream_cache_unlock(stream);
+
+      ok = chdstream_cache_fill(stream, &stream->cache[slot], hunknum);
+
+      chdstream_cache_lock(stream);
+      stream->cache[slot].loading = false;
+      if (!ok)
+      {
+         stream->cache[slot].hunknum = -1;
+         chdstream_cache_unlock(stream);
+         return false;
+      }
    }
 
-   stream->hunknum = hunknum;
+   stream->cache[slot].stamp = ++stream->stamp;
+   stream->slot              = slot;
+   stream->hunkmem           = stream->cache[slot].mem;
+   stream->hunknum           = hunknum;
+
+#ifdef HAVE_THREADS
+   if (sequential)
+      chdstream_readahead(stream, hunknum);
+#else
+   (void)sequential;
+#endif
+
+   chdstream_cache_unlock(stream);
+
    return true;
 }
 
@@ -429,3 +703,286 @@ ssize_t chdstream_get_size(chdstream_t *stream)
 {
   return stream->track_end;
 }
+
+static bool chdstream_process_serial(chdstream_t *stream,
+      chdstream_data_cb_t cb, void *userdata)
+{
+   ssize_t read;
+   uint8_t buffer[16 * 1024];
+
+   while ((read = chdstream_read(stream, buffer, sizeof(buffer))) > 0)
+      if (!cb(buffer, (size_t)read, userdata))
+         return false;
+
+   return read == 0;
+}
+
+#ifdef HAVE_THREADS
+struct chdstream_batch_slot
+{
+   uint8_t *mem;
+   /* Hunk held by this slot, or -1 once consumed */
+   int64_t hunknum;
+   bool ready;
+};
+
+struct chdstream_batch
+{
+   chdstream_t *stream;
+   slock_t *lock;
+   scond_t *cond;
+   struct chdstream_batch_slot *slots;
+   unsigned num_slots;
+   /* Next hunk a worker should pick up */
+   uint32_t next_hunk;
+   uint32_t end_hunk;
+   bool error;
+   bool quit;
+};
+
+struct chdstream_batch_worker
+{
+   struct chdstream_batch *batch;
+   chd_file *chd;
+   sthread_t *thread;
+};
+
+/* Workers claim hunks in order and decompress each into
+ * slot (hunk % num_slots), waiting for the reader to free
+ * the slot first. Each worker has its own chd handle
+ * since libchdr keeps per-file decompression state. */
+static void chdstream_batch_thread(void *data)
+{
+   struct chdstream_batch_worker *worker = (struct chdstream_batch_worker*)data;
+   struct chdstream_batch *batch         = worker->batch;
+
+   slock_lock(batch->lock);
+
+   while (!batch->quit && !batch->error && batch->next_hunk < batch->end_hunk)
+   {
+      bool ok;
+      uint32_t hunknum                  = batch->next_hunk;
+      struct chdstream_batch_slot *slot = &batch->slots[hunknum % batch->num_slots];
+
+      if (slot->hunknum >= 0)
+      {
+         scond_wait(batch->cond, batch->lock);
+         continue;
+      }
+
+      batch->next_hunk++;
+      slot->hunknum = hunknum;
+      slot->ready   = false;
+      slock_unlock(batch->lock);
+
+      ok = chd_read(worker->chd, hunknum, slot->mem) == CHDERR_NONE;
+      if (ok)
+         chdstream_swab_hunk(batch->stream, slot->mem);
+
+      slock_lock(batch->lock);
+      if (ok)
+         slot->ready  = true;
+      else
+         batch->error = true;
+      scond_broadcast(batch->cond);
+   }
+
+   slock_unlock(batch->lock);
+}
+
+static bool chdstream_process_batch(chdstream_t *stream,
+      struct chdstream_batch *batch, chdstream_data_cb_t cb, void *userdata)
+{
+   struct chdstream_batch_slot *slot = NULL;
+   uint8_t *zeroes                   = NULL;
+   bool ret                          = true;
+   const chd_header *hd              = chd_get_header(stream->chd);
+
+   while (stream->offset < stream->track_end)
+   {
+      uint32_t frame_offset = stream->offset % stream->frame_size;
+      uint32_t amount       = stream->frame_size - frame_offset;
+
+      if (amount > stream->track_end - stream->offset)
+         amount = (uint32_t)(stream->track_end - stream->offset);
+
+      /* In pregap */
+      if (stream->offset < stream->track_start)
+      {
+         if (!zeroes)
+            zeroes = (uint8_t*)calloc(1, stream->frame_size);
+         if (!zeroes || !cb(zeroes, amount, userdata))
+         {
+            ret = false;
+            break;
+         }
+      }
+      else
+      {
+         uint32_t chd_frame   = stream->track_frame +
+            (uint32_t)((stream->offset - stream->track_start) / stream->frame_size);
+         uint32_t hunk        = chd_frame / stream->frames_per_hunk;
+         uint32_t hunk_offset = (chd_frame % stream->frames_per_hunk) * hd->unitbytes;
+
+         if (!slot || slot->hunknum != hunk)
+         {
+            slock_lock(batch->lock);
+
+            /* Hand the slot we are done with back to the workers */
+            if (slot)
+            {
+               slot->hunknum = -1;
+               slot->ready   = false;
+               scond_broadcast(batch->cond);
+            }
+
+            slot = &batch->slots[hunk % batch->num_slots];
+            while (!batch->error && !(slot->hunknum == hunk && slot->ready))
+               scond_wait(batch->cond, batch->lock);
+
+            ret = !batch->error;
+            slock_unlock(batch->lock);
+
+            if (!ret)
+               break;
+         }
+
+         if (!cb(slot->mem + frame_offset + hunk_offset + stream->frame_offset,
+                  amount, userdata))
+         {
+            ret = false;
+            break;
+         }
+      }
+
+      stream->offset += amount;
+   }
+
+   free(zeroes);
+   return ret;
+}
+#endif
+
+/**
+ * chdstream_process:
+ * @stream              : CHD stream.
+ * @threads             : Number of decompression threads.
+ * @cb                  : Called with the track data, in order.
+ * @userdata            : Passed to @cb.
+ *
+ * Hands everything from the read cursor to the end of the
+ * track to @cb, like repeated chdstream_read() calls would.
+ * With more than one thread, hunks are decompressed on
+ * @threads worker threads while @cb runs, which is what
+ * bounds hashing a whole disc on a single core otherwise.
+ *
+ * Returns: false on a read error or if @cb returned false.
+ **/
+bool chdstream_process(chdstream_t *stream, unsigned threads,
+      chdstream_data_cb_t cb, void *userdata)
+{
+#ifdef HAVE_THREADS
+   unsigned i;
+   uint32_t first_frame, last_frame;
+   unsigned workers = 0;
+   bool ret         = false;
+   struct chdstream_batch batch;
+   struct chdstream_batch_worker worker[CHDSTREAM_BATCH_MAX_THREADS];
+   const chd_header *hd = NULL;
+#endif
+
+   if (!stream || !cb)
+      return false;
+
+#ifdef HAVE_THREADS
+   if (threads < 2 || !stream->path || stream->offset >= stream->track_end)
+      return chdstream_process_serial(stream, cb, userdata);
+
+   threads = MIN(threads, CHDSTREAM_BATCH_MAX_THREADS);
+   hd      = chd_get_header(stream->chd);
+
+   memset(&batch, 0, sizeof(batch));
+   memset(worker, 0, sizeof(worker));
+
+   first_frame      = stream->track_frame;
+   if (stream->offset > stream->track_start)
+      first_frame  += (uint32_t)((stream->offset - stream->track_start)
+            / stream->frame_size);
+
+   batch.stream     = stream;
+   batch.next_hunk  = first_frame / stream->frames_per_hunk;
+   last_frame       = stream->track_frame + (uint32_t)(
+         (stream->track_end - stream->track_start - 1) / stream->frame_size);
+   batch.end_hunk   = MIN(hd->totalhunks,
+         last_frame / stream->frames_per_hunk + 1);
+   batch.num_slots  = threads * 2;
+   batch.lock       = slock_new();
+   batch.cond       = scond_new();
+   batch.slots      = (struct chdstream_batch_slot*)
+      calloc(batch.num_slots, sizeof(*batch.slots));
+
+   if (!batch.lock || !batch.cond || !batch.slots)
+      goto end;
+
+   for (i = 0; i < batch.num_slots; i++)
+   {
+      batch.slots[i].hunknum = -1;
+      batch.slots[i].mem     = (uint8_t*)malloc(hd->hunkbytes);
+      if (!batch.slots[i].mem)
+         goto end;
+   }
+
+   for (i = 0; i < threads; i++)
+   {
+      struct chdstream_batch_worker *w = &worker[workers];
+
+      if (chd_open(stream->path, CHD_OPEN_READ, NULL, &w->chd) != CHDERR_NONE)
+         break;
+
+      w->batch  = &batch;
+      w->thread = sthread_create(chdstream_batch_thread, w);
+      if (!w->thread)
+      {
+         chd_close(w->chd);
+         w->chd = NULL;
+         break;
+      }
+      workers++;
+   }
+
+   if (workers)
+      ret = chdstream_process_batch(stream, &batch, cb, userdata);
+
+end:
+   if (batch.lock)
+   {
+      slock_lock(batch.lock);
+      batch.quit = true;
+      scond_broadcast(batch.cond);
+      slock_unlock(batch.lock);
+   }
+
+   for (i = 0; i < workers; i++)
+   {
+      sthread_join(worker[i].thread);
+      chd_close(worker[i].chd);
+   }
+
+   if (batch.slots)
+      for (i = 0; i < batch.num_slots; i++)
+         free(batch.slots[i].mem);
+   free(batch.slots);
+   if (batch.cond)
+      scond_free(batch.cond);
+   if (batch.lock)
+      slock_free(batch.lock);
+
+   /* Could not get any worker going, do it on this thread */
+   if (!workers)
+      return chdstream_process_serial(stream, cb, userdata);
+
+   return ret;
+#else
+   return chdstream_process_serial(stream, cb, userdata);
+#endif
+}
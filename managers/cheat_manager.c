@@ -26,6 +26,15 @@
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
 #include <features/features_cpu.h>
+#include <retro_inline.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
@@ -51,6 +60,32 @@
 #include "../input/input_driver.h"
 #include "../configuration.h"
 
+/* An enabled RetroArch-handler cheat, resolved against the core's memory */
+struct cheat_manager_retro_cheat
+{
+   uint8_t *ptr;               /* NULL when the address is out of range */
+   struct item_cheat *cheat;   /* NULL when the cheat doesn't rumble */
+   unsigned value;
+   unsigned cheat_type;
+   unsigned bytes_per_item;
+   uint8_t write_mask;         /* bits of the byte to write for 1-byte items */
+   bool big_endian;            /* endianness to write with */
+   bool read_value;            /* whether the current value is needed */
+};
+
+/* Enabled RetroArch cheats in list order, rebuilt by
+ * cheat_manager_apply_retro_cheats whenever it's marked dirty or the
+ * memory it was compiled against changes. */
+static struct
+{
+   struct cheat_manager_retro_cheat *list;
+   unsigned count;
+   unsigned capacity;
+   const uint8_t *base;
+   bool big_endian;
+   bool dirty;
+} cheat_manager_retro = { NULL, 0, 0, NULL, false, true };
+
 
 unsigned cheat_manager_get_buf_size(void)
 {
@@ -250,6 +285,7 @@ bool cheat_manager_copy_working_to_idx(unsigned idx)
       free(cheat_manager_state.cheats[idx].desc) ;
 
    cheat_manager_state.cheats[idx].desc = strdup(cheat_manager_state.working_desc) ;
+   cheat_manager_retro.dirty = true ;
    return true ;
 }
 static void cheat_manager_new(unsigned size)
@@ -460,6 +496,8 @@ bool cheat_manager_realloc(unsigned new_size, unsigned default_handler)
       cheat_manager_state.cheats[i].idx = i;
    }
 
+   cheat_manager_retro.dirty = true ;
+
    return true;
 }
 
@@ -497,6 +535,12 @@ void cheat_manager_free(void)
    cheat_manager_state.memory_initialized = false ;
    cheat_manager_state.memory_search_initialized = false ;
 
+   if ( cheat_manager_retro.list )
+      free(cheat_manager_retro.list) ;
+   cheat_manager_retro.list     = NULL ;
+   cheat_manager_retro.count    = 0 ;
+   cheat_manager_retro.capacity = 0 ;
+   cheat_manager_retro.dirty    = true ;
 }
 
 void cheat_manager_update(cheat_manager_t *handle, unsigned handle_idx)
@@ -522,6 +566,7 @@ void cheat_manager_toggle_index(unsigned i)
       return;
 
    cheat_manager_state.cheats[i].state = !cheat_manager_state.cheats[i].state;
+   cheat_manager_retro.dirty = true ;
    cheat_manager_update(&cheat_manager_state, i);
 
    if (!settings)
@@ -538,6 +583,7 @@ void cheat_manager_toggle(void)
       return;
 
    cheat_manager_state.cheats[cheat_manager_state.ptr].state ^= true;
+   cheat_manager_retro.dirty = true ;
    cheat_manager_apply_cheats();
    cheat_manager_update(&cheat_manager_state, cheat_manager_state.ptr);
 }
@@ -678,13 +724,21 @@ int cheat_manager_initialize_memory(void *data, bool wraparound)
 #endif
    if ( is_search_initialization )
    {
+      unsigned words = (cheat_manager_state.num_matches + 31) / 32 ;
+
+      if ( cheat_manager_state.prev_memory_buf )
+         free(cheat_manager_state.prev_memory_buf) ;
+      if ( cheat_manager_state.matches )
+         free(cheat_manager_state.matches) ;
+      cheat_manager_state.matches = NULL ;
+
       cheat_manager_state.prev_memory_buf = (uint8_t*) calloc(cheat_manager_state.total_memory_size, sizeof(uint8_t));
       if (!cheat_manager_state.prev_memory_buf )
       {
          runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_INIT_FAIL), 1, 180, true);
          return 0 ;
       }
-      cheat_manager_state.matches = (uint8_t*) calloc(cheat_manager_state.total_memory_size, sizeof(uint8_t));
+      cheat_manager_state.matches = (uint32_t*) calloc(words + 1, sizeof(uint32_t));
       if (!cheat_manager_state.matches )
       {
          free(cheat_manager_state.prev_memory_buf) ;
@@ -693,8 +747,14 @@ int cheat_manager_initialize_memory(void *data, bool wraparound)
          return 0 ;
       }
 
-      memset(cheat_manager_state.matches, 0xFF, cheat_manager_state.total_memory_size) ;
+      /* Every item starts out as a match, bits past the last item stay clear */
+      memset(cheat_manager_state.matches, 0xFF, (cheat_manager_state.num_matches / 32) * sizeof(uint32_t)) ;
+      if ( cheat_manager_state.num_matches % 32 )
+         cheat_manager_state.matches[cheat_manager_state.num_matches / 32] =
+               (1U << (cheat_manager_state.num_matches % 32)) - 1 ;
+
       memcpy(cheat_manager_state.prev_memory_buf, cheat_manager_state.curr_memory_buf, cheat_manager_state.actual_memory_size);
+      cheat_manager_state.match_bit_size = cheat_manager_state.search_bit_size ;
       cheat_manager_state.memory_search_initialized = true ;
    }
 
@@ -800,123 +860,603 @@ int cheat_manager_search_eqminus(void *data, bool wraparound)
    return cheat_manager_search(CHEAT_SEARCH_TYPE_EQMINUS) ;
 }
 
-int cheat_manager_search(enum cheat_search_type search_type)
+#define CHEAT_SEARCH_MAX_THREADS     8
+/* Don't bother spawning threads for less than this many items each */
+#define CHEAT_SEARCH_ITEMS_PER_THREAD (1 << 20)
+
+struct cheat_search_job
 {
-   char msg[100];
-   unsigned char *curr = cheat_manager_state.curr_memory_buf ;
-   unsigned char *prev = cheat_manager_state.prev_memory_buf ;
-   unsigned int idx = 0 ;
-   unsigned int curr_val ;
-   unsigned int prev_val ;
-   unsigned int mask = 0 ;
-   unsigned int bytes_per_item = 1 ;
-   unsigned int bits = 8 ;
-   bool refresh      = false;
+   const uint8_t *curr;
+   uint8_t *prev;
+   uint32_t *matches;
+   /* Items [first_item, last_item), first_item is a multiple of 32 */
+   unsigned first_item;
+   unsigned last_item;
+   /* Bytes [copy_start, copy_end) to copy from curr to prev afterwards */
+   unsigned copy_start;
+   unsigned copy_end;
+   unsigned search_type;
+   unsigned search_bit_size;
+   unsigned value;
+   bool big_endian;
+   /* Out: number of matches left in the range */
+   unsigned count;
+};
+
+typedef unsigned (*cheat_search_kernel_t)(const uint8_t *curr,
+      const uint8_t *prev, uint32_t *matches,
+      unsigned first_word, unsigned last_word, unsigned value);
+
+static INLINE unsigned cheat_manager_popcount32(uint32_t v)
+{
+#if defined(__GNUC__)
+   return __builtin_popcount(v);
+#else
+   v = v - ((v >> 1) & 0x55555555);
+   v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+   return (((v + (v >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+}
 
-   if (!cheat_manager_state.curr_memory_buf)
+static INLINE unsigned cheat_manager_read_item(const uint8_t *buf,
+      unsigned idx, unsigned bytes_per_item, bool big_endian)
+{
+   const uint8_t *p = buf + idx;
+
+   switch (bytes_per_item)
    {
-      runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_NOT_INITIALIZED), 1, 180, true);
-      return 0 ;
+      case 2:
+         return big_endian ?
+               (p[0] << 8) | p[1] :
+               p[0] | (p[1] << 8);
+      case 4:
+         return big_endian ?
+               ((unsigned)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3] :
+               p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned)p[3] << 24);
+      default:
+         break;
    }
 
+   return p[0];
+}
 
-   cheat_manager_setup_search_meta(cheat_manager_state.search_bit_size, &bytes_per_item, &mask, &bits) ;
+/**
+ * cheat_manager_match_item_address:
+ * @item                      : Search item index.
+ * @idx                       : Byte address of the item.
+ * @address_mask              : Mask of the item's bits within that byte,
+ *                              0xFF for items of 8 bits and more.
+ *
+ * Maps a bit in the matches bitmap back to memory.
+ **/
+static void cheat_manager_match_item_address(unsigned item,
+      unsigned *idx, unsigned *address_mask)
+{
+   unsigned int mask           = 0;
+   unsigned int bytes_per_item = 1;
+   unsigned int bits           = 8;
+
+   cheat_manager_setup_search_meta(cheat_manager_state.search_bit_size, &bytes_per_item, &mask, &bits);
+
+   if (bits < 8)
+   {
+      unsigned per_byte = 8 / bits;
+      *idx              = item / per_byte;
+      *address_mask     = mask << ((item % per_byte) * bits);
+   }
+   else
+   {
+      *idx              = item * bytes_per_item;
+      *address_mask     = 0xFF;
+   }
+}
 
-   /* little endian FF000000 = 256 */
-   for (idx = 0 ; idx < cheat_manager_state.total_memory_size ; idx = idx + bytes_per_item)
+static INLINE bool cheat_manager_search_compare(unsigned search_type,
+      unsigned curr_subval, unsigned prev_subval)
+{
+   switch (search_type)
+   {
+      case CHEAT_SEARCH_TYPE_EXACT :
+         return ( curr_subval == cheat_manager_state.search_exact_value) ;
+      case CHEAT_SEARCH_TYPE_LT :
+         return ( curr_subval < prev_subval) ;
+      case CHEAT_SEARCH_TYPE_GT :
+         return ( curr_subval > prev_subval) ;
+      case CHEAT_SEARCH_TYPE_LTE :
+         return ( curr_subval <= prev_subval) ;
+      case CHEAT_SEARCH_TYPE_GTE :
+         return ( curr_subval >= prev_subval) ;
+      case CHEAT_SEARCH_TYPE_EQ :
+         return ( curr_subval == prev_subval) ;
+      case CHEAT_SEARCH_TYPE_NEQ :
+         return ( curr_subval != prev_subval) ;
+      case CHEAT_SEARCH_TYPE_EQPLUS :
+         return ( curr_subval == prev_subval+cheat_manager_state.search_eqplus_value) ;
+      case CHEAT_SEARCH_TYPE_EQMINUS :
+         return ( curr_subval == prev_subval-cheat_manager_state.search_eqminus_value) ;
+   }
+
+   return false;
+}
+
+/* Generic item by item search, used for sub-byte items, for the
+ * items past the last full bitmap word and when there is no kernel. */
+static unsigned cheat_manager_search_scalar(const struct cheat_search_job *job,
+      unsigned first_item, unsigned last_item)
+{
+   unsigned int mask           = 0;
+   unsigned int bytes_per_item = 1;
+   unsigned int bits           = 8;
+   unsigned count              = 0;
+   unsigned item               = first_item;
+
+   cheat_manager_setup_search_meta(job->search_bit_size, &bytes_per_item, &mask, &bits);
+
+   while (item < last_item)
    {
-      unsigned byte_part;
+      unsigned curr_subval;
+      unsigned prev_subval;
+      uint32_t bit = 1U << (item & 31);
+      uint32_t *word = &job->matches[item >> 5];
 
-      switch (bytes_per_item )
+      if (!*word)
       {
-         case 2 :
+         /* Skip the whole word, nothing left to test in it */
+         item = (item | 31) + 1;
+         continue;
+      }
+
+      if (*word & bit)
+      {
+         if (bits < 8)
          {
-            curr_val = cheat_manager_state.big_endian ?
-                  (*(curr+idx)*256) + *(curr+idx+1) :
-                  *(curr+idx) + (*(curr+idx+1)*256) ;
-            prev_val = cheat_manager_state.big_endian ?
-                  (*(prev+idx)*256) + *(prev+idx+1) :
-                  *(prev+idx) + (*(prev+idx+1)*256) ;
-            break ;
+            unsigned per_byte = 8 / bits;
+            unsigned shift    = (item % per_byte) * bits;
+            curr_subval       = (job->curr[item / per_byte] >> shift) & mask;
+            prev_subval       = (job->prev[item / per_byte] >> shift) & mask;
          }
-         case 4 :
+         else
          {
-            curr_val = cheat_manager_state.big_endian ?
-                  (*(curr+idx)*256*256*256) + (*(curr+idx+1)*256*256) + (*(curr+idx+2)*256) + *(curr+idx+3) :
-                  *(curr+idx) + (*(curr+idx+1)*256) + (*(curr+idx+2)*256*256) + (*(curr+idx+3)*256*256*256) ;
-            prev_val = cheat_manager_state.big_endian ?
-                  (*(prev+idx)*256*256*256) + (*(prev+idx+1)*256*256) + (*(prev+idx+2)*256) + *(prev+idx+3) :
-                  *(prev+idx) + (*(prev+idx+1)*256) + (*(prev+idx+2)*256*256) + (*(prev+idx+3)*256*256*256) ;
-            break ;
-         }
-         case 1 :
-         default :
-         {
-            curr_val = *(curr+idx) ;
-            prev_val = *(prev+idx) ;
-            break ;
+            curr_subval = cheat_manager_read_item(job->curr,
+                  item * bytes_per_item, bytes_per_item, job->big_endian);
+            prev_subval = cheat_manager_read_item(job->prev,
+                  item * bytes_per_item, bytes_per_item, job->big_endian);
          }
+
+         if (cheat_manager_search_compare(job->search_type, curr_subval, prev_subval))
+            count++;
+         else
+            *word &= ~bit;
       }
 
-      for (byte_part = 0 ; byte_part < 8/bits ; byte_part++)
+      item++;
+   }
+
+   return count;
+}
+
+#if defined(__SSE2__)
+static INLINE __m128i cheat_manager_search_load(const uint8_t *ptr,
+      unsigned width, bool swap)
+{
+   __m128i x = _mm_loadu_si128((const __m128i*)ptr);
+
+   if (swap && width >= 16)
+   {
+      x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+
+      if (width == 32)
       {
-         unsigned int curr_subval = (curr_val >> (byte_part*bits) ) & mask ;
-         unsigned int prev_subval = (prev_val >> (byte_part*bits) ) & mask ;
-         unsigned int prev_match ;
+         x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+         x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+      }
+   }
 
-         if (bits < 8 )
-            prev_match = *(cheat_manager_state.matches+idx) & (mask << (byte_part*bits)) ;
-         else
-            prev_match = *(cheat_manager_state.matches+idx) ;
+   return x;
+}
 
-         if (prev_match > 0)
-         {
-            bool match = false ;
-            switch (search_type)
-            {
-               case CHEAT_SEARCH_TYPE_EXACT :
-                  match = ( curr_subval == cheat_manager_state.search_exact_value) ;
-                  break;
-               case CHEAT_SEARCH_TYPE_LT :
-                  match = ( curr_subval < prev_subval) ;
-                  break;
-               case CHEAT_SEARCH_TYPE_GT :
-                  match = ( curr_subval > prev_subval) ;
-                  break;
-               case CHEAT_SEARCH_TYPE_LTE :
-                  match = ( curr_subval <= prev_subval) ;
-                  break;
-               case CHEAT_SEARCH_TYPE_GTE :
-                  match = ( curr_subval >= prev_subval) ;
-                  break;
-               case CHEAT_SEARCH_TYPE_EQ :
-                  match = ( curr_subval == prev_subval) ;
-                  break;
-               case CHEAT_SEARCH_TYPE_NEQ :
-                  match = ( curr_subval != prev_subval) ;
-                  break;
-               case CHEAT_SEARCH_TYPE_EQPLUS :
-                  match = ( curr_subval == prev_subval+cheat_manager_state.search_eqplus_value) ;
-                  break;
-               case CHEAT_SEARCH_TYPE_EQMINUS :
-                  match = ( curr_subval == prev_subval-cheat_manager_state.search_eqminus_value) ;
-                  break;
-            }
-            if (!match )
-            {
-               if ( bits < 8 )
-                  *(cheat_manager_state.matches+idx) = *(cheat_manager_state.matches+idx) &
-                        (( ~(mask << (byte_part*bits))) & 0xFF );
-               else
-                  memset(cheat_manager_state.matches+idx,0,bytes_per_item) ;
-               if ( cheat_manager_state.num_matches > 0 )
-                  cheat_manager_state.num_matches-- ;
-            }
-         }
+static INLINE __m128i cheat_manager_search_cmpeq(__m128i a, __m128i b,
+      unsigned width)
+{
+   switch (width)
+   {
+      case 8:
+         return _mm_cmpeq_epi8(a, b);
+      case 16:
+         return _mm_cmpeq_epi16(a, b);
+   }
+
+   return _mm_cmpeq_epi32(a, b);
+}
+
+/* Unsigned a > b, SSE2 only has signed compares so flip the sign bits */
+static INLINE __m128i cheat_manager_search_cmpgt(__m128i a, __m128i b,
+      __m128i sign, unsigned width)
+{
+   a = _mm_xor_si128(a, sign);
+   b = _mm_xor_si128(b, sign);
+
+   switch (width)
+   {
+      case 8:
+         return _mm_cmpgt_epi8(a, b);
+      case 16:
+         return _mm_cmpgt_epi16(a, b);
+   }
+
+   return _mm_cmpgt_epi32(a, b);
+}
+
+static INLINE __m128i cheat_manager_search_sub(__m128i a, __m128i b,
+      unsigned width)
+{
+   switch (width)
+   {
+      case 8:
+         return _mm_sub_epi8(a, b);
+      case 16:
+         return _mm_sub_epi16(a, b);
+   }
+
+   return _mm_sub_epi32(a, b);
+}
+
+/* Same as cheat_manager_search_compare, on a vector of items. Items
+ * narrower than 32 bits can't wrap around in the scalar version, so
+ * relative searches also need the difference to have the right sign. */
+static INLINE __m128i cheat_manager_search_cmp(__m128i c, __m128i p,
+      __m128i v, __m128i sign, unsigned width, unsigned search_type)
+{
+   const __m128i ones = _mm_set1_epi32(-1);
+
+   switch (search_type)
+   {
+      case CHEAT_SEARCH_TYPE_EXACT :
+         return cheat_manager_search_cmpeq(c, v, width);
+      case CHEAT_SEARCH_TYPE_LT :
+         return cheat_manager_search_cmpgt(p, c, sign, width);
+      case CHEAT_SEARCH_TYPE_GT :
+         return cheat_manager_search_cmpgt(c, p, sign, width);
+      case CHEAT_SEARCH_TYPE_LTE :
+         return _mm_xor_si128(cheat_manager_search_cmpgt(c, p, sign, width), ones);
+      case CHEAT_SEARCH_TYPE_GTE :
+         return _mm_xor_si128(cheat_manager_search_cmpgt(p, c, sign, width), ones);
+      case CHEAT_SEARCH_TYPE_EQ :
+         return cheat_manager_search_cmpeq(c, p, width);
+      case CHEAT_SEARCH_TYPE_NEQ :
+         return _mm_xor_si128(cheat_manager_search_cmpeq(c, p, width), ones);
+      case CHEAT_SEARCH_TYPE_EQPLUS :
+         if (width == 32)
+            return cheat_manager_search_cmpeq(
+                  cheat_manager_search_sub(c, p, width), v, width);
+         return _mm_andnot_si128(cheat_manager_search_cmpgt(p, c, sign, width),
+               cheat_manager_search_cmpeq(
+                  cheat_manager_search_sub(c, p, width), v, width));
+      case CHEAT_SEARCH_TYPE_EQMINUS :
+         if (width == 32)
+            return cheat_manager_search_cmpeq(
+                  cheat_manager_search_sub(p, c, width), v, width);
+         return _mm_andnot_si128(cheat_manager_search_cmpgt(c, p, sign, width),
+               cheat_manager_search_cmpeq(
+                  cheat_manager_search_sub(p, c, width), v, width));
+   }
+
+   return ones;
+}
+
+/* Tests the 32 items of one bitmap word, returns their match bits */
+static INLINE uint32_t cheat_manager_search_block(const uint8_t *curr,
+      const uint8_t *prev, __m128i v, __m128i sign,
+      unsigned width, bool swap, unsigned search_type)
+{
+   unsigned half;
+   uint32_t bits = 0;
+
+   for (half = 0; half < 2; half++)
+   {
+      __m128i m;
+      unsigned offset = half * width * 2;
+
+      if (width == 8)
+         m = cheat_manager_search_cmp(
+               cheat_manager_search_load(curr + offset, width, swap),
+               cheat_manager_search_load(prev + offset, width, swap),
+               v, sign, width, search_type);
+      else if (width == 16)
+         m = _mm_packs_epi16(
+               cheat_manager_search_cmp(
+                  cheat_manager_search_load(curr + offset, width, swap),
+                  cheat_manager_search_load(prev + offset, width, swap),
+                  v, sign, width, search_type),
+               cheat_manager_search_cmp(
+                  cheat_manager_search_load(curr + offset + 16, width, swap),
+                  cheat_manager_search_load(prev + offset + 16, width, swap),
+                  v, sign, width, search_type));
+      else
+      {
+         __m128i m32[4];
+         unsigned i;
+
+         for (i = 0; i < 4; i++)
+            m32[i] = cheat_manager_search_cmp(
+                  cheat_manager_search_load(curr + offset + i * 16, width, swap),
+                  cheat_manager_search_load(prev + offset + i * 16, width, swap),
+                  v, sign, width, search_type);
+
+         m = _mm_packs_epi16(
+               _mm_packs_epi32(m32[0], m32[1]),
+               _mm_packs_epi32(m32[2], m32[3]));
+      }
+
+      bits |= (uint32_t)_mm_movemask_epi8(m) << (half * 16);
+   }
+
+   return bits;
+}
+
+static INLINE unsigned cheat_manager_search_kernel(const uint8_t *curr,
+      const uint8_t *prev, uint32_t *matches,
+      unsigned first_word, unsigned last_word, unsigned value,
+      unsigned width, bool swap, unsigned search_type)
+{
+   unsigned w;
+   __m128i v, sign;
+   unsigned count       = 0;
+   const unsigned bytes = width / 8 * 32;
+
+   switch (width)
+   {
+      case 8:
+         v    = _mm_set1_epi8((char)value);
+         sign = _mm_set1_epi8((char)0x80);
+         break;
+      case 16:
+         v    = _mm_set1_epi16((short)value);
+         sign = _mm_set1_epi16((short)0x8000);
+         break;
+      default:
+         v    = _mm_set1_epi32((int)value);
+         sign = _mm_set1_epi32((int)0x80000000);
+         break;
+   }
+
+   for (w = first_word; w < last_word; w++)
+   {
+      uint32_t m = matches[w];
+
+      if (!m)
+         continue;
+
+      m         &= cheat_manager_search_block(curr + w * bytes,
+            prev + w * bytes, v, sign, width, swap, search_type);
+      matches[w] = m;
+      count     += cheat_manager_popcount32(m);
+   }
+
+   return count;
+}
+
+/* One kernel per (width, endianness, search type), the constant
+ * arguments let the compiler fold the switches above away. */
+#define CHEAT_SEARCH_KERNEL(name, width, swap, search_type) \
+static unsigned name(const uint8_t *curr, const uint8_t *prev, \
+      uint32_t *matches, unsigned first_word, unsigned last_word, \
+      unsigned value) \
+{ \
+   return cheat_manager_search_kernel(curr, prev, matches, \
+         first_word, last_word, value, width, swap, search_type); \
+}
+
+#define CHEAT_SEARCH_KERNELS(prefix, width, swap) \
+CHEAT_SEARCH_KERNEL(prefix##_exact,   width, swap, CHEAT_SEARCH_TYPE_EXACT) \
+CHEAT_SEARCH_KERNEL(prefix##_lt,      width, swap, CHEAT_SEARCH_TYPE_LT) \
+CHEAT_SEARCH_KERNEL(prefix##_lte,     width, swap, CHEAT_SEARCH_TYPE_LTE) \
+CHEAT_SEARCH_KERNEL(prefix##_gt,      width, swap, CHEAT_SEARCH_TYPE_GT) \
+CHEAT_SEARCH_KERNEL(prefix##_gte,     width, swap, CHEAT_SEARCH_TYPE_GTE) \
+CHEAT_SEARCH_KERNEL(prefix##_eq,      width, swap, CHEAT_SEARCH_TYPE_EQ) \
+CHEAT_SEARCH_KERNEL(prefix##_neq,     width, swap, CHEAT_SEARCH_TYPE_NEQ) \
+CHEAT_SEARCH_KERNEL(prefix##_eqplus,  width, swap, CHEAT_SEARCH_TYPE_EQPLUS) \
+CHEAT_SEARCH_KERNEL(prefix##_eqminus, width, swap, CHEAT_SEARCH_TYPE_EQMINUS)
+
+CHEAT_SEARCH_KERNELS(cheat_search_8,     8, false)
+CHEAT_SEARCH_KERNELS(cheat_search_16le, 16, false)
+CHEAT_SEARCH_KERNELS(cheat_search_16be, 16, true)
+CHEAT_SEARCH_KERNELS(cheat_search_32le, 32, false)
+CHEAT_SEARCH_KERNELS(cheat_search_32be, 32, true)
+
+#define CHEAT_SEARCH_KERNEL_ROW(prefix) \
+   { prefix##_exact, prefix##_lt, prefix##_lte, prefix##_gt, prefix##_gte, \
+     prefix##_eq, prefix##_neq, prefix##_eqplus, prefix##_eqminus }
+
+/* Indexed by [width/endianness][enum cheat_search_type] */
+static const cheat_search_kernel_t cheat_search_kernels[5][9] =
+{
+   CHEAT_SEARCH_KERNEL_ROW(cheat_search_8),
+   CHEAT_SEARCH_KERNEL_ROW(cheat_search_16le),
+   CHEAT_SEARCH_KERNEL_ROW(cheat_search_16be),
+   CHEAT_SEARCH_KERNEL_ROW(cheat_search_32le),
+   CHEAT_SEARCH_KERNEL_ROW(cheat_search_32be)
+};
+#endif
+
+static cheat_search_kernel_t cheat_manager_search_get_kernel(
+      const struct cheat_search_job *job)
+{
+#if defined(__SSE2__)
+   unsigned row;
+   unsigned int mask           = 0;
+   unsigned int bytes_per_item = 1;
+   unsigned int bits           = 8;
+
+   cheat_manager_setup_search_meta(job->search_bit_size, &bytes_per_item, &mask, &bits);
+
+   if (bits < 8 || job->search_type > CHEAT_SEARCH_TYPE_EQMINUS)
+      return NULL;
+
+   /* Values that don't fit the item can only match through 32-bit
+    * wraparound, leave those to the scalar search. */
+   if (  bytes_per_item < 4 && job->value > mask &&
+         (  job->search_type == CHEAT_SEARCH_TYPE_EXACT  ||
+            job->search_type == CHEAT_SEARCH_TYPE_EQPLUS ||
+            job->search_type == CHEAT_SEARCH_TYPE_EQMINUS))
+      return NULL;
+
+   switch (bytes_per_item)
+   {
+      case 2:
+         row = job->big_endian ? 2 : 1;
+         break;
+      case 4:
+         row = job->big_endian ? 4 : 3;
+         break;
+      default:
+         row = 0;
+         break;
+   }
+
+   return cheat_search_kernels[row][job->search_type];
+#else
+   return NULL;
+#endif
+}
+
+static void cheat_manager_search_job_run(void *data)
+{
+   struct cheat_search_job *job = (struct cheat_search_job*)data;
+   cheat_search_kernel_t kernel = cheat_manager_search_get_kernel(job);
+   unsigned first_scalar        = job->first_item;
+
+   job->count                   = 0;
+
+   if (kernel)
+   {
+      unsigned first_word = job->first_item / 32;
+      unsigned last_word  = job->last_item / 32;
+
+      if (last_word > first_word)
+      {
+         job->count   += kernel(job->curr, job->prev, job->matches,
+               first_word, last_word, job->value);
+         first_scalar  = last_word * 32;
       }
    }
 
-   memcpy(cheat_manager_state.prev_memory_buf, cheat_manager_state.curr_memory_buf, cheat_manager_state.actual_memory_size);
+   job->count += cheat_manager_search_scalar(job, first_scalar, job->last_item);
+
+   /* Refresh the previous values while this range is still in cache */
+   memcpy(job->prev + job->copy_start, job->curr + job->copy_start,
+         job->copy_end - job->copy_start);
+}
+
+/**
+ * cheat_manager_search_run:
+ * @search_type               : Comparison to apply to every item.
+ * @value                     : Value for exact/eqplus/eqminus searches.
+ *
+ * Filters the matches bitmap and copies the current memory into
+ * prev_memory_buf. Large memory is split in ranges of whole bitmap
+ * words which are searched on separate threads.
+ *
+ * Returns: the number of matches left.
+ **/
+static unsigned cheat_manager_search_run(enum cheat_search_type search_type,
+      unsigned value)
+{
+   unsigned i;
+   struct cheat_search_job jobs[CHEAT_SEARCH_MAX_THREADS];
+   unsigned count      = 0;
+   unsigned num_jobs   = 1;
+   unsigned item_bits  = 1 << cheat_manager_state.search_bit_size;
+   unsigned num_items  = (cheat_manager_state.total_memory_size * 8) / item_bits;
+   unsigned words      = (num_items + 31) / 32;
+#ifdef HAVE_THREADS
+   sthread_t *threads[CHEAT_SEARCH_MAX_THREADS];
+   unsigned cores      = cpu_features_get_core_amount();
+
+   num_jobs            = num_items / CHEAT_SEARCH_ITEMS_PER_THREAD;
+   if (num_jobs > cores)
+      num_jobs         = cores;
+   if (num_jobs > CHEAT_SEARCH_MAX_THREADS)
+      num_jobs         = CHEAT_SEARCH_MAX_THREADS;
+   if (num_jobs < 1)
+      num_jobs         = 1;
+#endif
+
+   for (i = 0; i < num_jobs; i++)
+   {
+      struct cheat_search_job *job = &jobs[i];
+
+      job->curr            = cheat_manager_state.curr_memory_buf;
+      job->prev            = cheat_manager_state.prev_memory_buf;
+      job->matches         = cheat_manager_state.matches;
+      job->first_item      = (unsigned)(((uint64_t)words * i / num_jobs) * 32);
+      job->last_item       = (unsigned)(((uint64_t)words * (i + 1) / num_jobs) * 32);
+      if (job->last_item > num_items)
+         job->last_item    = num_items;
+      job->copy_start      = (unsigned)((uint64_t)job->first_item * item_bits / 8);
+      job->copy_end        = (unsigned)((uint64_t)job->last_item * item_bits / 8);
+      if (i == num_jobs - 1)
+         job->copy_end     = cheat_manager_state.actual_memory_size;
+      job->search_type     = search_type;
+      job->search_bit_size = cheat_manager_state.search_bit_size;
+      job->value           = value;
+      job->big_endian      = cheat_manager_state.big_endian;
+      job->count           = 0;
+   }
+
+#ifdef HAVE_THREADS
+   for (i = 1; i < num_jobs; i++)
+   {
+      threads[i] = sthread_create(cheat_manager_search_job_run, &jobs[i]);
+      if (!threads[i])
+         cheat_manager_search_job_run(&jobs[i]);
+   }
+#endif
+
+   cheat_manager_search_job_run(&jobs[0]);
+   count = jobs[0].count;
+
+   for (i = 1; i < num_jobs; i++)
+   {
+#ifdef HAVE_THREADS
+      if (threads[i])
+         sthread_join(threads[i]);
+#endif
+      count += jobs[i].count;
+   }
+
+   return count;
+}
+
+int cheat_manager_search(enum cheat_search_type search_type)
+{
+   char msg[100];
+   unsigned value    = 0 ;
+   bool refresh      = false;
+
+   if (!cheat_manager_state.curr_memory_buf || !cheat_manager_state.matches ||
+         cheat_manager_state.match_bit_size != cheat_manager_state.search_bit_size)
+   {
+      runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_NOT_INITIALIZED), 1, 180, true);
+      return 0 ;
+   }
+
+   switch (search_type)
+   {
+      case CHEAT_SEARCH_TYPE_EXACT :
+         value = cheat_manager_state.search_exact_value ;
+         break;
+      case CHEAT_SEARCH_TYPE_EQPLUS :
+         value = cheat_manager_state.search_eqplus_value ;
+         break;
+      case CHEAT_SEARCH_TYPE_EQMINUS :
+         value = cheat_manager_state.search_eqminus_value ;
+         break;
+      default:
+         break;
+   }
+
+   cheat_manager_state.num_matches = cheat_manager_search_run(search_type, value) ;
 
    snprintf(msg, sizeof(msg), msg_hash_to_str(MSG_CHEAT_SEARCH_FOUND_MATCHES), cheat_manager_state.num_matches) ;
    msg[sizeof(msg) - 1] = 0;
@@ -951,12 +1491,11 @@ int cheat_manager_add_matches(const char *path,
 {
    char msg[100];
    bool refresh                = false;
-   unsigned byte_part          = 0;
-   unsigned int idx            = 0;
+   unsigned int w              = 0;
+   unsigned int words          = 0;
    unsigned int mask           = 0;
    unsigned int bytes_per_item = 1;
    unsigned int bits           = 8;
-   unsigned int curr_val       = 0;
    unsigned int num_added      = 0;
    unsigned char         *curr = cheat_manager_state.curr_memory_buf;
 
@@ -965,60 +1504,40 @@ int cheat_manager_add_matches(const char *path,
       runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_TOO_MANY), 1, 180, true);
       return 0 ;
    }
+
+   if (!curr || !cheat_manager_state.matches ||
+         cheat_manager_state.match_bit_size != cheat_manager_state.search_bit_size)
+      return 0 ;
+
    cheat_manager_setup_search_meta(cheat_manager_state.search_bit_size, &bytes_per_item, &mask, &bits) ;
 
-   for (idx = 0 ; idx < cheat_manager_state.total_memory_size ; idx = idx + bytes_per_item)
+   words = ((cheat_manager_state.total_memory_size * 8) / (1 << cheat_manager_state.search_bit_size) + 31) / 32 ;
+
+   for (w = 0 ; w < words ; w++)
    {
-      switch ( bytes_per_item )
-      {
-         case 2 :
-            curr_val = cheat_manager_state.big_endian ?
-                  (*(curr+idx)*256) + *(curr+idx+1) :
-                  *(curr+idx) + (*(curr+idx+1)*256) ;
-            break ;
-         case 4 :
-            curr_val = cheat_manager_state.big_endian ?
-                  (*(curr+idx)*256*256*256) + (*(curr+idx+1)*256*256) + (*(curr+idx+2)*256) + *(curr+idx+3) :
-                  *(curr+idx) + (*(curr+idx+1)*256) + (*(curr+idx+2)*256*256) + (*(curr+idx+3)*256*256*256) ;
-            break ;
-         case 1 :
-         default :
-            curr_val = *(curr+idx) ;
-            break ;
-      }
-      for (byte_part = 0 ; byte_part < 8/bits ; byte_part++)
+      unsigned int b;
+      uint32_t word = cheat_manager_state.matches[w] ;
+
+      for (b = 0 ; word && b < 32 ; b++)
       {
-         unsigned int prev_match;
+         unsigned int idx;
+         unsigned int address_mask;
+         unsigned int curr_val;
+         unsigned int item = w * 32 + b ;
 
-         if (bits < 8 )
-         {
-            prev_match = *(cheat_manager_state.matches+idx) & (mask << (byte_part*bits)) ;
-            if (prev_match)
-            {
-               if (!cheat_manager_add_new_code(cheat_manager_state.search_bit_size, idx, (mask << (byte_part*bits)),
-                     cheat_manager_state.big_endian, curr_val) )
-               {
-                  runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true);
-                  return 0 ;
-               }
-               num_added++ ;
-            }
-         }
-         else
+         if (!(word & (1U << b)))
+            continue ;
+
+         cheat_manager_match_item_address(item, &idx, &address_mask) ;
+         curr_val = cheat_manager_read_item(curr, idx, bytes_per_item, cheat_manager_state.big_endian) ;
+
+         if (!cheat_manager_add_new_code(cheat_manager_state.search_bit_size, idx, address_mask,
+               cheat_manager_state.big_endian, curr_val) )
          {
-            prev_match = *(cheat_manager_state.matches+idx) ;
-            if (prev_match)
-            {
-               if (!cheat_manager_add_new_code(cheat_manager_state.search_bit_size, idx, 0xFF,
-                     cheat_manager_state.big_endian, curr_val))
-               {
-                  runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true);
-                  return 0 ;
-               }
-               num_added++ ;
-            }
+            runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true);
+            return 0 ;
          }
-
+         num_added++ ;
       }
    }
 
@@ -1112,177 +1631,235 @@ void cheat_manager_apply_rumble(struct item_cheat *cheat, unsigned int curr_valu
    }
 }
 
-void cheat_manager_apply_retro_cheats(void)
+/**
+ * cheat_manager_compile_retro_cheats:
+ *
+ * Turns the enabled RetroArch-handler cheats into a flat list with
+ * their address, size and write mask already resolved, so applying
+ * them every frame doesn't have to walk and decode the whole cheat list.
+ *
+ * Returns: false if the list couldn't be allocated.
+ **/
+static bool cheat_manager_compile_retro_cheats(void)
 {
    unsigned i;
-   unsigned int mask           = 0;
-   unsigned int bytes_per_item = 1;
-   unsigned int bits           = 8;
-   unsigned int curr_val       = 0;
-   bool run_cheat              = true;
+   unsigned count = 0;
 
-   if ((!cheat_manager_state.cheats))
-      return;
+   for (i = 0 ; i < cheat_manager_state.size ; i++ )
+      if (cheat_manager_state.cheats[i].handler == CHEAT_HANDLER_TYPE_RETRO && cheat_manager_state.cheats[i].state)
+         count++ ;
+
+   if (count > cheat_manager_retro.capacity)
+   {
+      struct cheat_manager_retro_cheat *list = (struct cheat_manager_retro_cheat*)
+         realloc(cheat_manager_retro.list, count * sizeof(*list));
+
+      if (!list)
+         return false;
+
+      cheat_manager_retro.list     = list;
+      cheat_manager_retro.capacity = count;
+   }
+
+   cheat_manager_retro.count = 0;
 
    for (i = 0 ; i < cheat_manager_state.size ; i++ )
    {
-      unsigned char *curr;
-      unsigned int    idx;
-      bool set_value            = false;
-      unsigned int value_to_set = 0;
+      unsigned int mask           = 0;
+      unsigned int bytes_per_item = 1;
+      unsigned int bits           = 8;
+      struct item_cheat *cheat    = &cheat_manager_state.cheats[i];
+      struct cheat_manager_retro_cheat *out;
 
-      if (cheat_manager_state.cheats[i].handler != CHEAT_HANDLER_TYPE_RETRO || !cheat_manager_state.cheats[i].state)
+      if (cheat->handler != CHEAT_HANDLER_TYPE_RETRO || !cheat->state)
          continue ;
-      if (!cheat_manager_state.memory_initialized)
+
+      cheat_manager_setup_search_meta(cheat->memory_search_size, &bytes_per_item, &mask, &bits) ;
+
+      out                 = &cheat_manager_retro.list[cheat_manager_retro.count++];
+      out->ptr            = NULL;
+      out->cheat          = cheat->rumble_type != RUMBLE_TYPE_DISABLED ? cheat : NULL;
+      out->value          = cheat->value;
+      out->cheat_type     = cheat->cheat_type;
+      out->bytes_per_item = bytes_per_item;
+      out->write_mask     = bits < 8 ? (uint8_t)cheat->address_mask : 0xFF;
+      out->big_endian     = cheat->big_endian;
+      out->read_value     = out->cheat || cheat->cheat_type != CHEAT_TYPE_SET_TO_VALUE;
+
+      /* Disabled and out of range entries are kept, they still count
+       * as the cheat a preceding "run next if" applies to. */
+      if (cheat->address + bytes_per_item <= cheat_manager_state.actual_memory_size)
+         out->ptr         = cheat_manager_state.curr_memory_buf + cheat->address;
+   }
+
+   cheat_manager_retro.base       = cheat_manager_state.curr_memory_buf;
+   cheat_manager_retro.big_endian = cheat_manager_state.big_endian;
+   cheat_manager_retro.dirty      = false;
+
+   return true;
+}
+
+void cheat_manager_apply_retro_cheats(void)
+{
+   const struct cheat_manager_retro_cheat *cheat = NULL;
+   const struct cheat_manager_retro_cheat *end   = NULL;
+   bool run_cheat                                = true;
+   bool read_big_endian                          = false;
+
+   if ((!cheat_manager_state.cheats))
+      return;
+
+   if (     cheat_manager_retro.dirty
+         || cheat_manager_retro.base       != cheat_manager_state.curr_memory_buf
+         || cheat_manager_retro.big_endian != cheat_manager_state.big_endian)
+   {
+      unsigned i;
+
+      for (i = 0 ; i < cheat_manager_state.size ; i++ )
+         if (cheat_manager_state.cheats[i].handler == CHEAT_HANDLER_TYPE_RETRO && cheat_manager_state.cheats[i].state)
+            break ;
+
+      if (i < cheat_manager_state.size && !cheat_manager_state.memory_initialized)
          cheat_manager_initialize_memory(NULL, false) ;
 
       /* If we're still not initialized, something 
        * must have gone wrong - just bail */
-      if (!cheat_manager_state.memory_initialized)
+      if (i < cheat_manager_state.size && !cheat_manager_state.memory_initialized)
          return;
 
+      if (!cheat_manager_compile_retro_cheats())
+         return;
+   }
+
+   cheat           = cheat_manager_retro.list;
+   end             = cheat + cheat_manager_retro.count;
+   read_big_endian = cheat_manager_retro.big_endian;
+
+   for (; cheat < end; cheat++)
+   {
+      uint8_t *curr             = cheat->ptr;
+      unsigned int curr_val     = 0;
+      bool set_value            = false;
+      unsigned int value_to_set = 0;
+
       if (!run_cheat)
       {
          run_cheat = true ;
          continue ;
       }
-      cheat_manager_setup_search_meta(cheat_manager_state.cheats[i].memory_search_size, &bytes_per_item, &mask, &bits) ;
-      
-      curr = cheat_manager_state.curr_memory_buf ;
-      idx  = cheat_manager_state.cheats[i].address ;
 
-      switch (bytes_per_item)
+      if (!curr)
+         continue ;
+
+      if (cheat->read_value)
       {
-         case 2 :
-         {
-            curr_val = cheat_manager_state.big_endian ?
-                  (*(curr+idx)*256) + *(curr+idx+1) :
-                  *(curr+idx) + (*(curr+idx+1)*256) ;
-            break ;
-         }
-         case 4 :
-         {
-            curr_val = cheat_manager_state.big_endian ?
-                  (*(curr+idx)*256*256*256) + (*(curr+idx+1)*256*256) + (*(curr+idx+2)*256) + *(curr+idx+3) :
-                  *(curr+idx) + (*(curr+idx+1)*256) + (*(curr+idx+2)*256*256) + (*(curr+idx+3)*256*256*256) ;
-            break ;
-         }
-         case 1 :
-         default :
+         switch (cheat->bytes_per_item)
          {
-            curr_val = *(curr+idx) ;
-            break ;
+            case 2 :
+               curr_val = read_big_endian ?
+                     (curr[0] << 8) | curr[1] :
+                     curr[0] | (curr[1] << 8) ;
+               break ;
+            case 4 :
+               curr_val = read_big_endian ?
+                     ((unsigned)curr[0] << 24) | (curr[1] << 16) | (curr[2] << 8) | curr[3] :
+                     curr[0] | (curr[1] << 8) | (curr[2] << 16) | ((unsigned)curr[3] << 24) ;
+               break ;
+            default :
+               curr_val = curr[0] ;
+               break ;
          }
-      }
 
-      cheat_manager_apply_rumble(&cheat_manager_state.cheats[i], curr_val) ;
+         if (cheat->cheat)
+            cheat_manager_apply_rumble(cheat->cheat, curr_val) ;
+      }
 
-      switch (cheat_manager_state.cheats[i].cheat_type )
+      switch (cheat->cheat_type)
       {
          case CHEAT_TYPE_SET_TO_VALUE :
             set_value = true ;
-            value_to_set = cheat_manager_state.cheats[i].value ;
+            value_to_set = cheat->value ;
             break ;
          case CHEAT_TYPE_INCREASE_VALUE:
             set_value = true ;
-            value_to_set = curr_val + cheat_manager_state.cheats[i].value ;
+            value_to_set = curr_val + cheat->value ;
             break;
          case CHEAT_TYPE_DECREASE_VALUE:
             set_value = true ;
-            value_to_set = curr_val - cheat_manager_state.cheats[i].value ;
+            value_to_set = curr_val - cheat->value ;
             break;
          case CHEAT_TYPE_RUN_NEXT_IF_EQ:
-            if (!(curr_val == cheat_manager_state.cheats[i].value))
+            if (!(curr_val == cheat->value))
                run_cheat = false ;
             break;
          case CHEAT_TYPE_RUN_NEXT_IF_NEQ:
-            if (!(curr_val != cheat_manager_state.cheats[i].value ))
+            if (!(curr_val != cheat->value ))
                run_cheat = false ;
             break;
          case CHEAT_TYPE_RUN_NEXT_IF_LT:
-            if (!(cheat_manager_state.cheats[i].value <  curr_val))
+            if (!(cheat->value <  curr_val))
                run_cheat = false ;
             break;
          case CHEAT_TYPE_RUN_NEXT_IF_GT:
-            if (!(cheat_manager_state.cheats[i].value > curr_val))
+            if (!(cheat->value > curr_val))
                run_cheat = false ;
             break;
-
       }
-      if (set_value)
+
+      if (!set_value)
+         continue ;
+
+      switch (cheat->bytes_per_item)
       {
-         switch (bytes_per_item)
-         {
-            case 2 :
-               if  (cheat_manager_state.cheats[i].big_endian)
-               {
-                  *(curr+idx)   = (value_to_set >> 8) & 0xFF ;
-                  *(curr+idx+1) =  value_to_set & 0xFF ;
-               }
-               else
-               {
-                  *(curr+idx)   =  value_to_set & 0xFF ;
-                  *(curr+idx+1) = (value_to_set >> 8) & 0xFF ;
-
-               }
-               break ;
-            case 4 :
-               if  (cheat_manager_state.cheats[i].big_endian)
-               {
-                  *(curr+idx)   = (value_to_set >> 24) & 0xFF ;
-                  *(curr+idx+1) = (value_to_set >> 16) & 0xFF ;
-                  *(curr+idx+2) = (value_to_set >> 8) & 0xFF ;
-                  *(curr+idx+3) =  value_to_set & 0xFF ;
-               }
-               else
-               {
-                  *(curr+idx)   =  value_to_set & 0xFF ;
-                  *(curr+idx+1) = (value_to_set >> 8) & 0xFF ;
-                  *(curr+idx+2) = (value_to_set >> 16) & 0xFF ;
-                  *(curr+idx+3) = (value_to_set >> 24) & 0xFF ;
-
-               }
-               break ;
-            case 1 :
-               if (bits < 8)
-               {
-                  unsigned bitpos;
-                  unsigned char val = *(curr+idx);
-
-                  for (bitpos = 0 ; bitpos < 8 ; bitpos++)
-                  {
-                     if ((cheat_manager_state.cheats[i].address_mask>>bitpos)&0x01 )
-                     {
-                        mask = (~(1<<bitpos)&0xFF) ;
-                        /* Clear current bit value */
-                        val = val & mask ;
-                        /* Inject cheat bit value */
-                        val = val | (((value_to_set>>bitpos)&0x01)<<bitpos) ;
-                     }
-                  }
-                  *(curr+idx) = val ;
-               }
-               else
-                  *(curr+idx)   =  value_to_set & 0xFF;
-               break ;
-            default :
-               *(curr+idx)   =  value_to_set & 0xFF ;
-               break ;
-         }
+         case 2 :
+            if (cheat->big_endian)
+            {
+               curr[0] = (value_to_set >> 8) & 0xFF ;
+               curr[1] =  value_to_set & 0xFF ;
+            }
+            else
+            {
+               curr[0] =  value_to_set & 0xFF ;
+               curr[1] = (value_to_set >> 8) & 0xFF ;
+            }
+            break ;
+         case 4 :
+            if (cheat->big_endian)
+            {
+               curr[0] = (value_to_set >> 24) & 0xFF ;
+               curr[1] = (value_to_set >> 16) & 0xFF ;
+               curr[2] = (value_to_set >> 8) & 0xFF ;
+               curr[3] =  value_to_set & 0xFF ;
+            }
+            else
+            {
+               curr[0] =  value_to_set & 0xFF ;
+               curr[1] = (value_to_set >> 8) & 0xFF ;
+               curr[2] = (value_to_set >> 16) & 0xFF ;
+               curr[3] = (value_to_set >> 24) & 0xFF ;
+            }
+            break ;
+         default :
+            /* Only the bits in the address mask for sub-byte cheats */
+            curr[0] = (curr[0] & ~cheat->write_mask) | (value_to_set & cheat->write_mask) ;
+            break ;
       }
    }
 }
+
 void cheat_manager_match_action(enum cheat_match_action_type match_action, unsigned int target_match_idx, unsigned int *address, unsigned int *address_mask,
       unsigned int *prev_value, unsigned int *curr_value)
 {
-   unsigned int byte_part;
+   unsigned int w;
+   unsigned int words;
    unsigned int idx;
-   unsigned int start_idx;
+   unsigned int item_mask = 0 ;
    unsigned int mask = 0 ;
    unsigned int bytes_per_item = 1 ;
    unsigned int bits = 8 ;
    unsigned int curr_val = 0 ;
    unsigned int prev_val = 0 ;
+   unsigned int item = 0 ;
    unsigned char *curr = cheat_manager_state.curr_memory_buf ;
    unsigned char *prev = cheat_manager_state.prev_memory_buf ;
    unsigned int curr_match_idx = 0;
@@ -1296,135 +1873,75 @@ void cheat_manager_match_action(enum cheat_match_action_type match_action, unsig
    cheat_manager_setup_search_meta(cheat_manager_state.search_bit_size, &bytes_per_item, &mask, &bits);
 
    if (match_action == CHEAT_MATCH_ACTION_TYPE_BROWSE)
-      start_idx = *address ;
-   else
-      start_idx = 0 ;
+   {
+      idx = *address ;
+
+      if (idx + bytes_per_item > cheat_manager_state.total_memory_size)
+         return ;
+
+      *curr_value = cheat_manager_read_item(curr, idx, bytes_per_item, cheat_manager_state.big_endian) ;
+      *prev_value = prev ?
+            cheat_manager_read_item(prev, idx, bytes_per_item, cheat_manager_state.big_endian) : 0 ;
+      return ;
+   }
+
+   if (!prev || !cheat_manager_state.matches ||
+         cheat_manager_state.match_bit_size != cheat_manager_state.search_bit_size)
+      return;
+
+   /* Find the word holding the target match by counting whole words */
+   words = ((cheat_manager_state.total_memory_size * 8) / (1 << cheat_manager_state.search_bit_size) + 31) / 32 ;
 
-   for (idx = start_idx ; idx < cheat_manager_state.total_memory_size ; idx = idx + bytes_per_item)
+   for (w = 0 ; w < words ; w++)
    {
-      switch (bytes_per_item )
+      unsigned int in_word = cheat_manager_popcount32(cheat_manager_state.matches[w]) ;
+
+      if (curr_match_idx + in_word > target_match_idx)
+         break ;
+
+      curr_match_idx += in_word ;
+   }
+
+   if (w == words)
+      return;
+
+   for (item = w * 32 ; ; item++)
+   {
+      if (cheat_manager_state.matches[w] & (1U << (item & 31)))
       {
-         case 2 :
-            curr_val = cheat_manager_state.big_endian ?
-                  (*(curr+idx)*256) + *(curr+idx+1) :
-                  *(curr+idx) + (*(curr+idx+1)*256) ;
-            if (prev != NULL)
-               prev_val = cheat_manager_state.big_endian ?
-                     (*(prev+idx)*256) + *(prev+idx+1) :
-                     *(prev+idx) + (*(prev+idx+1)*256) ;
-            break ;
-         case 4 :
-            curr_val = cheat_manager_state.big_endian ?
-                  (*(curr+idx)*256*256*256) + (*(curr+idx+1)*256*256) + (*(curr+idx+2)*256) + *(curr+idx+3) :
-                  *(curr+idx) + (*(curr+idx+1)*256) + (*(curr+idx+2)*256*256) + (*(curr+idx+3)*256*256*256) ;
-            if (prev != NULL)
-               prev_val = cheat_manager_state.big_endian ?
-                     (*(prev+idx)*256*256*256) + (*(prev+idx+1)*256*256) + (*(prev+idx+2)*256) + *(prev+idx+3) :
-                     *(prev+idx) + (*(prev+idx+1)*256) + (*(prev+idx+2)*256*256) + (*(prev+idx+3)*256*256*256) ;
-            break ;
-         case 1 :
-         default :
-            curr_val = *(curr+idx) ;
-            if (prev != NULL)
-               prev_val = *(prev+idx) ;
+         if (curr_match_idx == target_match_idx)
             break ;
+         curr_match_idx++ ;
       }
+   }
 
-      if (match_action == CHEAT_MATCH_ACTION_TYPE_BROWSE)
-      {
-         *curr_value = curr_val;
-         *prev_value = prev_val;
-         return ;
-      }
+   cheat_manager_match_item_address(item, &idx, &item_mask) ;
+   curr_val = cheat_manager_read_item(curr, idx, bytes_per_item, cheat_manager_state.big_endian) ;
+   prev_val = cheat_manager_read_item(prev, idx, bytes_per_item, cheat_manager_state.big_endian) ;
 
-      if (!prev)
+   switch (match_action)
+   {
+      case CHEAT_MATCH_ACTION_TYPE_VIEW :
+         *address = idx ;
+         *address_mask = item_mask ;
+         *curr_value = curr_val ;
+         *prev_value = prev_val ;
          return;
-
-      for (byte_part = 0 ; byte_part < 8/bits ; byte_part++)
-      {
-         unsigned int prev_match ;
-
-         if (bits < 8 )
-         {
-            prev_match = *(cheat_manager_state.matches+idx) & (mask << (byte_part*bits)) ;
-            if (prev_match)
-            {
-               if (target_match_idx == curr_match_idx)
-               {
-                  switch (match_action)
-                  {
-                     case CHEAT_MATCH_ACTION_TYPE_BROWSE :
-                        return ;
-                     case CHEAT_MATCH_ACTION_TYPE_VIEW :
-                        *address = idx ;
-                        *address_mask = (mask << (byte_part*bits)) ;
-                        *curr_value = curr_val ;
-                        *prev_value = prev_val ;
-                        return;
-                     case CHEAT_MATCH_ACTION_TYPE_COPY :
-                        if (!cheat_manager_add_new_code(cheat_manager_state.search_bit_size, idx, (mask << (byte_part*bits)),
-                                 cheat_manager_state.big_endian, curr_val) )
-                           runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true);
-                        else
-                           runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true);
-                        return ;
-                     case CHEAT_MATCH_ACTION_TYPE_DELETE :
-                        if (bits < 8)
-                           *(cheat_manager_state.matches+idx) = *(cheat_manager_state.matches+idx) &
-                              (( ~(mask << (byte_part*bits))) & 0xFF );
-                        else
-                           memset(cheat_manager_state.matches+idx,0,bytes_per_item) ;
-                        if ( cheat_manager_state.num_matches > 0 )
-                           cheat_manager_state.num_matches-- ;
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true);
-                        return;
-                  }
-                  return;
-               }
-               curr_match_idx++ ;
-            }
-         }
+      case CHEAT_MATCH_ACTION_TYPE_COPY :
+         if (!cheat_manager_add_new_code(cheat_manager_state.search_bit_size, idx, item_mask,
+                  cheat_manager_state.big_endian, curr_val) )
+            runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true);
          else
-         {
-            prev_match = *(cheat_manager_state.matches+idx) ;
-            if (prev_match)
-            {
-               if (target_match_idx == curr_match_idx)
-               {
-                  switch (match_action)
-                  {
-                     case CHEAT_MATCH_ACTION_TYPE_BROWSE :
-                        return ;
-                     case CHEAT_MATCH_ACTION_TYPE_VIEW :
-                        *address = idx ;
-                        *address_mask = 0xFF ;
-                        *curr_value = curr_val ;
-                        *prev_value = prev_val ;
-                        return ;
-                     case CHEAT_MATCH_ACTION_TYPE_COPY :
-                        if ( !cheat_manager_add_new_code(cheat_manager_state.search_bit_size, idx, 0xFF,
-                                 cheat_manager_state.big_endian, curr_val) )
-                           runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true);
-                        else
-                           runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true);
-                        return ;
-                     case CHEAT_MATCH_ACTION_TYPE_DELETE :
-                        if ( bits < 8 )
-                           *(cheat_manager_state.matches+idx) = *(cheat_manager_state.matches+idx) &
-                              (( ~(mask << (byte_part*bits))) & 0xFF );
-                        else
-                           memset(cheat_manager_state.matches+idx,0,bytes_per_item) ;
-                        if ( cheat_manager_state.num_matches > 0 )
-                           cheat_manager_state.num_matches-- ;
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true);
-                        return ;
-                  }
-               }
-               curr_match_idx++ ;
-            }
-         }
-
-      }
+            runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true);
+         return ;
+      case CHEAT_MATCH_ACTION_TYPE_DELETE :
+         cheat_manager_state.matches[w] &= ~(1U << (item & 31)) ;
+         if ( cheat_manager_state.num_matches > 0 )
+            cheat_manager_state.num_matches-- ;
+         runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true);
+         return;
+      default:
+         break;
    }
 }
 int cheat_manager_copy_match(void *data, bool wraparound)
@@ -139,7 +139,10 @@ struct cheat_manager
    unsigned actual_memory_size ;
    uint8_t *curr_memory_buf ;
    uint8_t *prev_memory_buf ;
-   uint8_t *matches ;
+   /* One bit per search item, item i lives in bit (i & 31) of matches[i >> 5] */
+   uint32_t *matches ;
+   /* search_bit_size the matches bitmap was built for */
+   unsigned match_bit_size ;
    struct item_cheat working_cheat;
    unsigned match_idx ;
    unsigned match_action ;
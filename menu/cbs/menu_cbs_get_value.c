@@ -267,6 +267,10 @@ static void menu_action_setting_disp_set_label_audio_resampler_quality(
             strlcpy(s, "Highest",
                   len);
             break;
+         case RESAMPLER_QUALITY_POLYPHASE:
+            strlcpy(s, "Polyphase",
+                  len);
+            break;
          case RESAMPLER_QUALITY_NORMAL:
             strlcpy(s, "Normal",
                   len);
@@ -320,6 +320,9 @@ static int shader_action_parameter_left(unsigned type, const char *label, bool w
 
    video_shader_driver_get_current_shader(&shader_info);
 
+   if (!shader_info.data)
+      return menu_cbs_exit();
+
    param_prev = &shader_info.data->parameters[type - MENU_SETTINGS_SHADER_PARAMETER_0];
    param_menu = shader ? &shader->parameters[type -
       MENU_SETTINGS_SHADER_PARAMETER_0] : NULL;
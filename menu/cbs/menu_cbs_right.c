@@ -71,6 +71,9 @@ int shader_action_parameter_right(unsigned type, const char *label, bool wraparo
 
    video_shader_driver_get_current_shader(&shader_info);
 
+   if (!shader_info.data)
+      return menu_cbs_exit();
+
    param_prev = &shader_info.data->parameters[type - MENU_SETTINGS_SHADER_PARAMETER_0];
    param_menu = shader ? &shader->parameters[type -
       MENU_SETTINGS_SHADER_PARAMETER_0] : NULL;
@@ -122,6 +122,8 @@ default_sublabel_macro(action_bind_sublabel_input_hotkey_settings,         MENU_
 default_sublabel_macro(action_bind_sublabel_materialui_icons_enable,       MENU_ENUM_SUBLABEL_MATERIALUI_ICONS_ENABLE)
 default_sublabel_macro(action_bind_sublabel_add_content_list,              MENU_ENUM_SUBLABEL_ADD_CONTENT_LIST)
 default_sublabel_macro(action_bind_sublabel_video_frame_delay,             MENU_ENUM_SUBLABEL_VIDEO_FRAME_DELAY)
+default_sublabel_macro(action_bind_sublabel_video_frame_delay_auto,        MENU_ENUM_SUBLABEL_VIDEO_FRAME_DELAY_AUTO)
+default_sublabel_macro(action_bind_sublabel_video_frame_delay_auto_margin, MENU_ENUM_SUBLABEL_VIDEO_FRAME_DELAY_AUTO_MARGIN)
 default_sublabel_macro(action_bind_sublabel_video_black_frame_insertion,   MENU_ENUM_SUBLABEL_VIDEO_BLACK_FRAME_INSERTION)
 default_sublabel_macro(action_bind_sublabel_systeminfo_cpu_cores,          MENU_ENUM_SUBLABEL_CPU_CORES)
 default_sublabel_macro(action_bind_sublabel_toggle_gamepad_combo,          MENU_ENUM_SUBLABEL_INPUT_MENU_ENUM_TOGGLE_GAMEPAD_COMBO)
@@ -132,6 +134,7 @@ default_sublabel_macro(action_bind_sublabel_video_refresh_rate_auto,       MENU_
 default_sublabel_macro(action_bind_sublabel_video_hard_sync,               MENU_ENUM_SUBLABEL_VIDEO_HARD_SYNC)
 default_sublabel_macro(action_bind_sublabel_video_hard_sync_frames,        MENU_ENUM_SUBLABEL_VIDEO_HARD_SYNC_FRAMES)
 default_sublabel_macro(action_bind_sublabel_video_threaded,                MENU_ENUM_SUBLABEL_VIDEO_THREADED)
+default_sublabel_macro(action_bind_sublabel_video_shader_async_load,       MENU_ENUM_SUBLABEL_VIDEO_SHADER_ASYNC_LOAD)
 default_sublabel_macro(action_bind_sublabel_config_save_on_exit,           MENU_ENUM_SUBLABEL_CONFIG_SAVE_ON_EXIT)
 default_sublabel_macro(action_bind_sublabel_configuration_settings_list,   MENU_ENUM_SUBLABEL_CONFIGURATION_SETTINGS)
 default_sublabel_macro(action_bind_sublabel_configurations_list_list,      MENU_ENUM_SUBLABEL_CONFIGURATIONS_LIST)
@@ -150,6 +153,8 @@ default_sublabel_macro(action_bind_sublabel_input_bind_hold,               MENU_
 default_sublabel_macro(action_bind_sublabel_audio_volume,                  MENU_ENUM_SUBLABEL_AUDIO_VOLUME)
 default_sublabel_macro(action_bind_sublabel_audio_mixer_volume,            MENU_ENUM_SUBLABEL_AUDIO_MIXER_VOLUME)
 default_sublabel_macro(action_bind_sublabel_audio_sync,                    MENU_ENUM_SUBLABEL_AUDIO_SYNC)
+default_sublabel_macro(action_bind_sublabel_audio_pipeline_threaded,       MENU_ENUM_SUBLABEL_AUDIO_PIPELINE_THREADED)
+default_sublabel_macro(action_bind_sublabel_audio_latency_stats_enable,    MENU_ENUM_SUBLABEL_AUDIO_LATENCY_STATS_ENABLE)
 default_sublabel_macro(action_bind_sublabel_axis_threshold,                MENU_ENUM_SUBLABEL_INPUT_AXIS_THRESHOLD)
 default_sublabel_macro(action_bind_sublabel_input_turbo_period,            MENU_ENUM_SUBLABEL_INPUT_TURBO_PERIOD)
 default_sublabel_macro(action_bind_sublabel_input_duty_cycle,              MENU_ENUM_SUBLABEL_INPUT_DUTY_CYCLE)
@@ -193,6 +198,7 @@ default_sublabel_macro(action_bind_sublabel_input_overlay_hide_in_menu,    MENU_
 default_sublabel_macro(action_bind_sublabel_content_collection_list,       MENU_ENUM_SUBLABEL_CONTENT_COLLECTION_LIST)
 default_sublabel_macro(action_bind_sublabel_video_scale_integer,           MENU_ENUM_SUBLABEL_VIDEO_SCALE_INTEGER)
 default_sublabel_macro(action_bind_sublabel_video_gpu_screenshot,          MENU_ENUM_SUBLABEL_VIDEO_GPU_SCREENSHOT)
+default_sublabel_macro(action_bind_sublabel_screenshot_compression_level,  MENU_ENUM_SUBLABEL_SCREENSHOT_COMPRESSION_LEVEL)
 default_sublabel_macro(action_bind_sublabel_video_rotation,                MENU_ENUM_SUBLABEL_VIDEO_ROTATION)
 default_sublabel_macro(action_bind_sublabel_video_force_srgb_enable,       MENU_ENUM_SUBLABEL_VIDEO_FORCE_SRGB_DISABLE)
 default_sublabel_macro(action_bind_sublabel_video_fullscreen,              MENU_ENUM_SUBLABEL_VIDEO_FULLSCREEN)
@@ -202,6 +208,7 @@ default_sublabel_macro(action_bind_sublabel_savestate_auto_index,          MENU_
 default_sublabel_macro(action_bind_sublabel_block_sram_overwrite,          MENU_ENUM_SUBLABEL_BLOCK_SRAM_OVERWRITE)
 default_sublabel_macro(action_bind_sublabel_fastforward_ratio,             MENU_ENUM_SUBLABEL_FASTFORWARD_RATIO)
 default_sublabel_macro(action_bind_sublabel_vrr_runloop_enable,            MENU_ENUM_SUBLABEL_VRR_RUNLOOP_ENABLE)
+default_sublabel_macro(action_bind_sublabel_frame_pacing_precise,          MENU_ENUM_SUBLABEL_FRAME_PACING_PRECISE)
 default_sublabel_macro(action_bind_sublabel_slowmotion_ratio,              MENU_ENUM_SUBLABEL_SLOWMOTION_RATIO)
 default_sublabel_macro(action_bind_sublabel_run_ahead_enabled,             MENU_ENUM_SUBLABEL_RUN_AHEAD_ENABLED)
 default_sublabel_macro(action_bind_sublabel_run_ahead_secondary_instance,  MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_INSTANCE)
@@ -1497,6 +1504,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_VRR_RUNLOOP_ENABLE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_vrr_runloop_enable);
             break;
+         case MENU_ENUM_LABEL_FRAME_PACING_PRECISE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_frame_pacing_precise);
+            break;
          case MENU_ENUM_LABEL_BLOCK_SRAM_OVERWRITE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_block_sram_overwrite);
             break;
@@ -1521,6 +1531,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_VIDEO_GPU_SCREENSHOT:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_gpu_screenshot);
             break;
+         case MENU_ENUM_LABEL_SCREENSHOT_COMPRESSION_LEVEL:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_screenshot_compression_level);
+            break;
          case MENU_ENUM_LABEL_VIDEO_SCALE_INTEGER:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_scale_integer);
             break;
@@ -1647,6 +1660,12 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_AUDIO_SYNC:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_sync);
             break;
+         case MENU_ENUM_LABEL_AUDIO_PIPELINE_THREADED:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_pipeline_threaded);
+            break;
+         case MENU_ENUM_LABEL_AUDIO_LATENCY_STATS_ENABLE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_latency_stats_enable);
+            break;
          case MENU_ENUM_LABEL_AUDIO_VOLUME:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_volume);
             break;
@@ -1726,6 +1745,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_VIDEO_THREADED:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_threaded);
             break;
+         case MENU_ENUM_LABEL_VIDEO_SHADER_ASYNC_LOAD:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_shader_async_load);
+            break;
          case MENU_ENUM_LABEL_VIDEO_HARD_SYNC:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_hard_sync);
             break;
@@ -1759,6 +1781,12 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_VIDEO_FRAME_DELAY:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_frame_delay);
             break;
+         case MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_frame_delay_auto);
+            break;
+         case MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO_MARGIN:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_frame_delay_auto_margin);
+            break;
          case MENU_ENUM_LABEL_ADD_CONTENT_LIST:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_add_content_list);
             break;
@@ -43,6 +43,7 @@
 
 #include "../menu_driver.h"
 #include "../menu_animation.h"
+#include "../menu_thumbnail_cache.h"
 
 #include "../../core_info.h"
 #include "../../core.h"
@@ -1071,10 +1072,8 @@ static void stripes_update_thumbnail_image(void *data)
 
    if (!(string_is_empty(stripes->thumbnail_file_path)))
       {
-         if (filestream_exists(stripes->thumbnail_file_path))
-            task_push_image_load(stripes->thumbnail_file_path,
-                  menu_display_handle_thumbnail_upload, NULL);
-         else
+         if (!menu_thumbnail_cache_request(stripes->thumbnail_file_path,
+                  MENU_IMAGE_THUMBNAIL))
             stripes->thumbnail = 0;
 
          free(stripes->thumbnail_file_path);
@@ -1083,10 +1082,8 @@ static void stripes_update_thumbnail_image(void *data)
 
    if (!(string_is_empty(stripes->left_thumbnail_file_path)))
       {
-         if (filestream_exists(stripes->left_thumbnail_file_path))
-            task_push_image_load(stripes->left_thumbnail_file_path,
-                  menu_display_handle_left_thumbnail_upload, NULL);
-         else
+         if (!menu_thumbnail_cache_request(stripes->left_thumbnail_file_path,
+                  MENU_IMAGE_LEFT_THUMBNAIL))
             stripes->left_thumbnail = 0;
 
          free(stripes->left_thumbnail_file_path);
@@ -3463,22 +3460,19 @@ static bool stripes_load_image(void *userdata, void *data, enum menu_image_type
          break;
       case MENU_IMAGE_THUMBNAIL:
          {
-            struct texture_image *img  = (struct texture_image*)data;
+            /* Owned by the thumbnail cache */
+            menu_thumbnail_t *thumb        = (menu_thumbnail_t*)data;
             stripes->thumbnail_height      = stripes->thumbnail_width
-               * (float)img->height / (float)img->width;
-            video_driver_texture_unload(&stripes->thumbnail);
-            video_driver_texture_load(data,
-                  TEXTURE_FILTER_MIPMAP_LINEAR, &stripes->thumbnail);
+               * (float)thumb->height / (float)thumb->width;
+            stripes->thumbnail             = thumb->texture;
          }
          break;
       case MENU_IMAGE_LEFT_THUMBNAIL:
          {
-            struct texture_image *img  = (struct texture_image*)data;
+            menu_thumbnail_t *thumb             = (menu_thumbnail_t*)data;
             stripes->left_thumbnail_height      = stripes->left_thumbnail_width
-               * (float)img->height / (float)img->width;
-            video_driver_texture_unload(&stripes->left_thumbnail);
-            video_driver_texture_load(data,
-                  TEXTURE_FILTER_MIPMAP_LINEAR, &stripes->left_thumbnail);
+               * (float)thumb->height / (float)thumb->width;
+            stripes->left_thumbnail             = thumb->texture;
          }
          break;
       case MENU_IMAGE_SAVESTATE_THUMBNAIL:
@@ -4045,8 +4039,10 @@ static void stripes_context_destroy(void *data)
    for (i = 0; i < STRIPES_TEXTURE_LAST; i++)
       video_driver_texture_unload(&stripes->textures.list[i]);
 
-   video_driver_texture_unload(&stripes->thumbnail);
-   video_driver_texture_unload(&stripes->left_thumbnail);
+   /* Thumbnails belong to the thumbnail cache, which
+    * unloads them after the menu context is destroyed. */
+   stripes->thumbnail      = 0;
+   stripes->left_thumbnail = 0;
    video_driver_texture_unload(&stripes->savestate_thumbnail);
 
    stripes_context_destroy_horizontal_list(stripes);
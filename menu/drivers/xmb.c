@@ -43,6 +43,7 @@
 
 #include "../menu_driver.h"
 #include "../menu_animation.h"
+#include "../menu_thumbnail_cache.h"
 
 #include "../../core_info.h"
 #include "../../core.h"
@@ -1129,10 +1130,8 @@ static void xmb_update_thumbnail_image(void *data)
 
    if (!(string_is_empty(xmb->thumbnail_file_path)))
    {
-      if (filestream_exists(xmb->thumbnail_file_path))
-         task_push_image_load(xmb->thumbnail_file_path,
-               menu_display_handle_thumbnail_upload, NULL);
-      else
+      if (!menu_thumbnail_cache_request(xmb->thumbnail_file_path,
+               MENU_IMAGE_THUMBNAIL))
          xmb->thumbnail = 0;
 
       free(xmb->thumbnail_file_path);
@@ -1141,10 +1140,8 @@ static void xmb_update_thumbnail_image(void *data)
 
    if (!(string_is_empty(xmb->left_thumbnail_file_path)))
    {
-      if (filestream_exists(xmb->left_thumbnail_file_path))
-         task_push_image_load(xmb->left_thumbnail_file_path,
-               menu_display_handle_left_thumbnail_upload, NULL);
-      else
+      if (!menu_thumbnail_cache_request(xmb->left_thumbnail_file_path,
+               MENU_IMAGE_LEFT_THUMBNAIL))
          xmb->left_thumbnail = 0;
 
       free(xmb->left_thumbnail_file_path);
@@ -1197,6 +1194,67 @@ static void xmb_update_savestate_thumbnail_image(void *data)
       xmb->savestate_thumbnail = 0;
 }
 
+static void xmb_prefetch_thumbnail(xmb_handle_t *xmb, unsigned i)
+{
+   menu_entry_t entry;
+
+   menu_entry_init(&entry);
+   menu_entry_get(&entry, 0, i, NULL, true);
+
+   if (!string_is_empty(entry.path))
+      xmb_set_thumbnail_content(xmb, entry.path, 0 /* will be ignored */);
+
+   menu_entry_free(&entry);
+
+   if (!string_is_equal(xmb_thumbnails_ident('R'),
+            msg_hash_to_str(MENU_ENUM_LABEL_VALUE_OFF)))
+      xmb_update_thumbnail_path(xmb, i, 'R');
+   if (!string_is_equal(xmb_thumbnails_ident('L'),
+            msg_hash_to_str(MENU_ENUM_LABEL_VALUE_OFF)))
+      xmb_update_thumbnail_path(xmb, i, 'L');
+
+   menu_thumbnail_cache_prefetch(xmb->thumbnail_file_path);
+   menu_thumbnail_cache_prefetch(xmb->left_thumbnail_file_path);
+
+   free(xmb->thumbnail_file_path);
+   free(xmb->left_thumbnail_file_path);
+   xmb->thumbnail_file_path      = NULL;
+   xmb->left_thumbnail_file_path = NULL;
+}
+
+/* Decodes the thumbnails of the entries around the selection
+ * in the background, so scrolling through a playlist mostly
+ * hits the thumbnail cache. */
+static void xmb_prefetch_thumbnails(xmb_handle_t *xmb,
+      size_t selection, size_t end)
+{
+   unsigned n;
+   uintptr_t thumbnail      = xmb->thumbnail;
+   uintptr_t left_thumbnail = xmb->left_thumbnail;
+   char *content            = xmb->thumbnail_content
+      ? strdup(xmb->thumbnail_content) : NULL;
+
+   for (n = 1; n <= MENU_THUMBNAIL_CACHE_PREFETCH; n++)
+   {
+      if (selection + n < end)
+         xmb_prefetch_thumbnail(xmb, (unsigned)(selection + n));
+      if (selection >= n)
+         xmb_prefetch_thumbnail(xmb, (unsigned)(selection - n));
+   }
+
+   /* Looking up the paths touches the selection's state */
+   xmb->thumbnail      = thumbnail;
+   xmb->left_thumbnail = left_thumbnail;
+
+   if (content)
+   {
+      xmb_set_thumbnail_content(xmb, content, 0 /* will be ignored */);
+      free(content);
+   }
+   else
+      xmb_reset_thumbnail_content(xmb);
+}
+
 static unsigned xmb_get_system_tab(xmb_handle_t *xmb, unsigned i)
 {
    if (i <= xmb->system_tab_end)
@@ -1281,6 +1339,7 @@ static void xmb_selection_pointer_changed(
                   xmb_update_thumbnail_path(xmb, i, 'L');
                   xmb_update_thumbnail_image(xmb);
                }
+               xmb_prefetch_thumbnails(xmb, selection, end);
             }
             else if (((entry_type == FILE_TYPE_IMAGE || entry_type == FILE_TYPE_IMAGEVIEWER ||
                         entry_type == FILE_TYPE_RDB || entry_type == FILE_TYPE_RDB_ENTRY)
@@ -4394,22 +4453,19 @@ static bool xmb_load_image(void *userdata, void *data, enum menu_image_type type
          break;
       case MENU_IMAGE_THUMBNAIL:
          {
-            struct texture_image *img  = (struct texture_image*)data;
+            /* Owned by the thumbnail cache */
+            menu_thumbnail_t *thumb    = (menu_thumbnail_t*)data;
             xmb->thumbnail_height      = xmb->thumbnail_width
-               * (float)img->height / (float)img->width;
-            video_driver_texture_unload(&xmb->thumbnail);
-            video_driver_texture_load(data,
-                  TEXTURE_FILTER_MIPMAP_LINEAR, &xmb->thumbnail);
+               * (float)thumb->height / (float)thumb->width;
+            xmb->thumbnail             = thumb->texture;
          }
          break;
       case MENU_IMAGE_LEFT_THUMBNAIL:
          {
-            struct texture_image *img  = (struct texture_image*)data;
+            menu_thumbnail_t *thumb         = (menu_thumbnail_t*)data;
             xmb->left_thumbnail_height      = xmb->left_thumbnail_width
-               * (float)img->height / (float)img->width;
-            video_driver_texture_unload(&xmb->left_thumbnail);
-            video_driver_texture_load(data,
-                  TEXTURE_FILTER_MIPMAP_LINEAR, &xmb->left_thumbnail);
+               * (float)thumb->height / (float)thumb->width;
+            xmb->left_thumbnail             = thumb->texture;
          }
          break;
       case MENU_IMAGE_SAVESTATE_THUMBNAIL:
@@ -5040,8 +5096,10 @@ static void xmb_context_destroy(void *data)
    for (i = 0; i < XMB_TEXTURE_LAST; i++)
       video_driver_texture_unload(&xmb->textures.list[i]);
 
-   video_driver_texture_unload(&xmb->thumbnail);
-   video_driver_texture_unload(&xmb->left_thumbnail);
+   /* Thumbnails belong to the thumbnail cache, which
+    * unloads them after the menu context is destroyed. */
+   xmb->thumbnail      = 0;
+   xmb->left_thumbnail = 0;
    video_driver_texture_unload(&xmb->savestate_thumbnail);
 
    xmb_context_destroy_horizontal_list(xmb);
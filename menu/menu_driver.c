@@ -50,6 +50,7 @@
 #include "menu_entries.h"
 #include "widgets/menu_dialog.h"
 #include "menu_shader.h"
+#include "menu_thumbnail_cache.h"
 
 #include "../config.def.h"
 #include "../content.h"
@@ -1183,36 +1184,14 @@ static bool menu_driver_load_image(menu_ctx_load_image_t *load_image_info)
    return false;
 }
 
-void menu_display_handle_thumbnail_upload(void *task_data,
-      void *user_data, const char *err)
-{
-   menu_ctx_load_image_t load_image_info;
-   struct texture_image *img = (struct texture_image*)task_data;
-
-   load_image_info.data = img;
-   load_image_info.type = MENU_IMAGE_THUMBNAIL;
-
-   menu_driver_load_image(&load_image_info);
-
-   image_texture_free(img);
-   free(img);
-   free(user_data);
-}
-
-void menu_display_handle_left_thumbnail_upload(void *task_data,
-      void *user_data, const char *err)
+bool menu_driver_load_thumbnail(void *thumbnail, enum menu_image_type type)
 {
    menu_ctx_load_image_t load_image_info;
-   struct texture_image *img = (struct texture_image*)task_data;
 
-   load_image_info.data = img;
-   load_image_info.type = MENU_IMAGE_LEFT_THUMBNAIL;
+   load_image_info.data = thumbnail;
+   load_image_info.type = type;
 
-   menu_driver_load_image(&load_image_info);
-
-   image_texture_free(img);
-   free(img);
-   free(user_data);
+   return menu_driver_load_image(&load_image_info);
 }
 
 void menu_display_handle_savestate_thumbnail_upload(void *task_data,
@@ -2131,6 +2110,7 @@ bool menu_driver_ctl(enum rarch_menu_ctl_state state, void *data)
       case RARCH_MENU_CTL_DEINIT:
          if (menu_driver_ctx && menu_driver_ctx->context_destroy)
             menu_driver_ctx->context_destroy(menu_userdata);
+         menu_thumbnail_cache_free();
 
          if (menu_driver_data_own)
             return true;
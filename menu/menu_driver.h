@@ -755,15 +755,13 @@ void menu_display_timedate(menu_display_ctx_datetime_t *datetime);
 void menu_display_handle_wallpaper_upload(void *task_data,
       void *user_data, const char *err);
 
-void menu_display_handle_thumbnail_upload(void *task_data,
-      void *user_data, const char *err);
-
-void menu_display_handle_left_thumbnail_upload(void *task_data,
-      void *user_data, const char *err);
-
 void menu_display_handle_savestate_thumbnail_upload(void *task_data,
       void *user_data, const char *err);
 
+/* Hands a menu_thumbnail_t owned by the thumbnail cache
+ * to the menu driver. */
+bool menu_driver_load_thumbnail(void *thumbnail, enum menu_image_type type);
+
 void menu_display_push_quad(
       unsigned width, unsigned height,
       const float *colors, int x1, int y1,
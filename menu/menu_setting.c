@@ -4302,6 +4302,23 @@ static bool setting_append_list(
                   SD_FLAG_CMD_APPLY_AUTO
                   );
             menu_settings_list_current_add_cmd(list, list_info, CMD_EVENT_REINIT);
+
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.video_shader_async_load,
+                  MENU_ENUM_LABEL_VIDEO_SHADER_ASYNC_LOAD,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_SHADER_ASYNC_LOAD,
+                  video_shader_async_load,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE
+                  );
+            settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
 #endif
 
             CONFIG_BOOL(
@@ -4430,6 +4447,37 @@ static bool setting_append_list(
             menu_settings_list_current_add_range(list, list_info, 0, 15, 1, true, true);
             settings_data_list_current_add_flags(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.video_frame_delay_auto,
+                  MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DELAY_AUTO,
+                  frame_delay_auto,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE
+                  );
+            settings_data_list_current_add_flags(list, list_info, SD_FLAG_LAKKA_ADVANCED);
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.video_frame_delay_auto_margin,
+                  MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO_MARGIN,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DELAY_AUTO_MARGIN,
+                  frame_delay_auto_margin,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            menu_settings_list_current_add_range(list, list_info, 0, 15, 1, true, true);
+            settings_data_list_current_add_flags(list, list_info, SD_FLAG_LAKKA_ADVANCED);
+
 #if !defined(RARCH_MOBILE)
             {
                gfx_ctx_flags_t flags;
@@ -4481,6 +4529,20 @@ static bool setting_append_list(
                   );
             settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
 
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.screenshot_compression_level,
+                  MENU_ENUM_LABEL_SCREENSHOT_COMPRESSION_LEVEL,
+                  MENU_ENUM_LABEL_VALUE_SCREENSHOT_COMPRESSION_LEVEL,
+                  screenshot_compression_level,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            menu_settings_list_current_add_range(list, list_info, 0, 9, 1, true, true);
+            settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+
             CONFIG_BOOL(
                   list, list_info,
                   &settings->bools.video_crop_overscan,
@@ -4649,6 +4711,44 @@ static bool setting_append_list(
                );
          settings_data_list_current_add_flags(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
+#ifdef HAVE_THREADS
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.audio_pipeline_threaded,
+               MENU_ENUM_LABEL_AUDIO_PIPELINE_THREADED,
+               MENU_ENUM_LABEL_VALUE_AUDIO_PIPELINE_THREADED,
+               audio_pipeline_threaded,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_CMD_APPLY_AUTO
+               );
+         menu_settings_list_current_add_cmd(list, list_info, CMD_EVENT_AUDIO_REINIT);
+         settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+#endif
+
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.audio_latency_stats_enable,
+               MENU_ENUM_LABEL_AUDIO_LATENCY_STATS_ENABLE,
+               MENU_ENUM_LABEL_VALUE_AUDIO_LATENCY_STATS_ENABLE,
+               audio_latency_stats_enable,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_CMD_APPLY_AUTO
+               );
+         menu_settings_list_current_add_cmd(list, list_info, CMD_EVENT_AUDIO_REINIT);
+         settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+
          CONFIG_UINT(
                list, list_info,
                &settings->uints.audio_latency,
@@ -4675,7 +4775,7 @@ static bool setting_append_list(
                parent_group,
                general_write_handler,
                general_read_handler);
-         menu_settings_list_current_add_range(list, list_info, RESAMPLER_QUALITY_DONTCARE, RESAMPLER_QUALITY_HIGHEST, 1.0, true, true);
+         menu_settings_list_current_add_range(list, list_info, RESAMPLER_QUALITY_DONTCARE, RESAMPLER_QUALITY_POLYPHASE, 1.0, true, true);
 
          CONFIG_FLOAT(
                list, list_info,
@@ -5407,6 +5507,23 @@ static bool setting_append_list(
                SD_FLAG_NONE
                );
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.frame_pacing_precise,
+               MENU_ENUM_LABEL_FRAME_PACING_PRECISE,
+               MENU_ENUM_LABEL_VALUE_FRAME_PACING_PRECISE,
+               frame_pacing_precise,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE
+               );
+         settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+
          CONFIG_FLOAT(
                list, list_info,
                &settings->floats.slowmotion_ratio,
@@ -0,0 +1,289 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <formats/image.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#include "menu_thumbnail_cache.h"
+
+#include "../gfx/video_driver.h"
+#include "../tasks/tasks_internal.h"
+
+/* Decoded RGBA size the cached textures may take up in total. */
+#define MENU_THUMBNAIL_CACHE_BUDGET  (64 * 1024 * 1024)
+
+/* Prefetches in flight; requests for the selection always go through. */
+#define MENU_THUMBNAIL_CACHE_PENDING 8
+
+#define MENU_THUMBNAIL_CACHE_SLOTS   2
+
+typedef struct menu_thumbnail_entry
+{
+   char *path;
+   menu_thumbnail_t thumbnail;
+   size_t size;
+   unsigned last_used;
+   bool pending;
+   struct menu_thumbnail_entry *next;
+} menu_thumbnail_entry_t;
+
+/* All callers run on the main thread, the image task
+ * callbacks included, so no locking is needed. */
+static menu_thumbnail_entry_t *menu_thumbnail_entries = NULL;
+static size_t menu_thumbnail_cache_size               = 0;
+static unsigned menu_thumbnail_cache_counter          = 0;
+
+/* Path each thumbnail slot is waiting for and the one it
+ * currently shows. Neither may be evicted. */
+static char *menu_thumbnail_wanted[MENU_THUMBNAIL_CACHE_SLOTS];
+static char *menu_thumbnail_shown[MENU_THUMBNAIL_CACHE_SLOTS];
+
+static int menu_thumbnail_cache_slot(enum menu_image_type type)
+{
+   switch (type)
+   {
+      case MENU_IMAGE_THUMBNAIL:
+         return 0;
+      case MENU_IMAGE_LEFT_THUMBNAIL:
+         return 1;
+      default:
+         break;
+   }
+
+   return -1;
+}
+
+static void menu_thumbnail_cache_set_path(char **dst, const char *path)
+{
+   if (*dst)
+      free(*dst);
+   *dst = path ? strdup(path) : NULL;
+}
+
+static menu_thumbnail_entry_t *menu_thumbnail_cache_find(const char *path)
+{
+   menu_thumbnail_entry_t *entry = NULL;
+
+   for (entry = menu_thumbnail_entries; entry; entry = entry->next)
+      if (string_is_equal(entry->path, path))
+         return entry;
+
+   return NULL;
+}
+
+static bool menu_thumbnail_cache_in_use(const menu_thumbnail_entry_t *entry)
+{
+   unsigned i;
+
+   for (i = 0; i < MENU_THUMBNAIL_CACHE_SLOTS; i++)
+      if (     string_is_equal(menu_thumbnail_wanted[i], entry->path)
+            || string_is_equal(menu_thumbnail_shown[i],  entry->path))
+         return true;
+
+   return false;
+}
+
+static void menu_thumbnail_cache_remove(menu_thumbnail_entry_t *entry)
+{
+   menu_thumbnail_entry_t **ptr = &menu_thumbnail_entries;
+
+   while (*ptr && *ptr != entry)
+      ptr = &(*ptr)->next;
+   if (*ptr)
+      *ptr = entry->next;
+
+   if (entry->thumbnail.texture)
+      video_driver_texture_unload(&entry->thumbnail.texture);
+
+   menu_thumbnail_cache_size -= entry->size;
+
+   free(entry->path);
+   free(entry);
+}
+
+static void menu_thumbnail_cache_evict(void)
+{
+   while (menu_thumbnail_cache_size > MENU_THUMBNAIL_CACHE_BUDGET)
+   {
+      menu_thumbnail_entry_t *entry  = NULL;
+      menu_thumbnail_entry_t *oldest = NULL;
+
+      for (entry = menu_thumbnail_entries; entry; entry = entry->next)
+      {
+         if (entry->pending || menu_thumbnail_cache_in_use(entry))
+            continue;
+
+         if (!oldest || (menu_thumbnail_cache_counter - entry->last_used) >
+               (menu_thumbnail_cache_counter - oldest->last_used))
+            oldest = entry;
+      }
+
+      if (!oldest)
+         break;
+
+      menu_thumbnail_cache_remove(oldest);
+   }
+}
+
+static void menu_thumbnail_cache_deliver(menu_thumbnail_entry_t *entry,
+      unsigned slot)
+{
+   menu_driver_load_thumbnail(&entry->thumbnail, slot == 0
+         ? MENU_IMAGE_THUMBNAIL : MENU_IMAGE_LEFT_THUMBNAIL);
+
+   menu_thumbnail_cache_set_path(&menu_thumbnail_shown[slot], entry->path);
+}
+
+static void menu_thumbnail_cache_handle_upload(void *task_data,
+      void *user_data, const char *err)
+{
+   unsigned i;
+   struct texture_image *img     = (struct texture_image*)task_data;
+   char *path                    = (char*)user_data;
+   menu_thumbnail_entry_t *entry = menu_thumbnail_cache_find(path);
+
+   /* Stale if the cache was freed or the entry was
+    * already filled in by another decode of the same file. */
+   if (!entry || !entry->pending)
+      goto end;
+
+   if (!img || !img->pixels || !img->width || !img->height)
+   {
+      menu_thumbnail_cache_remove(entry);
+      goto end;
+   }
+
+   video_driver_texture_load(img,
+         TEXTURE_FILTER_MIPMAP_LINEAR, &entry->thumbnail.texture);
+
+   entry->thumbnail.width     = img->width;
+   entry->thumbnail.height    = img->height;
+   entry->size                = img->width * img->height * sizeof(uint32_t);
+   entry->pending             = false;
+   menu_thumbnail_cache_size += entry->size;
+
+   for (i = 0; i < MENU_THUMBNAIL_CACHE_SLOTS; i++)
+      if (string_is_equal(menu_thumbnail_wanted[i], path))
+         menu_thumbnail_cache_deliver(entry, i);
+
+   menu_thumbnail_cache_evict();
+
+end:
+   image_texture_free(img);
+   free(img);
+   free(path);
+}
+
+static menu_thumbnail_entry_t *menu_thumbnail_cache_load(const char *path)
+{
+   menu_thumbnail_entry_t *entry = (menu_thumbnail_entry_t*)
+      calloc(1, sizeof(*entry));
+
+   if (!entry)
+      return NULL;
+
+   entry->path            = strdup(path);
+   entry->pending         = true;
+   entry->last_used       = menu_thumbnail_cache_counter++;
+   entry->next            = menu_thumbnail_entries;
+   menu_thumbnail_entries = entry;
+
+   if (!task_push_image_load(path,
+            menu_thumbnail_cache_handle_upload, strdup(path)))
+   {
+      menu_thumbnail_cache_remove(entry);
+      return NULL;
+   }
+
+   return entry;
+}
+
+bool menu_thumbnail_cache_request(const char *path,
+      enum menu_image_type type)
+{
+   menu_thumbnail_entry_t *entry = NULL;
+   int slot                      = menu_thumbnail_cache_slot(type);
+
+   if (slot < 0)
+      return false;
+
+   if (string_is_empty(path) || !filestream_exists(path))
+   {
+      menu_thumbnail_cache_set_path(&menu_thumbnail_wanted[slot], NULL);
+      return false;
+   }
+
+   menu_thumbnail_cache_set_path(&menu_thumbnail_wanted[slot], path);
+
+   entry = menu_thumbnail_cache_find(path);
+
+   if (!entry)
+      menu_thumbnail_cache_load(path);
+   else
+   {
+      entry->last_used = menu_thumbnail_cache_counter++;
+
+      if (!entry->pending)
+         menu_thumbnail_cache_deliver(entry, slot);
+   }
+
+   return true;
+}
+
+void menu_thumbnail_cache_prefetch(const char *path)
+{
+   unsigned pending              = 0;
+   menu_thumbnail_entry_t *entry = NULL;
+
+   if (string_is_empty(path))
+      return;
+
+   for (entry = menu_thumbnail_entries; entry; entry = entry->next)
+   {
+      if (string_is_equal(entry->path, path))
+      {
+         entry->last_used = menu_thumbnail_cache_counter++;
+         return;
+      }
+
+      if (entry->pending)
+         pending++;
+   }
+
+   if (pending >= MENU_THUMBNAIL_CACHE_PENDING || !filestream_exists(path))
+      return;
+
+   menu_thumbnail_cache_load(path);
+}
+
+void menu_thumbnail_cache_free(void)
+{
+   unsigned i;
+
+   while (menu_thumbnail_entries)
+      menu_thumbnail_cache_remove(menu_thumbnail_entries);
+
+   for (i = 0; i < MENU_THUMBNAIL_CACHE_SLOTS; i++)
+   {
+      menu_thumbnail_cache_set_path(&menu_thumbnail_wanted[i], NULL);
+      menu_thumbnail_cache_set_path(&menu_thumbnail_shown[i],  NULL);
+   }
+
+   menu_thumbnail_cache_size = 0;
+}
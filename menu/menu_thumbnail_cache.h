@@ -0,0 +1,76 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MENU_THUMBNAIL_CACHE_H
+#define _MENU_THUMBNAIL_CACHE_H
+
+#include <stdint.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+#include "menu_driver.h"
+
+RETRO_BEGIN_DECLS
+
+/* Number of entries on each side of the selection
+ * whose thumbnails get decoded ahead of time. */
+#define MENU_THUMBNAIL_CACHE_PREFETCH 3
+
+/* Passed as the data of MENU_IMAGE_THUMBNAIL and
+ * MENU_IMAGE_LEFT_THUMBNAIL to the menu driver's load_image.
+ * The texture is owned by the cache and must not be
+ * unloaded by the menu driver. */
+typedef struct menu_thumbnail
+{
+   uintptr_t texture;
+   unsigned width;
+   unsigned height;
+} menu_thumbnail_t;
+
+/**
+ * menu_thumbnail_cache_request:
+ * @path                 : Path to the thumbnail image.
+ * @type                 : MENU_IMAGE_THUMBNAIL or MENU_IMAGE_LEFT_THUMBNAIL.
+ *
+ * Hands the thumbnail at @path to the menu driver through
+ * menu_driver_load_thumbnail, right away if it is cached or once
+ * it has been decoded in the background otherwise.
+ *
+ * Returns: false if @path doesn't exist, true otherwise.
+ **/
+bool menu_thumbnail_cache_request(const char *path,
+      enum menu_image_type type);
+
+/**
+ * menu_thumbnail_cache_prefetch:
+ * @path                 : Path to the thumbnail image.
+ *
+ * Starts decoding the thumbnail at @path in the background
+ * so that a later request for it can be served from the cache.
+ **/
+void menu_thumbnail_cache_prefetch(const char *path);
+
+/**
+ * menu_thumbnail_cache_free:
+ *
+ * Unloads all cached textures. Must be called while the
+ * video context they were created on is still alive.
+ **/
+void menu_thumbnail_cache_free(void);
+
+RETRO_END_DECLS
+
+#endif
@@ -712,8 +712,11 @@ enum msg_hash_enums
    MENU_LABEL(VIDEO_SOFT_FILTER),
    MENU_LABEL(VIDEO_MAX_SWAPCHAIN_IMAGES),
    MENU_LABEL(VIDEO_GPU_SCREENSHOT),
+   MENU_LABEL(SCREENSHOT_COMPRESSION_LEVEL),
    MENU_LABEL(VIDEO_BLACK_FRAME_INSERTION),
    MENU_LABEL(VIDEO_FRAME_DELAY),
+   MENU_LABEL(VIDEO_FRAME_DELAY_AUTO),
+   MENU_LABEL(VIDEO_FRAME_DELAY_AUTO_MARGIN),
    MENU_LABEL(VIDEO_VSYNC),
    MENU_LABEL(VIDEO_ADAPTIVE_VSYNC),
    MENU_LABEL(VIDEO_HARD_SYNC),
@@ -740,6 +743,7 @@ enum msg_hash_enums
    MENU_LABEL(VIDEO_ALLOW_ROTATE),
    MENU_LABEL(VIDEO_SHARED_CONTEXT),
    MENU_LABEL(VIDEO_THREADED),
+   MENU_LABEL(VIDEO_SHADER_ASYNC_LOAD),
 
 
    MENU_LABEL(VIDEO_SWAP_INTERVAL),
@@ -1162,6 +1166,8 @@ enum msg_hash_enums
    MENU_LABEL(AUDIO_MUTE),
    MENU_LABEL(AUDIO_MIXER_MUTE),
    MENU_LABEL(AUDIO_SYNC),
+   MENU_LABEL(AUDIO_PIPELINE_THREADED),
+   MENU_LABEL(AUDIO_LATENCY_STATS_ENABLE),
    MENU_LABEL(AUDIO_VOLUME),
    MENU_LABEL(AUDIO_MIXER_VOLUME),
    MENU_LABEL(AUDIO_RATE_CONTROL_DELTA),
@@ -1322,6 +1328,7 @@ enum msg_hash_enums
 
    MENU_LABEL(FASTFORWARD_RATIO),
    MENU_LABEL(VRR_RUNLOOP_ENABLE),
+   MENU_LABEL(FRAME_PACING_PRECISE),
    MENU_LABEL(REWIND_ENABLE),
    MENU_LABEL(CHEAT_APPLY_AFTER_TOGGLE),
    MENU_LABEL(CHEAT_APPLY_AFTER_LOAD),
@@ -23,6 +23,9 @@
 #include <civetweb/civetweb.h>
 #include <string/stdstring.h>
 #include <compat/zlib.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "../../core.h"
 #include "../../retroarch.h"
@@ -34,6 +37,7 @@
 
 #define BASIC_INFO "info"
 #define MEMORY_MAP "memoryMap"
+#define MEMORY_WATCH "memoryWatch"
 
 static struct mg_callbacks s_httpserver_callbacks;
 static struct mg_context   *s_httpserver_ctx       = NULL;
@@ -551,6 +555,441 @@ static int httpserver_handle_mmaps(struct mg_connection* conn, void* cbdata)
    return httpserver_handle_get_mmaps(conn, cbdata);
 }
 
+/*============================================================
+MEMORY WATCH
+============================================================ */
+
+#ifdef HAVE_THREADS
+#define HTTPSERVER_WATCH_MAX        8
+#define HTTPSERVER_WATCH_MAX_RANGES 16
+#define HTTPSERVER_WATCH_MAX_SIZE   (16 * 1024 * 1024)
+#define HTTPSERVER_WATCH_BLOCK      32
+
+typedef struct
+{
+   unsigned id;
+   size_t start;
+   size_t length;
+   size_t offset;   /* Position of the range inside the snapshots */
+} httpserver_watch_range_t;
+
+typedef struct
+{
+   bool active;
+   bool pending;
+   bool closed;
+   unsigned divisor;
+   unsigned counter;
+   uint32_t frame;
+   uint32_t snapshot_frame;
+   unsigned num_ranges;
+   httpserver_watch_range_t ranges[HTTPSERVER_WATCH_MAX_RANGES];
+   size_t size;
+   uint8_t *snapshot;   /* Filled by the main thread */
+   uint8_t *current;    /* Owned by the connection thread */
+   uint8_t *previous;   /* Last state sent to the client */
+} httpserver_watch_t;
+
+static httpserver_watch_t s_httpserver_watches[HTTPSERVER_WATCH_MAX];
+static unsigned           s_httpserver_watch_count = 0;
+static bool               s_httpserver_watch_quit  = false;
+static slock_t           *s_httpserver_watch_lock  = NULL;
+static scond_t           *s_httpserver_watch_cond  = NULL;
+
+static void httpserver_watch_write32(uint8_t *dest, uint32_t value)
+{
+   dest[0] = (uint8_t)value;
+   dest[1] = (uint8_t)(value >> 8);
+   dest[2] = (uint8_t)(value >> 16);
+   dest[3] = (uint8_t)(value >> 24);
+}
+
+static bool httpserver_watch_parse(httpserver_watch_t *watch,
+      const char *query, const rarch_memory_map_t *mmaps)
+{
+   const char *param = NULL;
+   char *end         = NULL;
+
+   watch->divisor    = 1;
+   watch->num_ranges = 0;
+   watch->size       = 0;
+
+   if (!query)
+      return false;
+
+   param = strstr(query, "divisor=");
+
+   if (param)
+   {
+      watch->divisor = (unsigned)strtoul(param + 8, NULL, 10);
+
+      if (watch->divisor == 0)
+         watch->divisor = 1;
+   }
+
+   param = strstr(query, "ranges=");
+
+   if (!param)
+      return false;
+
+   param += 7;
+
+   for (;;)
+   {
+      const struct retro_memory_descriptor *mmap = NULL;
+      httpserver_watch_range_t *range            = NULL;
+
+      if (watch->num_ranges == HTTPSERVER_WATCH_MAX_RANGES)
+         return false;
+
+      range        = &watch->ranges[watch->num_ranges];
+      range->id    = (unsigned)strtoul(param, &end, 10);
+
+      if (end == param || *end != ':' || range->id >= mmaps->num_descriptors)
+         return false;
+
+      mmap         = &mmaps->descriptors[range->id].core;
+
+      if (!mmap->ptr || mmap->len == 0)
+         return false;
+
+      param        = end + 1;
+      range->start = (size_t)strtoull(param, &end, 0);
+
+      if (end == param || *end != ':' || range->start >= mmap->len)
+         return false;
+
+      param         = end + 1;
+      range->length = (size_t)strtoull(param, &end, 0);
+
+      if (end == param || range->length == 0)
+         return false;
+
+      if (range->length > mmap->len - range->start)
+         range->length = mmap->len - range->start;
+
+      if (range->length > HTTPSERVER_WATCH_MAX_SIZE - watch->size)
+         return false;
+
+      range->offset = watch->size;
+      watch->size  += range->length;
+      watch->num_ranges++;
+
+      if (*end != ',')
+         break;
+
+      param = end + 1;
+   }
+
+   return true;
+}
+
+/**
+ * httpserver_watch_delta:
+ * @watch              : the subscription.
+ * @out                : buffer receiving the delta records.
+ * @first              : send every range in full.
+ *
+ * Compares the current snapshot against the last one sent, block
+ * by block, and writes one record per run of changed blocks:
+ * range index, offset in the range and length (little endian
+ * uint32_t each), followed by the new bytes.
+ *
+ * Returns: number of bytes written to @out.
+ **/
+static size_t httpserver_watch_delta(const httpserver_watch_t *watch,
+      uint8_t *out, bool first)
+{
+   unsigned r;
+   size_t written = 0;
+
+   for (r = 0; r < watch->num_ranges; r++)
+   {
+      const httpserver_watch_range_t *range = &watch->ranges[r];
+      const uint8_t *curr = watch->current  + range->offset;
+      const uint8_t *prev = watch->previous + range->offset;
+      size_t pos          = 0;
+
+      while (pos < range->length)
+      {
+         size_t run_start;
+         size_t block = range->length - pos;
+
+         if (block > HTTPSERVER_WATCH_BLOCK)
+            block = HTTPSERVER_WATCH_BLOCK;
+
+         if (!first && !memcmp(curr + pos, prev + pos, block))
+         {
+            pos += block;
+            continue;
+         }
+
+         run_start = pos;
+         pos      += block;
+
+         while (pos < range->length)
+         {
+            block = range->length - pos;
+
+            if (block > HTTPSERVER_WATCH_BLOCK)
+               block = HTTPSERVER_WATCH_BLOCK;
+
+            if (!first && !memcmp(curr + pos, prev + pos, block))
+               break;
+
+            pos += block;
+         }
+
+         httpserver_watch_write32(out + written, r);
+         httpserver_watch_write32(out + written + 4, (uint32_t)run_start);
+         httpserver_watch_write32(out + written + 8, (uint32_t)(pos - run_start));
+         memcpy(out + written + 12, curr + run_start, pos - run_start);
+         written += 12 + pos - run_start;
+      }
+   }
+
+   return written;
+}
+
+static int httpserver_watch_send_chunk(struct mg_connection* conn,
+      const void *data, size_t size)
+{
+   if (mg_printf(conn, "%x\r\n", (unsigned)size) <= 0)
+      return 0;
+
+   if (size && mg_write(conn, data, size) <= 0)
+      return 0;
+
+   return mg_write(conn, "\r\n", 2) > 0;
+}
+
+/**
+ * httpserver_handle_memory_watch:
+ *
+ * GET /memoryWatch?ranges=<id>:<start>:<length>[,...][&divisor=<n>]
+ *
+ * Keeps the connection open and streams the watched memory map
+ * ranges as a chunked application/octet-stream, one chunk every
+ * @divisor frames in which something changed. Each chunk holds the
+ * frame number counted from the subscription, the uncompressed and
+ * the stored size (little endian uint32_t each) followed by the
+ * delta records of httpserver_watch_delta, deflated at Z_BEST_SPEED
+ * unless that doesn't make them smaller, in which case both sizes
+ * are equal.
+ * The first chunk carries every range in full.
+ **/
+static int httpserver_handle_memory_watch(struct mg_connection* conn, void* cbdata)
+{
+   unsigned slot;
+   size_t delta_cap;
+   uLong packet_cap;
+   bool first                        = true;
+   httpserver_watch_t *watch         = NULL;
+   uint8_t *delta                    = NULL;
+   Bytef *packet                     = NULL;
+   const struct mg_request_info* req = mg_get_request_info(conn);
+   rarch_system_info_t *system       = runloop_get_system_info();
+
+   if (strcmp(req->request_method, "GET"))
+      return httpserver_error(conn, 405, "Unimplemented method in %s: %s", __FUNCTION__, req->request_method);
+
+   slock_lock(s_httpserver_watch_lock);
+
+   for (slot = 0; slot < HTTPSERVER_WATCH_MAX; slot++)
+   {
+      if (!s_httpserver_watches[slot].active)
+         break;
+   }
+
+   if (slot == HTTPSERVER_WATCH_MAX)
+   {
+      slock_unlock(s_httpserver_watch_lock);
+      return httpserver_error(conn, 500, "Too many memory watches in %s", __FUNCTION__);
+   }
+
+   watch = &s_httpserver_watches[slot];
+   memset(watch, 0, sizeof(*watch));
+
+   if (!httpserver_watch_parse(watch, req->query_string, &system->mmaps))
+   {
+      slock_unlock(s_httpserver_watch_lock);
+      return httpserver_error(conn, 500, "Malformed request in %s: %s", __FUNCTION__,
+            req->query_string ? req->query_string : "");
+   }
+
+   delta_cap  = watch->size + (watch->size / HTTPSERVER_WATCH_BLOCK
+         + watch->num_ranges) * 12;
+   packet_cap = compressBound(delta_cap);
+
+   watch->snapshot = (uint8_t*)malloc(watch->size);
+   watch->current  = (uint8_t*)malloc(watch->size);
+   watch->previous = (uint8_t*)malloc(watch->size);
+   delta           = (uint8_t*)malloc(delta_cap);
+   packet          = (Bytef*)malloc(12 + (delta_cap > packet_cap ? delta_cap : packet_cap));
+
+   if (!watch->snapshot || !watch->current || !watch->previous || !delta || !packet)
+   {
+      free(watch->snapshot);
+      free(watch->current);
+      free(watch->previous);
+      free(delta);
+      free(packet);
+      slock_unlock(s_httpserver_watch_lock);
+      return httpserver_error(conn, 500, "Out of memory in %s", __FUNCTION__);
+   }
+
+   watch->active = true;
+   s_httpserver_watch_count++;
+   slock_unlock(s_httpserver_watch_lock);
+
+   mg_printf(conn,
+         "HTTP/1.1 200 OK\r\n"
+         "Content-Type: application/octet-stream\r\n"
+         "Transfer-Encoding: chunked\r\n"
+         "Cache-Control: no-cache\r\n\r\n");
+
+   for (;;)
+   {
+      size_t raw_size;
+      uLong stored_size;
+      uint8_t *swap;
+      uint32_t frame;
+
+      slock_lock(s_httpserver_watch_lock);
+
+      while (!watch->pending && !watch->closed && !s_httpserver_watch_quit)
+         scond_wait_timeout(s_httpserver_watch_cond, s_httpserver_watch_lock, 1000000);
+
+      if (watch->closed || s_httpserver_watch_quit)
+      {
+         slock_unlock(s_httpserver_watch_lock);
+         break;
+      }
+
+      swap            = watch->snapshot;
+      watch->snapshot = watch->current;
+      watch->current  = swap;
+      watch->pending  = false;
+      frame           = watch->snapshot_frame;
+      slock_unlock(s_httpserver_watch_lock);
+
+      raw_size = httpserver_watch_delta(watch, delta, first);
+
+      swap            = watch->previous;
+      watch->previous = watch->current;
+      watch->current  = swap;
+
+      if (raw_size == 0)
+         continue;
+
+      first       = false;
+      stored_size = packet_cap;
+
+      if (compress2(packet + 12, &stored_size, delta, raw_size, Z_BEST_SPEED) != Z_OK
+            || stored_size >= raw_size)
+      {
+         memcpy(packet + 12, delta, raw_size);
+         stored_size = raw_size;
+      }
+
+      httpserver_watch_write32(packet, frame);
+      httpserver_watch_write32(packet + 4, (uint32_t)raw_size);
+      httpserver_watch_write32(packet + 8, (uint32_t)stored_size);
+
+      if (!httpserver_watch_send_chunk(conn, packet, 12 + stored_size))
+         break;
+   }
+
+   /* Terminating chunk, the client may already be gone. */
+   httpserver_watch_send_chunk(conn, NULL, 0);
+
+   slock_lock(s_httpserver_watch_lock);
+   free(watch->snapshot);
+   free(watch->current);
+   free(watch->previous);
+   watch->snapshot = watch->current = watch->previous = NULL;
+   watch->active   = false;
+   s_httpserver_watch_count--;
+   slock_unlock(s_httpserver_watch_lock);
+
+   free(delta);
+   free(packet);
+   return 1;
+}
+#endif
+
+/**
+ * httpserver_frame:
+ *
+ * Called by the runloop after each frame. Copies the ranges of
+ * every memory watch that is due this frame and idle into its
+ * snapshot and wakes its connection thread. Watches still busy
+ * with the previous snapshot skip the frame.
+ **/
+void httpserver_frame(void)
+{
+#ifdef HAVE_THREADS
+   unsigned slot, r;
+   bool signal                  = false;
+   rarch_system_info_t *system  = NULL;
+
+   if (!s_httpserver_watch_count || !s_httpserver_watch_lock)
+      return;
+
+   system = runloop_get_system_info();
+
+   slock_lock(s_httpserver_watch_lock);
+
+   for (slot = 0; slot < HTTPSERVER_WATCH_MAX; slot++)
+   {
+      httpserver_watch_t *watch = &s_httpserver_watches[slot];
+
+      if (!watch->active || watch->closed)
+         continue;
+
+      watch->frame++;
+
+      if (++watch->counter < watch->divisor || watch->pending)
+         continue;
+
+      watch->counter = 0;
+
+      /* Memory maps go away with the content, end the stream then. */
+      for (r = 0; r < watch->num_ranges; r++)
+      {
+         const httpserver_watch_range_t *range      = &watch->ranges[r];
+         const struct retro_memory_descriptor *mmap = NULL;
+
+         if (range->id >= system->mmaps.num_descriptors)
+            break;
+
+         mmap = &system->mmaps.descriptors[range->id].core;
+
+         if (!mmap->ptr || range->start + range->length > mmap->len)
+            break;
+
+         memcpy(watch->snapshot + range->offset,
+               (const uint8_t*)mmap->ptr + range->start, range->length);
+      }
+
+      if (r < watch->num_ranges)
+         watch->closed = true;
+      else
+      {
+         watch->pending        = true;
+         watch->snapshot_frame = watch->frame;
+      }
+
+      signal = true;
+   }
+
+   if (signal)
+      scond_broadcast(s_httpserver_watch_cond);
+
+   slock_unlock(s_httpserver_watch_lock);
+#endif
+}
+
 /*============================================================
 HTTP SERVER
 ============================================================ */
@@ -568,20 +1007,59 @@ int httpserver_init(unsigned port)
    };
 
    memset(&s_httpserver_callbacks, 0, sizeof(s_httpserver_callbacks));
+
+#ifdef HAVE_THREADS
+   s_httpserver_watch_quit = false;
+   s_httpserver_watch_lock = slock_new();
+   s_httpserver_watch_cond = scond_new();
+#endif
+
    s_httpserver_ctx = mg_start(&s_httpserver_callbacks, NULL, options);
 
    if (s_httpserver_ctx == NULL)
+   {
+#ifdef HAVE_THREADS
+      scond_free(s_httpserver_watch_cond);
+      slock_free(s_httpserver_watch_lock);
+      s_httpserver_watch_cond = NULL;
+      s_httpserver_watch_lock = NULL;
+#endif
       return -1;
+   }
 
    mg_set_request_handler(s_httpserver_ctx, "/" BASIC_INFO, httpserver_handle_basic_info, NULL);
 
    mg_set_request_handler(s_httpserver_ctx, "/" MEMORY_MAP, httpserver_handle_mmaps, NULL);
    mg_set_request_handler(s_httpserver_ctx, "/" MEMORY_MAP "/", httpserver_handle_mmaps, NULL);
 
+#ifdef HAVE_THREADS
+   mg_set_request_handler(s_httpserver_ctx, "/" MEMORY_WATCH, httpserver_handle_memory_watch, NULL);
+#endif
+
    return 0;
 }
 
 void httpserver_destroy(void)
 {
+#ifdef HAVE_THREADS
+   /* Release the streaming connections so mg_stop can join them. */
+   if (s_httpserver_watch_lock)
+   {
+      slock_lock(s_httpserver_watch_lock);
+      s_httpserver_watch_quit = true;
+      scond_broadcast(s_httpserver_watch_cond);
+      slock_unlock(s_httpserver_watch_lock);
+   }
+#endif
+
    mg_stop(s_httpserver_ctx);
+
+#ifdef HAVE_THREADS
+   if (s_httpserver_watch_cond)
+      scond_free(s_httpserver_watch_cond);
+   if (s_httpserver_watch_lock)
+      slock_free(s_httpserver_watch_lock);
+   s_httpserver_watch_cond = NULL;
+   s_httpserver_watch_lock = NULL;
+#endif
 }
@@ -24,6 +24,8 @@ int  httpserver_init(unsigned port);
 
 void httpserver_destroy(void);
 
+void httpserver_frame(void);
+
 RETRO_END_DECLS
 
 #endif /* __RARCH_HTTPSERVR_H */
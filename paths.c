@@ -668,6 +668,38 @@ bool path_is_empty(enum rarch_path_type type)
    return false;
 }
 
+/**
+ * path_get_cache_dir:
+ * @s                 : output directory path.
+ * @subdir            : subdirectory to use, created if missing.
+ * @len               : size of @s.
+ *
+ * Gets a directory for persistent caches (compiled shaders,
+ * pipeline caches, ...). This is @subdir inside the cache
+ * directory if one is set, otherwise inside the directory of
+ * the config file.
+ *
+ * Returns: true if the directory exists or could be created.
+ **/
+bool path_get_cache_dir(char *s, const char *subdir, size_t len)
+{
+   char dir[PATH_MAX_LENGTH];
+   settings_t *settings = config_get_ptr();
+
+   dir[0] = '\0';
+
+   if (settings && !string_is_empty(settings->paths.directory_cache))
+      strlcpy(dir, settings->paths.directory_cache, sizeof(dir));
+   else if (!string_is_empty(path_config_file))
+      fill_pathname_basedir(dir, path_config_file, sizeof(dir));
+   else
+      return false;
+
+   fill_pathname_join(s, dir, subdir, len);
+
+   return path_is_directory(s) || path_mkdir(s);
+}
+
 void path_clear(enum rarch_path_type type)
 {
    switch (type)
@@ -75,6 +75,8 @@ void path_clear_all(void);
 
 bool path_is_empty(enum rarch_path_type type);
 
+bool path_get_cache_dir(char *s, const char *subdir, size_t len);
+
 enum rarch_content_type path_is_media_type(const char *path);
 
 RETRO_END_DECLS
@@ -17,8 +17,10 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <retro_assert.h>
+#include <retro_miscellaneous.h>
 #include <compat/msvc.h>
 
 #include <boolean.h>
@@ -190,9 +192,14 @@ struct ff_config_param
    enum PixelFormat out_pix_fmt;
    unsigned threads;
    unsigned frame_drop_ratio;
+   unsigned frame_pool_size;
    unsigned sample_rate;
    float scale_factor;
 
+   /* Drop frames instead of stalling the runloop
+    * when the encoder falls behind. */
+   bool frame_pool_drop;
+
    bool audio_enable;
    /* Keep same naming conventions as libavcodec. */
    bool audio_qscale;
@@ -206,6 +213,44 @@ struct ff_config_param
    AVDictionary *audio_opts;
 };
 
+#define MAX_FRAMES 32
+
+struct ff_frame
+{
+   uint8_t *data;
+   /* Held by the runloop while it fills the frame and by
+    * the encoder thread while the frame is queued/encoded. */
+   unsigned refcount;
+};
+
+struct ff_frame_ref
+{
+   struct ffemu_video_data attr;
+   /* Pool index, -1 for dupes which carry no data. */
+   int index;
+};
+
+/* Video frames are handed to the encoder thread by pool
+ * index. The thread encodes straight from the pool buffer,
+ * and GPU readbacks can land in a pool buffer directly
+ * (see ffmpeg_get_video_buffer). */
+struct ff_frame_pool
+{
+   struct ff_frame frames[MAX_FRAMES];
+   struct ff_frame_ref queue[MAX_FRAMES];
+   unsigned queue_head;
+   unsigned queue_count;
+   unsigned count;
+   size_t frame_size;
+   /* Frame handed out by ffmpeg_get_video_buffer, not yet pushed. */
+   int acquired;
+
+   /* Back-pressure statistics. */
+   unsigned queue_peak;
+   unsigned stalls;
+   unsigned dropped;
+};
+
 typedef struct ffmpeg
 {
    struct ff_video_info video;
@@ -219,8 +264,7 @@ typedef struct ffmpeg
    slock_t *cond_lock;
    slock_t *lock;
    fifo_buffer_t *audio_fifo;
-   fifo_buffer_t *video_fifo;
-   fifo_buffer_t *attr_fifo;
+   struct ff_frame_pool pool;
    sthread_t *thread;
 
    volatile bool alive;
@@ -547,6 +591,7 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
    params->scale_factor = 1;
    params->threads = 1;
    params->frame_drop_ratio = 1;
+   params->frame_pool_size = MAX_FRAMES;
    params->audio_enable = true;
 
    if (!config)
@@ -572,6 +617,12 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
             &params->frame_drop_ratio) || !params->frame_drop_ratio)
       params->frame_drop_ratio = 1;
 
+   if (!config_get_uint(params->conf, "frame_pool_size",
+            &params->frame_pool_size) || params->frame_pool_size < 2)
+      params->frame_pool_size = MAX_FRAMES;
+   params->frame_pool_size = MIN(params->frame_pool_size, MAX_FRAMES);
+   config_get_bool(params->conf, "frame_pool_drop", &params->frame_pool_drop);
+
    if (!config_get_bool(params->conf, "audio_enable", &params->audio_enable))
       params->audio_enable = true;
 
@@ -665,8 +716,6 @@ static bool ffmpeg_init_muxer_post(ffmpeg_t *handle)
    return avformat_write_header(handle->muxer.ctx, NULL) >= 0;
 }
 
-#define MAX_FRAMES 32
-
 static void ffmpeg_thread(void *data);
 
 static bool init_thread(ffmpeg_t *handle)
@@ -676,17 +725,19 @@ static bool init_thread(ffmpeg_t *handle)
    handle->cond = scond_new();
    handle->audio_fifo = fifo_new(32000 * sizeof(int16_t) *
          handle->params.channels * MAX_FRAMES / 60); /* Some arbitrary max size. */
-   handle->attr_fifo = fifo_new(sizeof(struct ffemu_video_data) * MAX_FRAMES);
-   handle->video_fifo = fifo_new(handle->params.fb_width * handle->params.fb_height *
-            handle->video.pix_size * MAX_FRAMES);
+
+   /* Frame buffers are allocated on first use. */
+   handle->pool.count      = handle->config.frame_pool_size;
+   handle->pool.frame_size = handle->params.fb_width * handle->params.fb_height *
+            handle->video.pix_size;
+   handle->pool.acquired   = -1;
 
    handle->alive = true;
    handle->can_sleep = true;
    handle->thread = sthread_create(ffmpeg_thread, handle);
 
    retro_assert(handle->lock && handle->cond_lock &&
-      handle->cond && handle->audio_fifo &&
-      handle->attr_fifo && handle->video_fifo && handle->thread);
+      handle->cond && handle->audio_fifo && handle->thread);
 
    return true;
 }
@@ -708,28 +759,32 @@ static void deinit_thread(ffmpeg_t *handle)
    slock_free(handle->cond_lock);
    scond_free(handle->cond);
 
-   handle->thread = NULL;
+   /* ffmpeg_flush_buffers drains the frame queue afterwards. */
+   handle->lock      = NULL;
+   handle->cond_lock = NULL;
+   handle->cond      = NULL;
+   handle->thread    = NULL;
 }
 
 static void deinit_thread_buf(ffmpeg_t *handle)
 {
+   unsigned i;
+
    if (handle->audio_fifo)
    {
       fifo_free(handle->audio_fifo);
       handle->audio_fifo = NULL;
    }
 
-   if (handle->attr_fifo)
+   for (i = 0; i < MAX_FRAMES; i++)
    {
-      fifo_free(handle->attr_fifo);
-      handle->attr_fifo = NULL;
+      av_free(handle->pool.frames[i].data);
+      handle->pool.frames[i].data     = NULL;
+      handle->pool.frames[i].refcount = 0;
    }
 
-   if (handle->video_fifo)
-   {
-      fifo_free(handle->video_fifo);
-      handle->video_fifo = NULL;
-   }
+   handle->pool.queue_count = 0;
+   handle->pool.acquired    = -1;
 }
 
 static void ffmpeg_free(void *data)
@@ -821,14 +876,181 @@ error:
    return NULL;
 }
 
+static void ffmpeg_thread_wait(ffmpeg_t *handle)
+{
+   slock_lock(handle->cond_lock);
+   if (handle->can_sleep)
+   {
+      handle->can_sleep = false;
+      scond_wait(handle->cond, handle->cond_lock);
+      handle->can_sleep = true;
+   }
+   else
+      scond_signal(handle->cond);
+
+   slock_unlock(handle->cond_lock);
+}
+
+/**
+ * ffmpeg_frame_pool_reserve:
+ * @handle               : FFmpeg handle.
+ * @need_frame           : also take a reference on a free frame.
+ * @index                : set to the reserved frame if @need_frame.
+ *
+ * Waits for a free queue entry (and frame) for the next
+ * video frame. Only the runloop reserves, so what is
+ * available here stays available until it submits.
+ *
+ * Returns: false if the frame has to be dropped, either
+ * because frame_pool_drop is set or the thread is gone.
+ **/
+static bool ffmpeg_frame_pool_reserve(ffmpeg_t *handle,
+      bool need_frame, int *index)
+{
+   struct ff_frame_pool *pool = &handle->pool;
+   bool stalled               = false;
+
+   for (;;)
+   {
+      unsigned i;
+      bool found = false;
+
+      slock_lock(handle->lock);
+      if (pool->queue_count < MAX_FRAMES)
+      {
+         if (!need_frame)
+            found = true;
+         else
+         {
+            for (i = 0; i < pool->count; i++)
+            {
+               if (!pool->frames[i].refcount)
+               {
+                  pool->frames[i].refcount = 1;
+                  *index                   = i;
+                  found                    = true;
+                  break;
+               }
+            }
+         }
+      }
+      slock_unlock(handle->lock);
+
+      if (found)
+         break;
+
+      if (!handle->alive || handle->config.frame_pool_drop)
+         return false;
+
+      if (!stalled)
+         pool->stalls++;
+      stalled = true;
+
+      ffmpeg_thread_wait(handle);
+   }
+
+   if (need_frame && !pool->frames[*index].data)
+   {
+      /* Pad a row, libswscale may read past the end. */
+      pool->frames[*index].data = (uint8_t*)av_malloc(pool->frame_size +
+            handle->params.fb_width * handle->video.pix_size);
+      if (!pool->frames[*index].data)
+      {
+         slock_lock(handle->lock);
+         pool->frames[*index].refcount = 0;
+         slock_unlock(handle->lock);
+         *index = -1;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+static void ffmpeg_frame_pool_release(ffmpeg_t *handle, int index)
+{
+   if (index < 0)
+      return;
+
+   slock_lock(handle->lock);
+   handle->pool.frames[index].refcount--;
+   slock_unlock(handle->lock);
+   if (handle->cond)
+      scond_signal(handle->cond);
+}
+
+static void ffmpeg_frame_pool_submit(ffmpeg_t *handle,
+      const struct ff_frame_ref *ref)
+{
+   struct ff_frame_pool *pool = &handle->pool;
+
+   slock_lock(handle->lock);
+   pool->queue[(pool->queue_head + pool->queue_count) % MAX_FRAMES] = *ref;
+   pool->queue_count++;
+   if (pool->queue_count > pool->queue_peak)
+      pool->queue_peak = pool->queue_count;
+   slock_unlock(handle->lock);
+   scond_signal(handle->cond);
+}
+
+static bool ffmpeg_frame_pool_pop(ffmpeg_t *handle,
+      struct ff_frame_ref *ref)
+{
+   struct ff_frame_pool *pool = &handle->pool;
+   bool ret                   = false;
+
+   slock_lock(handle->lock);
+   if (pool->queue_count)
+   {
+      *ref             = pool->queue[pool->queue_head];
+      pool->queue_head = (pool->queue_head + 1) % MAX_FRAMES;
+      pool->queue_count--;
+      ret              = true;
+   }
+   slock_unlock(handle->lock);
+
+   return ret;
+}
+
+/**
+ * ffmpeg_get_video_buffer:
+ * @data                 : FFmpeg handle.
+ * @size                 : size of the frame about to be read back.
+ *
+ * Hands out a pool frame for a GPU readback to be written
+ * into. Pushing a frame which points into this buffer
+ * queues it without copying. The same buffer is returned
+ * until it has been pushed.
+ *
+ * Returns: pointer to the frame, or NULL if none is available.
+ **/
+static void *ffmpeg_get_video_buffer(void *data, size_t size)
+{
+   ffmpeg_t *handle = (ffmpeg_t*)data;
+   int index        = -1;
+
+   if (!handle || size > handle->pool.frame_size)
+      return NULL;
+
+   if (handle->pool.acquired < 0)
+   {
+      if (!ffmpeg_frame_pool_reserve(handle, true, &index))
+         return NULL;
+      handle->pool.acquired = index;
+   }
+
+   return handle->pool.frames[handle->pool.acquired].data;
+}
+
 static bool ffmpeg_push_video(void *data,
       const struct ffemu_video_data *vid)
 {
    unsigned y;
    bool drop_frame;
-   struct ffemu_video_data attr_data;
+   bool need_frame;
+   struct ff_frame_ref ref;
+   struct ff_frame_pool *pool;
    ffmpeg_t *handle = (ffmpeg_t*)data;
-   int offset = 0;
 
    if (!handle || !vid)
       return false;
@@ -841,52 +1063,52 @@ static bool ffmpeg_push_video(void *data,
    if (drop_frame)
       return true;
 
-   for (;;)
-   {
-      unsigned avail;
-      slock_lock(handle->lock);
-      avail = fifo_write_avail(handle->attr_fifo);
-      slock_unlock(handle->lock);
-
-      if (!handle->alive)
-         return false;
-
-      if (avail >= sizeof(*vid))
-         break;
-
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
-      {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
-      }
-      else
-         scond_signal(handle->cond);
+   pool      = &handle->pool;
+   ref.attr  = *vid;
+   ref.index = -1;
 
-      slock_unlock(handle->cond_lock);
+   if (ref.attr.is_dupe)
+   {
+      ref.attr.width = ref.attr.height = ref.attr.pitch = 0;
+      need_frame     = false;
+   }
+   else if (pool->acquired >= 0
+         && (const uint8_t*)vid->data >= pool->frames[pool->acquired].data
+         && (const uint8_t*)vid->data <  pool->frames[pool->acquired].data
+            + pool->frame_size)
+   {
+      /* Read back straight into the pool, queue as is. */
+      ref.index      = pool->acquired;
+      pool->acquired = -1;
+      need_frame     = false;
    }
-
-   slock_lock(handle->lock);
-
-   /* Tightly pack our frame to conserve memory.
-    * libretro tends to use a very large pitch.
-    */
-   attr_data = *vid;
-
-   if (attr_data.is_dupe)
-      attr_data.width = attr_data.height = attr_data.pitch = 0;
    else
-      attr_data.pitch = attr_data.width * handle->video.pix_size;
+      need_frame     = true;
 
-   fifo_write(handle->attr_fifo, &attr_data, sizeof(attr_data));
+   if (!ffmpeg_frame_pool_reserve(handle, need_frame, &ref.index))
+   {
+      ffmpeg_frame_pool_release(handle, ref.index);
+      pool->dropped++;
+      return handle->alive;
+   }
 
-   for (y = 0; y < attr_data.height; y++, offset += vid->pitch)
-      fifo_write(handle->video_fifo,
-            (const uint8_t*)vid->data + offset, attr_data.pitch);
+   if (need_frame)
+   {
+      /* Tightly pack our frame to conserve memory.
+       * libretro tends to use a very large pitch.
+       */
+      uint8_t *dst       = pool->frames[ref.index].data;
+      const uint8_t *src = (const uint8_t*)vid->data;
+
+      ref.attr.pitch     = ref.attr.width * handle->video.pix_size;
+      ref.attr.data      = dst;
+
+      for (y = 0; y < ref.attr.height; y++,
+            dst += ref.attr.pitch, src += vid->pitch)
+         memcpy(dst, src, ref.attr.pitch);
+   }
 
-   slock_unlock(handle->lock);
-   scond_signal(handle->cond);
+   ffmpeg_frame_pool_submit(handle, &ref);
 
    return true;
 }
@@ -916,17 +1138,7 @@ static bool ffmpeg_push_audio(void *data,
             * sizeof(int16_t))
          break;
 
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
-      {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
-      }
-      else
-         scond_signal(handle->cond);
-
-      slock_unlock(handle->cond_lock);
+      ffmpeg_thread_wait(handle);
    }
 
    slock_lock(handle->lock);
@@ -996,6 +1208,11 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
    }
    else
    {
+      /* GPU readbacks queued without a copy are bottom-up,
+       * packed frames are not; the scaler caches the stride. */
+      if (handle->video.scaler.in_stride != vid->pitch)
+         handle->video.scaler.in_width = 0;
+
       video_frame_record_scale(
             &handle->video.scaler,
             handle->video.conv_frame->data[0],
@@ -1011,12 +1228,15 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
 }
 
 static bool ffmpeg_push_video_thread(ffmpeg_t *handle,
-      const struct ffemu_video_data *vid)
+      const struct ff_frame_ref *ref)
 {
    AVPacket pkt;
 
-   if (!vid->is_dupe)
-      ffmpeg_scale_input(handle, vid);
+   if (!ref->attr.is_dupe)
+      ffmpeg_scale_input(handle, &ref->attr);
+
+   /* The frame is fully converted, hand it back to the pool. */
+   ffmpeg_frame_pool_release(handle, ref->index);
 
    handle->video.conv_frame->pts = handle->video.frame_cnt;
 
@@ -1302,8 +1522,6 @@ static void ffmpeg_flush_video(ffmpeg_t *handle)
 static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 {
    bool did_work;
-   void *video_buf = av_malloc(2 * handle->params.fb_width *
-         handle->params.fb_height * handle->video.pix_size);
    size_t audio_buf_size = handle->config.audio_enable ?
       (handle->audio.codec->frame_size *
        handle->params.channels * sizeof(int16_t)) : 0;
@@ -1316,7 +1534,7 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 
    do
    {
-      struct ffemu_video_data attr_buf;
+      struct ff_frame_ref ref;
 
       did_work = false;
 
@@ -1336,14 +1554,9 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
          }
       }
 
-      if (fifo_read_avail(handle->attr_fifo) >= sizeof(attr_buf))
+      if (ffmpeg_frame_pool_pop(handle, &ref))
       {
-         fifo_read(handle->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(handle->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(handle, &attr_buf);
-
+         ffmpeg_push_video_thread(handle, &ref);
          did_work = true;
       }
    } while (did_work);
@@ -1355,7 +1568,6 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
    /* Flush out last video. */
    ffmpeg_flush_video(handle);
 
-   av_free(video_buf);
    av_free(audio_buf);
 }
 
@@ -1371,6 +1583,11 @@ static bool ffmpeg_finalize(void *data)
    /* Flush out data still in buffers (internal, and FFmpeg internal). */
    ffmpeg_flush_buffers(handle);
 
+   RARCH_LOG("[FFmpeg]: Frame pool: %u frames, peak queue depth %u,"
+         " %u stalls, %u dropped.\n",
+         handle->pool.count, handle->pool.queue_peak,
+         handle->pool.stalls, handle->pool.dropped);
+
    deinit_thread_buf(handle);
 
    /* Write final data. */
@@ -1384,12 +1601,6 @@ static void ffmpeg_thread(void *data)
    size_t audio_buf_size;
    void *audio_buf = NULL;
    ffmpeg_t *ff    = (ffmpeg_t*)data;
-   /* For some reason, FFmpeg has a tendency to crash
-    * if we don't overallocate a bit. */
-   void *video_buf = av_malloc(2 * ff->params.fb_width *
-         ff->params.fb_height * ff->video.pix_size);
-
-   retro_assert(video_buf);
 
    audio_buf_size = ff->config.audio_enable ?
       (ff->audio.codec->frame_size * ff->params.channels * sizeof(int16_t)) : 0;
@@ -1397,13 +1608,13 @@ static void ffmpeg_thread(void *data)
 
    while (ff->alive)
    {
-      struct ffemu_video_data attr_buf;
+      struct ff_frame_ref ref;
 
       bool avail_video = false;
       bool avail_audio = false;
 
       slock_lock(ff->lock);
-      if (fifo_read_avail(ff->attr_fifo) >= sizeof(attr_buf))
+      if (ff->pool.queue_count)
          avail_video = true;
 
       if (ff->config.audio_enable)
@@ -1412,32 +1623,10 @@ static void ffmpeg_thread(void *data)
       slock_unlock(ff->lock);
 
       if (!avail_video && !avail_audio)
-      {
-         slock_lock(ff->cond_lock);
-         if (ff->can_sleep)
-         {
-            ff->can_sleep = false;
-            scond_wait(ff->cond, ff->cond_lock);
-            ff->can_sleep = true;
-         }
-         else
-            scond_signal(ff->cond);
+         ffmpeg_thread_wait(ff);
 
-         slock_unlock(ff->cond_lock);
-      }
-
-      if (avail_video && video_buf)
-      {
-         slock_lock(ff->lock);
-         fifo_read(ff->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(ff->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
-         slock_unlock(ff->lock);
-         scond_signal(ff->cond);
-
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(ff, &attr_buf);
-      }
+      if (avail_video && ffmpeg_frame_pool_pop(ff, &ref))
+         ffmpeg_push_video_thread(ff, &ref);
 
       if (avail_audio && audio_buf)
       {
@@ -1455,7 +1644,6 @@ static void ffmpeg_thread(void *data)
       }
    }
 
-   av_free(video_buf);
    av_free(audio_buf);
 }
 
@@ -1465,5 +1653,6 @@ const record_driver_t ffemu_ffmpeg = {
    ffmpeg_push_video,
    ffmpeg_push_audio,
    ffmpeg_finalize,
+   ffmpeg_get_video_buffer,
    "ffmpeg",
 };
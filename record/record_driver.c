@@ -238,6 +238,17 @@ void recording_dump_frame(const void *data, unsigned width,
          return;
       }
 
+      /* Read back straight into the recording driver's
+       * frame queue if it lets us, saving a full-frame copy. */
+      if (recording_driver && recording_driver->get_video_buffer)
+      {
+         uint8_t *frame_buf = (uint8_t*)
+            recording_driver->get_video_buffer(recording_data,
+                  recording_gpu_width * recording_gpu_height * 3);
+         if (frame_buf)
+            gpu_buf = frame_buf;
+      }
+
       if (!gpu_buf)
          return;
 
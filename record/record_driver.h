@@ -87,6 +87,10 @@ typedef struct record_driver
    bool  (*push_video)(void *data, const struct ffemu_video_data *video_data);
    bool  (*push_audio)(void *data, const struct ffemu_audio_data *audio_data);
    bool  (*finalize)(void *data);
+   /* Optional. Returns a driver-owned buffer of at least 'size'
+    * bytes to read a frame back into. A frame pushed with data
+    * pointing into it is queued without being copied. */
+   void *(*get_video_buffer)(void *data, size_t size);
    const char *ident;
 } record_driver_t;
 
@@ -45,6 +45,7 @@
 #include <compat/posix_string.h>
 #include <streams/file_stream.h>
 #include <file/file_path.h>
+#include <file/archive_file.h>
 #include <retro_assert.h>
 #include <retro_miscellaneous.h>
 #include <queues/message_queue.h>
@@ -272,6 +273,42 @@ static retro_usec_t runloop_frame_time_last                     = 0;
 static retro_time_t frame_limit_minimum_time                    = 0.0;
 static retro_time_t frame_limit_last_time                       = 0.0;
 
+/* Precise frame pacing: how long before a deadline to stop
+ * sleeping and spin, and the buckets (in microseconds late)
+ * of the pacing error histogram kept in performance counters. */
+#define RUNLOOP_PACING_SPIN_USEC 250
+#define RUNLOOP_PACING_BUCKETS   7
+
+static const retro_time_t runloop_pacing_bounds[RUNLOOP_PACING_BUCKETS - 1] =
+{
+   50, 100, 250, 500, 1000, 2000
+};
+static const char *runloop_pacing_idents[RUNLOOP_PACING_BUCKETS] =
+{
+   "frame_pacing_late_lt_50us",
+   "frame_pacing_late_lt_100us",
+   "frame_pacing_late_lt_250us",
+   "frame_pacing_late_lt_500us",
+   "frame_pacing_late_lt_1ms",
+   "frame_pacing_late_lt_2ms",
+   "frame_pacing_late_ge_2ms"
+};
+static struct retro_perf_counter runloop_pacing_perf[RUNLOOP_PACING_BUCKETS];
+
+/* Automatic frame delay: core run times kept to pick the delay
+ * from, the largest delay and per-frame increase allowed (usec),
+ * and how many frames to hold the delay after missing a VSync. */
+#define RUNLOOP_FRAME_DELAY_AUTO_SAMPLES 32
+#define RUNLOOP_FRAME_DELAY_AUTO_MAX     15000
+#define RUNLOOP_FRAME_DELAY_AUTO_STEP    250
+#define RUNLOOP_FRAME_DELAY_AUTO_HOLD    120
+
+static retro_time_t runloop_frame_delay_run_time[RUNLOOP_FRAME_DELAY_AUTO_SAMPLES];
+static unsigned runloop_frame_delay_run_index                   = 0;
+static unsigned runloop_frame_delay_hold                        = 0;
+static uint64_t runloop_frame_delay_frame_count                 = 0;
+static retro_time_t runloop_frame_delay_auto                    = 0;
+
 extern bool input_driver_flushing_input;
 
 #ifdef HAVE_DYNAMIC
@@ -1880,6 +1917,7 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
 #endif
             task_queue_deinit();
             task_queue_init(threaded_enable, runloop_msg_queue_push);
+            file_archive_cache_init();
          }
          break;
       case RARCH_CTL_SET_CORE_SHUTDOWN:
@@ -1892,6 +1930,7 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
          return runloop_shutdown_initiated;
       case RARCH_CTL_DATA_DEINIT:
          task_queue_deinit();
+         file_archive_cache_deinit();
          break;
       case RARCH_CTL_IS_CORE_OPTION_UPDATED:
          if (!runloop_core_options)
@@ -3341,6 +3380,104 @@ void runloop_unset(enum runloop_action action)
    }
 }
 
+/* Files how late a frame started against its deadline.
+ * Each bucket counts its frames in call_cnt and sums their
+ * lateness in total, so the logged average is in microseconds. */
+static void runloop_pacing_record(retro_time_t late)
+{
+   unsigned i;
+
+   if (!runloop_perfcnt_enable)
+      return;
+
+   for (i = 0; i < RUNLOOP_PACING_BUCKETS - 1; i++)
+      if (late < runloop_pacing_bounds[i])
+         break;
+
+   performance_counter_init(runloop_pacing_perf[i], runloop_pacing_idents[i]);
+   runloop_pacing_perf[i].call_cnt++;
+   runloop_pacing_perf[i].total += late;
+}
+
+/**
+ * runloop_frame_delay_auto_update:
+ *
+ * Picks the frame delay for the coming frame: the largest one
+ * that leaves the configured margin between the slowest recent
+ * core run and the next VSync. A frame that took well over a
+ * refresh period missed its VSync; the delay is halved right away
+ * and held there for a while.
+ *
+ * Returns: frame delay in microseconds.
+ **/
+static retro_time_t runloop_frame_delay_auto_update(settings_t *settings)
+{
+   unsigned i;
+   retro_time_t period;
+   retro_time_t target;
+   retro_time_t frame_time = 0;
+   retro_time_t run_time   = 0;
+   uint64_t count          = video_driver_get_frame_timing(
+         &frame_time, NULL);
+
+   if (settings->floats.video_refresh_rate <= 0.0f)
+      return 0;
+
+   period = (retro_time_t)(1000000.0f / settings->floats.video_refresh_rate);
+
+   if (count != runloop_frame_delay_frame_count)
+   {
+      runloop_frame_delay_frame_count = count;
+
+      if (     runloop_frame_delay_auto > 0
+            && frame_time > period + period / 2)
+      {
+         runloop_frame_delay_auto /= 2;
+         runloop_frame_delay_hold  = RUNLOOP_FRAME_DELAY_AUTO_HOLD;
+         return runloop_frame_delay_auto;
+      }
+   }
+
+   if (runloop_frame_delay_hold)
+   {
+      runloop_frame_delay_hold--;
+      return runloop_frame_delay_auto;
+   }
+
+   for (i = 0; i < RUNLOOP_FRAME_DELAY_AUTO_SAMPLES; i++)
+      if (runloop_frame_delay_run_time[i] > run_time)
+         run_time = runloop_frame_delay_run_time[i];
+
+   target = period - run_time
+      - settings->uints.video_frame_delay_auto_margin * 1000;
+   target = MAX(0, MIN(target, RUNLOOP_FRAME_DELAY_AUTO_MAX));
+
+   /* Back off at once, creep up slowly. */
+   if (target < runloop_frame_delay_auto)
+      runloop_frame_delay_auto = target;
+   else
+      runloop_frame_delay_auto = MIN(target,
+            runloop_frame_delay_auto + RUNLOOP_FRAME_DELAY_AUTO_STEP);
+
+   return runloop_frame_delay_auto;
+}
+
+/* Records how long the core took from the start of its run
+ * to handing its frame to the video driver. */
+static void runloop_frame_delay_auto_sample(retro_time_t run_start)
+{
+   retro_time_t frame_start = 0;
+
+   video_driver_get_frame_timing(NULL, &frame_start);
+
+   /* No frame this run. */
+   if (frame_start < run_start)
+      return;
+
+   runloop_frame_delay_run_time[runloop_frame_delay_run_index++
+      % RUNLOOP_FRAME_DELAY_AUTO_SAMPLES] = frame_start - run_start;
+}
+
 /**
  * runloop_iterate:
  *
@@ -3353,6 +3490,8 @@ void runloop_unset(enum runloop_action action)
 int runloop_iterate(unsigned *sleep_ms)
 {
    unsigned i;
+   retro_time_t frame_delay                     = 0;
+   retro_time_t run_start                       = 0;
    bool input_nonblock_state                    = input_driver_is_nonblock_state();
    settings_t *settings                         = config_get_ptr();
    unsigned max_users                           = *(input_driver_get_uint(INPUT_ACTION_MAX_USERS));
@@ -3438,8 +3577,25 @@ int runloop_iterate(unsigned *sleep_ms)
       input_push_analog_dpad(auto_binds,    dpad_mode);
    }
 
-   if ((settings->uints.video_frame_delay > 0) && !input_nonblock_state)
-      retro_sleep(settings->uints.video_frame_delay);
+   if (!input_nonblock_state)
+   {
+      if (settings->bools.video_frame_delay_auto)
+         frame_delay = runloop_frame_delay_auto_update(settings);
+      else
+         frame_delay = settings->uints.video_frame_delay * 1000;
+   }
+
+   if (frame_delay > 0)
+   {
+      if (settings->bools.frame_pacing_precise)
+         cpu_features_sleep_until_usec(cpu_features_get_time_usec()
+               + frame_delay, RUNLOOP_PACING_SPIN_USEC);
+      else
+         retro_sleep((unsigned)(frame_delay / 1000));
+   }
+
+   if (settings->bools.video_frame_delay_auto)
+      run_start = cpu_features_get_time_usec();
 
 #ifdef HAVE_RUNAHEAD
    /* Run Ahead Feature replaces the call to core_run in this loop */
@@ -3453,12 +3609,19 @@ int runloop_iterate(unsigned *sleep_ms)
 #endif
       core_run();
 
+   if (run_start)
+      runloop_frame_delay_auto_sample(run_start);
+
 #ifdef HAVE_CHEEVOS
    if (runloop_check_cheevos())
       cheevos_test();
 #endif
    cheat_manager_apply_retro_cheats() ;
 
+#if defined(HAVE_HTTPSERVER) && defined(HAVE_ZLIB)
+   httpserver_frame();
+#endif
+
 #ifdef HAVE_DISCORD
    if (discord_is_inited)
    {
@@ -3522,6 +3685,28 @@ int runloop_iterate(unsigned *sleep_ms)
             (runloop_fastmotion ? settings->floats.fastforward_ratio : 1.0f)));
       }
 
+      if (settings->bools.frame_pacing_precise)
+      {
+         /* Wait for the deadline here instead of handing whole
+          * milliseconds back to the frontend. */
+         retro_time_t deadline = frame_limit_last_time
+            + frame_limit_minimum_time;
+         retro_time_t now      = cpu_features_get_time_usec();
+
+         if (deadline > now)
+         {
+            cpu_features_sleep_until_usec(deadline,
+                  RUNLOOP_PACING_SPIN_USEC);
+            now                   = cpu_features_get_time_usec();
+            frame_limit_last_time = deadline;
+         }
+         else
+            frame_limit_last_time = now;
+
+         runloop_pacing_record(now - deadline);
+         return 0;
+      }
+
       to_sleep_ms  = (
             (frame_limit_last_time + frame_limit_minimum_time)
             - cpu_features_get_time_usec()) / 1000;
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+#include <libretro.h>
+
+#include "../../core.h"
+#include "../../retroarch.h"
+#include "../../cheevos/cond.h"
+#include "../../cheevos/var.h"
+
+/* Runs a large, randomly generated achievement set against a synthetic
+ * memory image, once with the addresses resolved up front and once with
+ * them looked up on every read, and reports the time per frame. */
+
+#define BENCH_MEMORY_SIZE 0x10000
+
+static uint8_t bench_memory[BENCH_MEMORY_SIZE];
+static rarch_system_info_t bench_system;
+
+rarch_system_info_t *runloop_get_system_info(void)
+{
+   return &bench_system;
+}
+
+bool core_get_memory(retro_ctx_memory_info_t *info)
+{
+   info->data = NULL;
+   info->size = 0;
+
+   if (info->id == RETRO_MEMORY_SYSTEM_RAM)
+   {
+      info->data = bench_memory;
+      info->size = sizeof(bench_memory);
+   }
+
+   return true;
+}
+
+void cheevos_log(const char *fmt, ...)
+{
+   (void)fmt;
+}
+
+static const char *bench_prefixes[] =
+{
+   "M", "N", "O", "P", "Q", "R", "S", "T", "L", "U", "H", " ", "X"
+};
+
+static const char *bench_ops[] =
+{
+   "=", "<", "<=", ">", ">=", "!="
+};
+
+static void bench_make_memaddr(char *s, size_t len, unsigned groups)
+{
+   unsigned g;
+   size_t pos = 0;
+
+   for (g = 0; g < groups; g++)
+   {
+      unsigned c;
+      unsigned count = 2 + rand() % 6;
+
+      if (g)
+         pos += snprintf(s + pos, len - pos, "S");
+
+      for (c = 0; c < count; c++)
+      {
+         int kind = rand() % 10;
+
+         if (c)
+            pos += snprintf(s + pos, len - pos, "_");
+
+         if (kind == 0)
+            pos += snprintf(s + pos, len - pos, "P:");
+         else if (kind == 1)
+            pos += snprintf(s + pos, len - pos, "R:");
+         else if (kind == 2 && c + 1 < count)
+            pos += snprintf(s + pos, len - pos, "A:");
+
+         pos += snprintf(s + pos, len - pos, "%s0x%s%04x%s%u",
+               rand() % 4 ? "" : "d",
+               bench_prefixes[rand() % 13],
+               rand() % (BENCH_MEMORY_SIZE - 4),
+               bench_ops[rand() % 6],
+               (unsigned)(rand() % 256));
+
+         if (rand() % 4 == 0)
+            pos += snprintf(s + pos, len - pos, ".%u.", 1 + rand() % 100);
+      }
+   }
+}
+
+static unsigned bench_run(cheevos_condset_t *condsets, unsigned count,
+      unsigned frames, double *elapsed)
+{
+   unsigned f, i;
+   unsigned checksum = 0;
+   clock_t start     = clock();
+
+   srand(1);
+   memset(bench_memory, 0, sizeof(bench_memory));
+
+   for (f = 0; f < frames; f++)
+   {
+      /* Poke some bytes so the conditions see changing values. */
+      for (i = 0; i < 64; i++)
+         bench_memory[rand() % BENCH_MEMORY_SIZE] = (uint8_t)rand();
+
+      for (i = 0; i < count; i++)
+      {
+         int dirty = 0;
+         int reset = 0;
+
+         if (cheevos_condset_test(&condsets[i], &dirty, &reset))
+            checksum += i;
+
+         if (reset)
+            cheevos_condset_reset(&condsets[i], 0);
+
+         checksum += dirty + reset;
+      }
+   }
+
+   *elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+   return checksum;
+}
+
+int main(int argc, char *argv[])
+{
+   char memaddr[4096];
+   unsigned i, j;
+   double resolved_time        = 0.0;
+   double lookup_time          = 0.0;
+   unsigned resolved_sum       = 0;
+   unsigned lookup_sum         = 0;
+   unsigned total              = 0;
+   unsigned count              = argc > 1 ? (unsigned)atoi(argv[1]) : 5000;
+   unsigned frames             = argc > 2 ? (unsigned)atoi(argv[2]) : 600;
+   cheevos_condset_t *condsets = (cheevos_condset_t*)
+      calloc(count, sizeof(cheevos_condset_t));
+
+   if (!condsets)
+      return 1;
+
+   srand(0);
+
+   for (i = 0; i < count; i++)
+   {
+      cheevos_condset_t *condset = &condsets[i];
+
+      bench_make_memaddr(memaddr, sizeof(memaddr), 1);
+
+      condset->count = cheevos_cond_count_in_set(memaddr, 0);
+      condset->conds = (cheevos_cond_t*)
+         calloc(condset->count, sizeof(cheevos_cond_t));
+
+      if (!condset->conds)
+         return 1;
+
+      cheevos_cond_parse_in_set(condset->conds, memaddr, 0);
+      cheevos_condset_compile(condset);
+
+      for (j = 0; j < condset->count; j++)
+      {
+         cheevos_cond_t *cond = &condset->conds[j];
+
+         if (cond->source.type != CHEEVOS_VAR_TYPE_VALUE_COMP)
+            cheevos_var_patch_addr(&cond->source, CHEEVOS_CONSOLE_NONE);
+         if (cond->target.type != CHEEVOS_VAR_TYPE_VALUE_COMP)
+            cheevos_var_patch_addr(&cond->target, CHEEVOS_CONSOLE_NONE);
+      }
+
+      total += condset->count;
+   }
+
+   printf("%u achievements, %u conditions, %u frames\n",
+         count, total, frames);
+
+   resolved_sum = bench_run(condsets, count, frames, &resolved_time);
+
+   /* Drop the resolved pointers to time the per-read lookup. */
+   for (i = 0; i < count; i++)
+   {
+      for (j = 0; j < condsets[i].count; j++)
+      {
+         cheevos_cond_t *cond = &condsets[i].conds[j];
+         cond->source.memory  = NULL;
+         cond->target.memory  = NULL;
+         cond->curr_hits      = 0;
+         cond->source.previous = cond->target.previous = 0;
+      }
+   }
+
+   lookup_sum = bench_run(condsets, count, frames, &lookup_time);
+
+   printf("resolved: %8.3f us/frame (checksum %u)\n",
+         resolved_time * 1000000.0 / frames, resolved_sum);
+   printf("lookup:   %8.3f us/frame (checksum %u)\n",
+         lookup_time * 1000000.0 / frames, lookup_sum);
+
+   for (i = 0; i < count; i++)
+      free(condsets[i].conds);
+   free(condsets);
+
+   return resolved_sum == lookup_sum ? 0 : 1;
+}
@@ -1944,6 +1944,9 @@ bool content_init(void)
 
    string_list_free(content);
 
+   /* Everything has been read out of the archives by now */
+   file_archive_cache_release();
+
    if (content_ctx.name_ips)
       free(content_ctx.name_ips);
    if (content_ctx.name_bps)
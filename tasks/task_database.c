@@ -26,6 +26,7 @@
 #include <streams/file_stream.h>
 #include <streams/chd_stream.h>
 #include <streams/interface_stream.h>
+#include <features/features_cpu.h>
 #include "tasks_internal.h"
 
 #include "../core_info.h"
@@ -478,9 +479,38 @@ static int task_database_gdi_get_crc(const char *name, uint32_t *crc)
    return rv;
 }
 
+#ifdef HAVE_CHD
+static bool task_database_chd_crc_cb(const uint8_t *data, size_t len,
+      void *userdata)
+{
+   uint32_t *acc = (uint32_t*)userdata;
+   *acc          = encoding_crc32(*acc, data, len);
+   return true;
+}
+#endif
+
 static bool task_database_chd_get_crc(const char *name, uint32_t *crc)
 {
    int rv;
+#ifdef HAVE_CHD
+   /* Decompressing hunks dominates hashing a CHD,
+    * so spread it over all cores */
+   uint32_t acc     = 0;
+   chdstream_t *chd = chdstream_open(name, CHDSTREAM_TRACK_PRIMARY);
+   if (!chd)
+      return 0;
+
+   rv = chdstream_process(chd, cpu_features_get_core_amount(),
+         task_database_chd_crc_cb, &acc) ? 1 : 0;
+   chdstream_close(chd);
+
+   if (rv == 1)
+   {
+      *crc = acc;
+      RARCH_LOG("CHD '%s' crc: %x\n", name, *crc);
+   }
+   return rv;
+#else
    intfstream_t *fd = intfstream_open_chd_track(
          name,
          RETRO_VFS_FILE_ACCESS_READ,
@@ -500,6 +530,7 @@ static bool task_database_chd_get_crc(const char *name, uint32_t *crc)
       free(fd);
    }
    return rv;
+#endif
 }
 
 static void task_database_cue_prune(database_info_handle_t *db,
@@ -31,6 +31,7 @@
 #include <string/stdstring.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
+#include <features/features_cpu.h>
 
 #ifdef HAVE_RBMP
 #include <formats/rbmp.h>
@@ -67,6 +68,7 @@ struct screenshot_task_state
    unsigned width;
    unsigned height;
    unsigned pixel_format_type;
+   unsigned compression_level;
    uint8_t *out_buffer;
    const void *frame;
    char filename[PATH_MAX_LENGTH];
@@ -101,12 +103,14 @@ static bool screenshot_dump_direct(screenshot_task_state_t *state)
 
    scaler_ctx_gen_reset(&state->scaler);
 
-   ret = rpng_save_image_bgr24(
+   ret = rpng_save_image_bgr24_fast(
          state->filename,
          state->out_buffer,
          state->width,
          state->height,
-         state->width * 3
+         state->width * 3,
+         state->compression_level,
+         cpu_features_get_core_amount()
          );
 
    free(state->out_buffer);
@@ -223,6 +227,7 @@ static bool screenshot_dump(
    state->silence             = savestate;
    state->history_list_enable = settings->bools.history_list_enable;
    state->pixel_format_type   = video_driver_get_pixel_format();
+   state->compression_level   = settings->uints.screenshot_compression_level;
 
    if (!fullpath)
    {